@@ -0,0 +1,124 @@
+#ifndef MESH_SIMULATOR_SIM_BROKER_H
+#define MESH_SIMULATOR_SIM_BROKER_H
+
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+#include "NodeModule/TopicMatch.h"
+#include "Simulation.h"
+
+namespace MeshSimulator
+{
+    struct BrokerConfig
+    {
+        SimTime latency {5 * MICROS_PER_MS};
+        // messages per second the broker path can carry, 0 is unlimited
+        double rate {0};
+        // publishes waiting on the connection before the gateway publish fails
+        uint16_t bufferSize {32};
+    };
+
+    // mqtt broker with one gateway connection and any number of observers
+    // messages are serviced in order, a slow broker fills the buffer and gateway publishes start to fail
+    class SimBroker
+    {
+        public:
+            typedef std::function<void(const char * topic, const uint8_t * payload, uint16_t length)> Callback;
+            typedef std::function<void(const std::string & topic, const std::string & payload)> Observer;
+
+        private:
+            struct Message
+            {
+                std::string topic;
+                std::string payload;
+            };
+
+            Simulation & simulation;
+            const BrokerConfig config;
+            std::vector<std::string> filters;
+            std::deque<Message> gatewayInbox;
+            std::vector<Observer> observers;
+            Callback callback;
+            SimTime serviceFreeAt {0};
+            uint16_t pending {0};
+
+            void route(const Message & message)
+            {
+                for (auto & observer: observers) {
+                    observer(message.topic, message.payload);
+                }
+                for (auto & filter: filters) {
+                    if (NodeModule::topicMatches(filter.c_str(), message.topic.c_str())) {
+                        gatewayInbox.push_back(message);
+                        return;
+                    }
+                }
+            }
+
+            bool enqueue(const Message & message, bool canFail)
+            {
+                if (canFail && pending >= config.bufferSize) {
+                    failed++;
+                    return false;
+                }
+                SimTime serviceTime = config.rate > 0 ? (SimTime)(MICROS_PER_SECOND / config.rate) : 0;
+                serviceFreeAt = std::max(simulation.getTime(), serviceFreeAt) + serviceTime;
+                pending++;
+                simulation.schedule(serviceFreeAt - simulation.getTime() + config.latency, [this, message]() {
+                    pending--;
+                    route(message);
+                });
+                return true;
+            }
+
+        public:
+            unsigned long published {0};
+            unsigned long failed {0};
+
+            SimBroker(Simulation & simulation, const BrokerConfig & config):
+                simulation(simulation), config(config)
+            {}
+
+            void setCallback(Callback value) { callback = value; }
+            void addObserver(Observer observer) { observers.push_back(observer); }
+
+            // gateway side, mirrors PubSubClient
+            bool publish(const char * topic, const char * payload)
+            {
+                published++;
+                return enqueue({topic, payload}, true);
+            }
+
+            bool subscribe(const char * topic)
+            {
+                filters.push_back(topic);
+                return true;
+            }
+
+            // PubSubClient handles one incoming message per loop call
+            bool loop()
+            {
+                if (gatewayInbox.empty()) {
+                    return false;
+                }
+                Message message = gatewayInbox.front();
+                gatewayInbox.pop_front();
+                if (callback) {
+                    callback(message.topic.c_str(), (const uint8_t *)message.payload.data(), message.payload.size());
+                }
+                return true;
+            }
+
+            // publish from another client e.g. home automation sending set/json
+            void inject(const std::string & topic, const std::string & payload)
+            {
+                enqueue({topic, payload}, false);
+            }
+
+            uint16_t getPending() const { return pending; }
+            size_t getGatewayBacklog() const { return gatewayInbox.size(); }
+    };
+}
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef MESH_SIMULATOR_SIM_GATEWAY_H
+#define MESH_SIMULATOR_SIM_GATEWAY_H
+
+#include <FS.h>
+#include "CommonModule/MacroHelper.h"
+#include "MqttModule/MqttMessage.h"
+#include "NodeModule/MeshGateway.h"
+#include "NodeModule/SpillLog.h"
+#include "SimBroker.h"
+#include "SimRadio.h"
+#include <vector>
+
+// limits of nrf24l01-mqtt-gateway, override with -D to try other sizes
+#ifndef MAX_QUEUE_NODES
+#define MAX_QUEUE_NODES 8
+#endif
+#ifndef MAX_MESSAGE_QUEUE
+#define MAX_MESSAGE_QUEUE 4
+#endif
+#ifndef MAX_PAYLOADS
+#define MAX_PAYLOADS 8
+#endif
+#ifndef MAX_SUBSCRIBERS
+#define MAX_SUBSCRIBERS 100
+#endif
+#ifndef MAX_NODES_PER_TOPIC
+#define MAX_NODES_PER_TOPIC 5
+#endif
+
+namespace MeshSimulator
+{
+    using NodeModule::MeshGateway;
+    using NodeModule::SpillLog;
+    using NodeModule::PublishPolicy;
+
+    const uint8_t MAX_SENDS_PER_RUN {4};
+    const uint8_t MAX_REPLAYS_PER_RUN {4};
+    const uint16_t SPILL_CAPACITY {64};
+    const char * const ACK_TOPIC_SUFFIX {"/set/json"};
+    // radios of a gateway with SECOND_RADIO_CHANNEL and more
+    const uint8_t MAX_SIM_RADIOS {4};
+
+    // GatewayLimits of nrf24l01-mqtt-gateway
+    struct SimGatewayLimits
+    {
+        static const uint16_t MAX_FILTERS {MAX_SUBSCRIBERS};
+        static const uint8_t MAX_NODES_PER_FILTER {MAX_NODES_PER_TOPIC};
+        static const uint8_t MAX_DESTINATIONS {MAX_QUEUE_NODES};
+        static const uint8_t MAX_PER_DESTINATION {MAX_MESSAGE_QUEUE};
+        static const uint8_t PAYLOAD_SLOTS {MAX_PAYLOADS};
+        static const uint8_t MAX_MESSAGE_FAILURES {10};
+        static const uint16_t RETRY_INITIAL_DELAY {200};
+        static const uint16_t RETRY_MAX_DELAY {20000};
+        static const uint8_t MAX_MATCHED_NODES {16};
+        static const uint16_t MAX_NODE_ID {255};
+        static const uint8_t MAX_INBOUND_ALIASES {64};
+        static const uint8_t MAX_OUTBOUND_ALIASES {32};
+        static const uint8_t MAX_SEQUENCE_PEERS {32};
+        static const uint8_t MAX_SLEEPING_NODES {16};
+        static const uint8_t MAX_PUBLISHED_TOPICS {64};
+        static const uint8_t MAX_FAILING_NODES {4};
+        static const uint8_t RADIOS {MAX_SIM_RADIOS};
+    };
+
+    // nrf24l01-mqtt-gateway on top of the simulated radios and broker
+    // routing is NodeModule::MeshGateway as in the sketch, this class only plays its tasks in turn
+    class SimGateway
+    {
+        private:
+            // GatewayHost of the sketch
+            class Host
+            {
+                private:
+                    SimGateway & gateway;
+
+                public:
+                    Host(SimGateway & gateway):
+                        gateway(gateway)
+                    {}
+
+                    SimTransport & radio(uint8_t index) { return gateway.useRadio(index); }
+                    uint16_t nodeId(uint8_t, uint16_t address) { return address; }
+                    bool isConnected() { return true; }
+                    bool publish(const char * topic, const char * message, bool) { return gateway.broker.publish(topic, message); }
+                    bool subscribe(const char * filter) { return gateway.broker.subscribe(filter); }
+                    unsigned long now() { return gateway.simulation.getMillis(); }
+            };
+            using Spill = SpillLog<fs::File, SPILL_CAPACITY>;
+
+            Simulation & simulation;
+            SimBroker & broker;
+            // one per radio, the gateway is node 0 on each
+            std::vector<SimTransport> transports;
+            SimTime elapsed {0};
+            Host host;
+            // spilled messages go to a temporary file as they go to flash on the gateway
+            fs::File spillFile;
+            Spill spill;
+            PublishPolicy policies[1] {{"#", true, 300000}};
+            MeshGateway<Host, SimTransport, Spill, SimGatewayLimits> gateway;
+
+            // one spi bus, a send on any radio waits for the sends before it on the others
+            SimTransport & useRadio(uint8_t index)
+            {
+                for (auto & transport: transports) {
+                    elapsed = std::max(elapsed, transport.elapsed);
+                }
+                transports[index].elapsed = elapsed;
+                return transports[index];
+            }
+
+        public:
+            // radios are on separate channels, nodes of one channel do not wait for the other
+            SimGateway(Simulation & simulation, const std::vector<SimRadio *> & radios, SimBroker & broker):
+                simulation(simulation),
+                broker(broker),
+                host(*this),
+                spillFile(tmpfile()),
+                spill(spillFile),
+                gateway(host, spill, policies, COUNT_OF(policies), ACK_TOPIC_SUFFIX)
+            {
+                for (uint8_t i = 0; i < radios.size() && i < MAX_SIM_RADIOS; i++) {
+                    transports.emplace_back(*radios[i], 0);
+                }
+                spill.begin();
+                broker.setCallback([this](const char * topic, const uint8_t * payload, uint16_t len) {
+                    gateway.onMqttMessage(topic, payload, len);
+                });
+            }
+
+            // one pass of the gateway tasks, returns time the loop was blocked sending
+            SimTime loop()
+            {
+                elapsed = 0;
+                for (auto & transport: transports) {
+                    transport.elapsed = 0;
+                }
+                // the mqtt task keeps reading while messages are waiting
+                while (broker.loop()) {
+                }
+                for (uint8_t i = 0; i < transports.size(); i++) {
+                    while (transports[i].isAvailable()) {
+                        gateway.receive(i);
+                    }
+                }
+                gateway.sendMessages(MAX_SENDS_PER_RUN);
+                for (uint8_t i = 0; i < MAX_REPLAYS_PER_RUN && gateway.replayNext(); i++) {
+                }
+                for (auto & transport: transports) {
+                    elapsed = std::max(elapsed, transport.elapsed);
+                }
+                return elapsed;
+            }
+
+            // frames waiting in the fullest radio
+            size_t getInboxSize() const
+            {
+                size_t size {0};
+                for (auto & transport: transports) {
+                    size = std::max(size, transport.inboxSize());
+                }
+                return size;
+            }
+
+            const NodeModule::GatewayMetrics<SimGatewayLimits::MAX_FAILING_NODES> & getMetrics() { return gateway.sampleMetrics(); }
+            uint8_t getQueueSize() const { return gateway.getQueueSize(); }
+            uint8_t getPayloadsUsed() const { return gateway.getPayloadsUsed(); }
+            uint16_t getQueueDropped() const { return gateway.getQueueDropped(); }
+    };
+}
+
+#endif
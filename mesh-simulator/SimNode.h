@@ -0,0 +1,85 @@
+#ifndef MESH_SIMULATOR_SIM_NODE_H
+#define MESH_SIMULATOR_SIM_NODE_H
+
+#include <functional>
+#include "MqttModule/MqttMessage.h"
+#include "NodeModule/NodeClient.h"
+#include "NodeModule/SleepCycle.h"
+#include "SimRadio.h"
+
+namespace MeshSimulator
+{
+    using MqttModule::MqttMessage;
+    using NodeModule::NodeClient;
+    using NodeModule::SleepCycle;
+
+    // same limits as nrf24l01-arduino-node
+    const uint8_t NODE_OUT_ALIASES {4};
+    const uint8_t NODE_IN_ALIASES {NodeModule::MAX_NODE_ALIASES};
+
+    // nrf24l01-arduino-node reduced to its radio traffic
+    class SimNode
+    {
+        public:
+            typedef std::function<void(SimNode & node, const MqttMessage & message)> MessageCallback;
+
+        private:
+            // subscriber list passed to NodeClient::loop
+            struct Subscribers
+            {
+                SimNode & node;
+
+                void call(const MqttMessage & message)
+                {
+                    if (node.messageCallback) {
+                        node.messageCallback(node, message);
+                    }
+                }
+            };
+
+            SimTransport transport;
+            NodeClient<SimTransport, NODE_OUT_ALIASES, NODE_IN_ALIASES> client;
+            Subscribers subscribers;
+            MessageCallback messageCallback;
+
+        public:
+            const uint16_t id;
+            bool subscribed {false};
+            bool loopScheduled {false};
+            unsigned long publishFailed {0};
+            // used when the node runs in battery mode
+            SleepCycle sleepCycle;
+
+            SimNode(SimRadio & radio, uint16_t id, MessageCallback callback, uint32_t sleepPeriod = 0, uint16_t wakeWindow = 0):
+                transport(radio, id), client(transport), subscribers {*this}, messageCallback(callback), id(id), sleepCycle(sleepPeriod, wakeWindow)
+            {}
+
+            bool publish(const MqttMessage & message)
+            {
+                transport.elapsed = 0;
+                bool sent = client.publish(message);
+                publishFailed += sent ? 0 : 1;
+                return sent;
+            }
+
+            bool subscribe(const char * topic)
+            {
+                transport.elapsed = 0;
+                return client.subscribe(topic);
+            }
+
+            bool poll()
+            {
+                transport.elapsed = 0;
+                return client.poll(sleepCycle.getWindow());
+            }
+
+            uint8_t loop()
+            {
+                transport.elapsed = 0;
+                return client.loop(subscribers);
+            }
+    };
+}
+
+#endif
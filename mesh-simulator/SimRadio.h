@@ -0,0 +1,184 @@
+#ifndef MESH_SIMULATOR_SIM_RADIO_H
+#define MESH_SIMULATOR_SIM_RADIO_H
+
+#include <RF24Network.h>
+#include <deque>
+#include <functional>
+#include <map>
+#include <set>
+#include "MqttModule/MqttMessage.h"
+#include "Simulation.h"
+
+namespace MeshSimulator
+{
+    struct RadioConfig
+    {
+        // probability that a frame is not acknowledged after the hardware retries
+        double loss {0};
+        SimTime latency {1 * MICROS_PER_MS};
+        SimTime jitter {1 * MICROS_PER_MS};
+        // bytes added to every frame by the encryption (estimate)
+        uint16_t frameOverhead {16};
+        // frames waiting in a receiver before it reads them, RF24Network keeps a small fifo
+        uint8_t inboxSize {12};
+    };
+
+    // one shared channel between all nodes
+    // frames occupy the channel for their airtime, RF24Network splits them into 24 byte fragments
+    class SimRadio
+    {
+        public:
+            // called when a frame is placed in the node inbox
+            typedef std::function<void(uint16_t node)> DeliveryCallback;
+
+            // per fragment: 32 byte packet, auto ack and pll settling at 1Mbps
+            static const SimTime FRAGMENT_AIRTIME {600};
+            static const uint8_t FRAGMENT_PAYLOAD {24};
+
+        private:
+            struct Frame
+            {
+                RF24NetworkHeader header;
+                uint16_t length {0};
+                uint8_t data[sizeof(MqttModule::MqttMessage)] {0};
+            };
+
+            Simulation & simulation;
+            const RadioConfig config;
+            std::map<uint16_t, std::deque<Frame>> inboxes;
+            std::set<uint16_t> sleeping;
+            DeliveryCallback deliveryCallback;
+            SimTime channelFreeAt {0};
+
+        public:
+            unsigned long framesSent {0};
+            unsigned long framesLost {0};
+            unsigned long framesOverflowed {0};
+            unsigned long framesToSleeping {0};
+            unsigned long long bytesSent {0};
+
+            SimRadio(Simulation & simulation, const RadioConfig & config):
+                simulation(simulation), config(config)
+            {}
+
+            void setDeliveryCallback(DeliveryCallback callback) { deliveryCallback = callback; }
+
+            // a node with its radio powered down does not acknowledge frames
+            void setListening(uint16_t node, bool listening)
+            {
+                if (listening) {
+                    sleeping.erase(node);
+                } else {
+                    sleeping.insert(node);
+                }
+            }
+
+            SimTime airtime(uint16_t length) const
+            {
+                uint16_t fragments = (length + config.frameOverhead + FRAGMENT_PAYLOAD - 1) / FRAGMENT_PAYLOAD;
+                return (fragments > 0 ? fragments : 1) * FRAGMENT_AIRTIME;
+            }
+
+            // returns false when the frame was not acknowledged
+            // elapsed is increased by the time the sender was blocked
+            bool send(uint16_t from, uint16_t to, const void * data, uint16_t length, uint8_t type, SimTime & elapsed)
+            {
+                if (length > sizeof(Frame::data)) {
+                    return false;
+                }
+                SimTime start = std::max(simulation.getTime() + elapsed, channelFreeAt);
+                channelFreeAt = start + airtime(length);
+                elapsed = channelFreeAt - simulation.getTime();
+                framesSent++;
+                bytesSent += length + config.frameOverhead;
+                if (simulation.chance(config.loss)) {
+                    framesLost++;
+                    return false;
+                }
+                if (sleeping.count(to) > 0) {
+                    framesToSleeping++;
+                    return false;
+                }
+                Frame frame;
+                frame.header.from_node = from;
+                frame.header.to_node = to;
+                frame.header.type = type;
+                frame.header.id = RF24NetworkHeader::next_id++;
+                frame.length = length;
+                memcpy(frame.data, data, length);
+                SimTime delay = elapsed + config.latency + simulation.uniform(0, config.jitter);
+                simulation.schedule(delay, [this, frame, to]() {
+                    auto & inbox = inboxes[to];
+                    if (inbox.size() >= config.inboxSize) {
+                        framesOverflowed++;
+                        return;
+                    }
+                    inbox.push_back(frame);
+                    if (deliveryCallback) {
+                        deliveryCallback(to);
+                    }
+                });
+                return true;
+            }
+
+            bool isAvailable(uint16_t node)
+            {
+                return !inboxes[node].empty();
+            }
+
+            bool receive(uint16_t node, void * data, uint16_t length, RF24NetworkHeader & header)
+            {
+                auto & inbox = inboxes[node];
+                if (inbox.empty()) {
+                    return false;
+                }
+                const Frame & frame = inbox.front();
+                header = frame.header;
+                memcpy(data, frame.data, std::min(length, frame.length));
+                inbox.pop_front();
+                return true;
+            }
+
+            size_t inboxSize(uint16_t node)
+            {
+                return inboxes[node].size();
+            }
+    };
+
+    // stands in for EncryptedMesh/EncryptedNetwork of one node
+    class SimTransport
+    {
+        private:
+            SimRadio & radio;
+            const uint16_t node;
+
+        public:
+            // time spent sending since the last reset, the caller is blocked for it
+            SimTime elapsed {0};
+
+            SimTransport(SimRadio & radio, uint16_t node):
+                radio(radio), node(node)
+            {}
+
+            bool send(const void * data, uint16_t length, uint8_t type, uint16_t to)
+            {
+                return radio.send(node, to, data, length, type, elapsed);
+            }
+
+            bool receive(void * data, uint16_t length, uint8_t, RF24NetworkHeader & header)
+            {
+                return radio.receive(node, data, length, header);
+            }
+
+            bool isAvailable()
+            {
+                return radio.isAvailable(node);
+            }
+
+            size_t inboxSize() const { return radio.inboxSize(node); }
+
+            uint16_t getNode() const { return node; }
+    };
+}
+
+#endif
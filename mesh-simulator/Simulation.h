@@ -0,0 +1,85 @@
+#ifndef MESH_SIMULATOR_SIMULATION_H
+#define MESH_SIMULATOR_SIMULATION_H
+
+#include <Arduino.h>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace MeshSimulator
+{
+    // simulated time in microseconds
+    typedef unsigned long long SimTime;
+
+    const SimTime MICROS_PER_MS {1000};
+    const SimTime MICROS_PER_SECOND {1000000};
+
+    // discrete event loop, events run in time order and in scheduling order when times are equal
+    // all randomness comes from one seeded generator so runs are repeatable
+    class Simulation
+    {
+        private:
+            struct Event
+            {
+                SimTime time;
+                unsigned long sequence;
+                std::function<void()> action;
+
+                bool operator>(const Event & other) const
+                {
+                    return time != other.time ? time > other.time : sequence > other.sequence;
+                }
+            };
+
+            std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+            unsigned long sequence {0};
+            unsigned long processed {0};
+            SimTime now {0};
+            std::mt19937 generator;
+
+        public:
+            Simulation(unsigned long seed):
+                generator(seed)
+            {}
+
+            SimTime getTime() const { return now; }
+            unsigned long getMillis() const { return (unsigned long)(now / MICROS_PER_MS); }
+            unsigned long getProcessed() const { return processed; }
+
+            void schedule(SimTime delay, std::function<void()> action)
+            {
+                events.push({now + delay, sequence++, action});
+            }
+
+            void run(SimTime endTime)
+            {
+                while (!events.empty() && events.top().time <= endTime) {
+                    Event event = events.top();
+                    events.pop();
+                    now = event.time;
+                    event.action();
+                    processed++;
+                }
+                now = endTime;
+            }
+
+            bool chance(double probability)
+            {
+                return probability > 0 && std::uniform_real_distribution<double>(0, 1)(generator) < probability;
+            }
+
+            SimTime uniform(SimTime min, SimTime max)
+            {
+                return max > min ? std::uniform_int_distribution<SimTime>(min, max)(generator) : min;
+            }
+
+            // time until the next event of a poisson process with rate per second
+            SimTime exponential(double ratePerSecond)
+            {
+                return (SimTime)(std::exponential_distribution<double>(ratePerSecond)(generator) * MICROS_PER_SECOND) + 1;
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef MESH_SIMULATOR_STATS_H
+#define MESH_SIMULATOR_STATS_H
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include "Simulation.h"
+
+namespace MeshSimulator
+{
+    // end to end delivery of one kind of traffic
+    // messages carry their id as payload, latency is measured from send to delivery
+    class TrafficStats
+    {
+        private:
+            std::unordered_map<unsigned long, SimTime> inFlight;
+            std::vector<SimTime> latencies;
+            unsigned long sent {0};
+            unsigned long duplicates {0};
+
+        public:
+            const char * name;
+
+            TrafficStats(const char * name):
+                name(name)
+            {}
+
+            void markSent(unsigned long id, SimTime time)
+            {
+                inFlight[id] = time;
+                sent++;
+            }
+
+            void markDelivered(unsigned long id, SimTime time)
+            {
+                auto item = inFlight.find(id);
+                if (item == inFlight.end()) {
+                    duplicates++;
+                    return;
+                }
+                latencies.push_back(time - item->second);
+                inFlight.erase(item);
+            }
+
+            unsigned long getSent() const { return sent; }
+            unsigned long getDelivered() const { return latencies.size(); }
+            unsigned long getLost() const { return inFlight.size(); }
+            unsigned long getDuplicates() const { return duplicates; }
+
+            // percentile in milliseconds
+            double percentile(double value)
+            {
+                if (latencies.empty()) {
+                    return 0;
+                }
+                std::sort(latencies.begin(), latencies.end());
+                size_t index = std::min(latencies.size() - 1, (size_t)(value / 100 * latencies.size()));
+                return (double)latencies[index] / MICROS_PER_MS;
+            }
+    };
+
+    // samples of a gauge such as queue occupancy
+    class GaugeStats
+    {
+        private:
+            unsigned long samples {0};
+            unsigned long long total {0};
+            unsigned long maximum {0};
+
+        public:
+            void sample(unsigned long value)
+            {
+                samples++;
+                total += value;
+                maximum = std::max(maximum, value);
+            }
+
+            double getAverage() const { return samples > 0 ? (double)total / samples : 0; }
+            unsigned long getMaximum() const { return maximum; }
+    };
+}
+
+#endif
@@ -0,0 +1,337 @@
+struct Argument
+{
+    const char * name;
+    const char * description;
+};
+
+const Argument ARGUMENTS[] {
+    {"nodes", "number of arduino nodes, upper bound with sweep"},
+    {"seconds", "simulated time"},
+    {"seed", "random seed, same seed gives the same numbers"},
+    {"pinRate", "pin changes per node per second"},
+    {"keepAlive", "keep alive interval per node in ms"},
+    {"commandRate", "set/json commands per node per second"},
+    {"loss", "probability a radio frame is not acknowledged 0..1"},
+    {"latency", "radio latency in ms"},
+    {"jitter", "radio latency jitter in ms"},
+    {"inbox", "frames buffered by a receiver"},
+    {"brokerRate", "messages per second the broker path carries, 0 unlimited"},
+    {"brokerLatency", "broker latency in ms"},
+    {"brokerBuffer", "publishes waiting before gateway publish fails"},
+    {"gatewayLoop", "gateway loop period in ms"},
+    {"nodeLoop", "node loop period in ms"},
+    {"sleepPeriod", "battery nodes sleep this many ms between wakes, 0 always awake"},
+    {"wakeWindow", "ms a battery node listens after each wake"},
+    {"radios", "gateway radios on separate channels, nodes are spread over them"},
+    {"sweep", "1 to run with 1, 2, 4 .. nodes"},
+};
+
+void printUsage()
+{
+    printf("usage: mesh-simulator [key=value ...]\n\n");
+    for (const auto & argument: ARGUMENTS) {
+        printf("  %-14s %s\n", argument.name, argument.description);
+    }
+}
+
+SimTime toMicros(double ms)
+{
+    return (SimTime)(ms * MICROS_PER_MS);
+}
+
+bool parseArguments(int argc, char ** argv, Config & config)
+{
+    for (int i = 1; i < argc; i++) {
+        const char * separator = strchr(argv[i], '=');
+        if (!separator) {
+            fprintf(stderr, "expected key=value: %s\n", argv[i]);
+            return false;
+        }
+        std::string key(argv[i], separator - argv[i]);
+        double value = atof(separator + 1);
+        if (key == "nodes") config.nodes = (uint16_t)value;
+        else if (key == "seconds") config.seconds = (unsigned long)value;
+        else if (key == "seed") config.seed = (unsigned long)value;
+        else if (key == "pinRate") config.pinRate = value;
+        else if (key == "keepAlive") config.keepAlive = (unsigned long)value;
+        else if (key == "commandRate") config.commandRate = value;
+        else if (key == "loss") config.radio.loss = value;
+        else if (key == "latency") config.radio.latency = toMicros(value);
+        else if (key == "jitter") config.radio.jitter = toMicros(value);
+        else if (key == "inbox") config.radio.inboxSize = (uint8_t)value;
+        else if (key == "brokerRate") config.broker.rate = value;
+        else if (key == "brokerLatency") config.broker.latency = toMicros(value);
+        else if (key == "brokerBuffer") config.broker.bufferSize = (uint16_t)value;
+        else if (key == "gatewayLoop") config.gatewayLoop = toMicros(value);
+        else if (key == "nodeLoop") config.nodeLoop = toMicros(value);
+        else if (key == "sleepPeriod") config.sleepPeriod = (unsigned long)value;
+        else if (key == "wakeWindow") config.wakeWindow = (unsigned long)value;
+        else if (key == "radios") config.radios = (uint8_t)value;
+        else if (key == "sweep") config.sweep = value > 0;
+        else {
+            fprintf(stderr, "unknown argument: %s\n", key.c_str());
+            return false;
+        }
+    }
+    if (config.sleepPeriod > 0 && config.sleepPeriod <= config.wakeWindow) {
+        fprintf(stderr, "sleepPeriod must be longer than wakeWindow\n");
+        return false;
+    }
+    if (config.radios < 1 || config.radios > MAX_SIM_RADIOS) {
+        fprintf(stderr, "radios must be 1..%u\n", MAX_SIM_RADIOS);
+        return false;
+    }
+    if (config.nodes < 1 || config.nodes > MAX_SIM_NODES) {
+        fprintf(stderr, "nodes must be 1..%u\n", MAX_SIM_NODES);
+        return false;
+    }
+    return true;
+}
+
+void formatTopic(char * topic, uint16_t node, const char * channel)
+{
+    snprintf(topic, MQTT_MAX_LEN_TOPIC, "sim/%u/%s", node, channel);
+}
+
+// message payload is the id used to measure latency
+MqttMessage createMessage(uint16_t node, const char * channel, unsigned long id)
+{
+    MqttMessage message;
+    formatTopic(message.topic, node, channel);
+    snprintf(message.message, COUNT_OF(message.message), "%lu", id);
+    return message;
+}
+
+// subscribes like subscribeToChannels, retried until the gateway acknowledges both frames
+void scheduleSubscribe(Simulation & simulation, SimNode & node, SimTime delay)
+{
+    simulation.schedule(delay, [&simulation, &node]() {
+        char topic[MQTT_MAX_LEN_TOPIC] {0};
+        formatTopic(topic, node.id, "subscribe");
+        bool subscribed = node.subscribe(topic);
+        formatTopic(topic, node.id, "set/json");
+        node.subscribed = subscribed && node.subscribe(topic);
+        if (!node.subscribed) {
+            scheduleSubscribe(simulation, node, SUBSCRIBE_RETRY * MICROS_PER_MS);
+        }
+    });
+}
+
+void schedulePinChange(Simulation & simulation, SimNode & node, const Config & config, Result & result, unsigned long & nextId)
+{
+    if (!(config.pinRate > 0)) {
+        return;
+    }
+    simulation.schedule(simulation.exponential(config.pinRate), [&simulation, &node, &config, &result, &nextId]() {
+        unsigned long id = nextId++;
+        result.pins.markSent(id, simulation.getTime());
+        node.publish(createMessage(node.id, "states/digital/2", id));
+        schedulePinChange(simulation, node, config, result, nextId);
+    });
+}
+
+void scheduleKeepAlive(Simulation & simulation, SimNode & node, SimTime delay, const Config & config, Result & result, unsigned long & nextId)
+{
+    simulation.schedule(delay, [&simulation, &node, &config, &result, &nextId]() {
+        unsigned long id = nextId++;
+        result.keepAlives.markSent(id, simulation.getTime());
+        node.publish(createMessage(node.id, "keep-alive", id));
+        scheduleKeepAlive(simulation, node, config.keepAlive * MICROS_PER_MS, config, result, nextId);
+    });
+}
+
+// commands come from another mqtt client through the broker
+void scheduleCommand(Simulation & simulation, SimBroker & broker, uint16_t node, const Config & config, Result & result, unsigned long & nextId)
+{
+    if (!(config.commandRate > 0)) {
+        return;
+    }
+    simulation.schedule(simulation.exponential(config.commandRate), [&simulation, &broker, node, &config, &result, &nextId]() {
+        unsigned long id = nextId++;
+        MqttMessage message = createMessage(node, "set/json", id);
+        result.commands.markSent(id, simulation.getTime());
+        broker.inject(message.topic, message.message);
+        scheduleCommand(simulation, broker, node, config, result, nextId);
+    });
+}
+
+// battery node: radio on, poll, listen for the wake window, radio off until the next wake
+void scheduleWake(Simulation & simulation, SimRadio & radio, SimNode & node, SimTime delay)
+{
+    simulation.schedule(delay, [&simulation, &radio, &node]() {
+        radio.setListening(node.id, true);
+        node.sleepCycle.woke(simulation.getMillis());
+        node.poll();
+        simulation.schedule(node.sleepCycle.getWindow() * MICROS_PER_MS, [&simulation, &radio, &node]() {
+            radio.setListening(node.id, false);
+            scheduleWake(simulation, radio, node, node.sleepCycle.sleepTime(simulation.getMillis()) * MICROS_PER_MS);
+        });
+    });
+}
+
+// time the gateway spent sending delays its next loop
+void scheduleGatewayLoop(Simulation & simulation, SimGateway & gateway, SimBroker & broker, SimTime delay, const Config & config, Result & result)
+{
+    simulation.schedule(delay, [&simulation, &gateway, &broker, &config, &result]() {
+        result.gatewayInbox.sample(gateway.getInboxSize());
+        SimTime blocked = gateway.loop();
+        result.queue.sample(gateway.getQueueSize());
+        result.payloads.sample(gateway.getPayloadsUsed());
+        result.brokerPending.sample(broker.getPending());
+        scheduleGatewayLoop(simulation, gateway, broker, config.gatewayLoop + blocked, config, result);
+    });
+}
+
+bool endsWith(const char * value, const char * suffix)
+{
+    size_t valueLength = strlen(value);
+    size_t suffixLength = strlen(suffix);
+    return valueLength >= suffixLength && strcmp(value + valueLength - suffixLength, suffix) == 0;
+}
+
+void runSimulation(const Config & config, Result & result)
+{
+    Simulation simulation(config.seed);
+    std::vector<std::unique_ptr<SimRadio>> radios;
+    std::vector<SimRadio *> gatewayRadios;
+    for (uint8_t i = 0; i < config.radios; i++) {
+        radios.emplace_back(new SimRadio(simulation, config.radio));
+        gatewayRadios.push_back(radios.back().get());
+    }
+    SimBroker broker(simulation, config.broker);
+    std::unique_ptr<SimGateway> gateway(new SimGateway(simulation, gatewayRadios, broker));
+    unsigned long nextId {1};
+
+    // like RADIO_CHANNEL of the node, the gateway finds out from the frames
+    auto radioOf = [&radios](uint16_t id) -> SimRadio & {
+        return *radios[(id - 1) % radios.size()];
+    };
+
+    std::vector<std::unique_ptr<SimNode>> nodes;
+    for (uint16_t id = 1; id <= config.nodes; id++) {
+        nodes.emplace_back(new SimNode(radioOf(id), id, [&simulation, &result](SimNode &, const MqttMessage & message) {
+            if (endsWith(message.topic, "/set/json")) {
+                result.commands.markDelivered(atol(message.message), simulation.getTime());
+            }
+        }, config.sleepPeriod, config.wakeWindow));
+    }
+
+    // end to end latency of node messages is measured when the broker routes them
+    broker.addObserver([&simulation, &result](const std::string & topic, const std::string & payload) {
+        if (endsWith(topic.c_str(), "/keep-alive")) {
+            result.keepAlives.markDelivered(atol(payload.c_str()), simulation.getTime());
+        } else if (topic.find("/states/") != std::string::npos) {
+            result.pins.markDelivered(atol(payload.c_str()), simulation.getTime());
+        }
+    });
+
+    // nodes read their inbox on the next loop after a frame arrives
+    for (auto & radio: radios) {
+        radio->setDeliveryCallback([&simulation, &nodes, &config](uint16_t id) {
+            if (id == 0 || id > nodes.size() || nodes[id - 1]->loopScheduled) {
+                return;
+            }
+            SimNode & node = *nodes[id - 1];
+            node.loopScheduled = true;
+            simulation.schedule(simulation.uniform(1, config.nodeLoop), [&node]() {
+                node.loopScheduled = false;
+                node.loop();
+            });
+        });
+    }
+
+    scheduleGatewayLoop(simulation, *gateway, broker, config.gatewayLoop, config, result);
+    for (auto & node: nodes) {
+        scheduleSubscribe(simulation, *node, simulation.uniform(0, MICROS_PER_SECOND));
+        scheduleKeepAlive(simulation, *node, simulation.uniform(0, config.keepAlive * MICROS_PER_MS), config, result, nextId);
+        schedulePinChange(simulation, *node, config, result, nextId);
+        scheduleCommand(simulation, broker, node->id, config, result, nextId);
+        if (config.sleepPeriod > 0) {
+            radioOf(node->id).setListening(node->id, false);
+            scheduleWake(simulation, radioOf(node->id), *node, simulation.uniform(0, config.sleepPeriod * MICROS_PER_MS));
+        }
+    }
+
+    simulation.run(config.seconds * MICROS_PER_SECOND);
+
+    result.nodes = config.nodes;
+    result.seconds = config.seconds;
+    result.events = simulation.getProcessed();
+    for (auto & node: nodes) {
+        result.nodePublishFailed += node->publishFailed;
+    }
+    const auto & metrics = gateway->getMetrics();
+    result.queueDropped = metrics.queueDropped;
+    result.poolExhausted = metrics.payloads.full;
+    result.unroutable = metrics.unroutable;
+    result.gatewaySendFailed = metrics.sendFailed;
+    result.aliasResets = metrics.aliasResets;
+    result.commandsAcked = metrics.acked;
+    result.duplicates = metrics.duplicates;
+    result.polls = metrics.polls;
+    result.spilled = metrics.spillSize;
+    result.spillDropped = metrics.spillDropped;
+    for (auto & radio: radios) {
+        result.framesToSleeping += radio->framesToSleeping;
+        result.framesSent += radio->framesSent;
+        result.framesLost += radio->framesLost;
+        result.framesOverflowed += radio->framesOverflowed;
+    }
+    result.brokerFailed = broker.failed;
+}
+
+void printTraffic(TrafficStats & traffic, double seconds)
+{
+    printf("  %-11s %8lu %9lu %8lu %9.1f %9.2f %9.2f\n",
+        traffic.name, traffic.getSent(), traffic.getDelivered(), traffic.getLost(),
+        traffic.getDelivered() / seconds, traffic.percentile(50), traffic.percentile(99));
+}
+
+void printReport(const Config & config, Result & result)
+{
+    unsigned long delivered = result.pins.getDelivered() + result.keepAlives.getDelivered() + result.commands.getDelivered();
+    printf("nodes %u, radios %u, %lu s, seed %lu, loss %.3f, broker rate %.0f/s, %lu events\n\n",
+        config.nodes, config.radios, config.seconds, config.seed, config.radio.loss, config.broker.rate, result.events);
+
+    printf("  %-11s %8s %9s %8s %9s %9s %9s\n", "traffic", "sent", "delivered", "lost", "msgs/s", "p50 ms", "p99 ms");
+    printTraffic(result.pins, result.seconds);
+    printTraffic(result.keepAlives, result.seconds);
+    printTraffic(result.commands, result.seconds);
+    printf("  %-11s %37.1f\n\n", "total", delivered / result.seconds);
+
+    printf("gateway occupancy     average   max\n");
+    printf("  message queue      %8.2f %5lu (capacity %d)\n", result.queue.getAverage(), result.queue.getMaximum(), MAX_QUEUE_NODES * MAX_MESSAGE_QUEUE);
+    printf("  payload pool       %8.2f %5lu (capacity %d)\n", result.payloads.getAverage(), result.payloads.getMaximum(), MAX_PAYLOADS);
+    printf("  radio inbox        %8.2f %5lu (capacity %u)\n", result.gatewayInbox.getAverage(), result.gatewayInbox.getMaximum(), config.radio.inboxSize);
+    printf("  broker pending     %8.2f %5lu (capacity %u)\n\n", result.brokerPending.getAverage(), result.brokerPending.getMaximum(), config.broker.bufferSize);
+
+    printf("drops\n");
+    printf("  node publish not acked  %lu\n", result.nodePublishFailed);
+    printf("  radio frames lost       %lu of %lu\n", result.framesLost, result.framesSent);
+    printf("  radio inbox overflow    %lu\n", result.framesOverflowed);
+    printf("  gateway queue dropped   %lu\n", result.queueDropped);
+    printf("  gateway pool exhausted  %lu\n", result.poolExhausted);
+    printf("  gateway send retries    %lu\n", result.gatewaySendFailed);
+    printf("  gateway unroutable      %lu\n", result.unroutable);
+    printf("  alias resets            %lu\n", result.aliasResets);
+    printf("  commands acked          %lu\n", result.commandsAcked);
+    printf("  repeated frames dropped %lu\n", result.duplicates);
+    printf("  polls from sleeping     %lu\n", result.polls);
+    printf("  frames to sleeping      %lu\n", result.framesToSleeping);
+    printf("  broker publish failed   %lu\n", result.brokerFailed);
+    printf("  spilled at end          %lu\n", result.spilled);
+    printf("  spill overwritten       %lu\n", result.spillDropped);
+}
+
+void printSweepHeader()
+{
+    printf("%5s %9s %9s %9s %9s %9s %8s %8s %8s\n", "nodes", "msgs/s", "p50 ms", "p99 ms", "cmd p99", "queue max", "q drops", "pool", "broker");
+}
+
+void printSweepLine(Result & result)
+{
+    unsigned long delivered = result.pins.getDelivered() + result.keepAlives.getDelivered() + result.commands.getDelivered();
+    printf("%5u %9.1f %9.2f %9.2f %9.2f %9lu %8lu %8lu %8lu\n",
+        result.nodes, delivered / result.seconds, result.pins.percentile(50), result.pins.percentile(99), result.commands.percentile(99),
+        result.queue.getMaximum(), result.queueDropped, result.poolExhausted, result.brokerFailed);
+}
@@ -0,0 +1,136 @@
+#include <Arduino.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "CommonModule/MacroHelper.h"
+#include "MqttModule/MqttMessage.h"
+#include "Simulation.h"
+#include "Stats.h"
+#include "SimRadio.h"
+#include "SimBroker.h"
+#include "SimNode.h"
+#include "SimGateway.h"
+
+using MqttModule::MqttMessage;
+using MeshSimulator::SimTime;
+using MeshSimulator::Simulation;
+using MeshSimulator::TrafficStats;
+using MeshSimulator::GaugeStats;
+using MeshSimulator::RadioConfig;
+using MeshSimulator::SimRadio;
+using MeshSimulator::BrokerConfig;
+using MeshSimulator::SimBroker;
+using MeshSimulator::SimNode;
+using MeshSimulator::SimGateway;
+using MeshSimulator::MAX_SIM_RADIOS;
+using MeshSimulator::MICROS_PER_MS;
+using MeshSimulator::MICROS_PER_SECOND;
+
+// runs N nrf24l01-arduino-node instances and one nrf24l01-mqtt-gateway in simulated time
+// built from the same NodeModule code as the sketches
+//
+// usage: mesh-simulator [key=value ...], see printUsage
+
+const unsigned long SUBSCRIBE_RETRY {5000};
+const uint16_t MAX_SIM_NODES {254};
+
+struct Config
+{
+    uint16_t nodes {8};
+    unsigned long seconds {300};
+    unsigned long seed {1};
+    // pin changes per node per second
+    double pinRate {0.1};
+    // sendLiveData interval in ms, DISPLAY_TIME of the arduino node
+    unsigned long keepAlive {30000};
+    // set/json commands per node per second
+    double commandRate {0.05};
+    SimTime gatewayLoop {1 * MICROS_PER_MS};
+    SimTime nodeLoop {1 * MICROS_PER_MS};
+    // battery nodes sleep for this many ms between wakes, 0 keeps them awake
+    unsigned long sleepPeriod {0};
+    unsigned long wakeWindow {100};
+    // gateway radios on separate channels, nodes are spread over them by id
+    uint8_t radios {1};
+    // run with 1, 2, 4 .. nodes and print one line per run
+    bool sweep {false};
+    RadioConfig radio;
+    BrokerConfig broker;
+};
+
+struct Result
+{
+    uint16_t nodes {0};
+    double seconds {0};
+    unsigned long events {0};
+    TrafficStats pins {"pin states"};
+    TrafficStats keepAlives {"keep alive"};
+    TrafficStats commands {"set/json"};
+    GaugeStats queue;
+    GaugeStats payloads;
+    GaugeStats gatewayInbox;
+    GaugeStats brokerPending;
+    unsigned long nodePublishFailed {0};
+    unsigned long queueDropped {0};
+    unsigned long poolExhausted {0};
+    unsigned long unroutable {0};
+    unsigned long gatewaySendFailed {0};
+    unsigned long aliasResets {0};
+    unsigned long commandsAcked {0};
+    unsigned long duplicates {0};
+    unsigned long polls {0};
+    unsigned long framesToSleeping {0};
+    unsigned long framesSent {0};
+    unsigned long framesLost {0};
+    unsigned long framesOverflowed {0};
+    unsigned long brokerFailed {0};
+    unsigned long spilled {0};
+    unsigned long spillDropped {0};
+};
+
+#include "helpers.h"
+
+int main(int argc, char ** argv)
+{
+    Config config;
+    if (!parseArguments(argc, argv, config)) {
+        printUsage();
+        return 1;
+    }
+
+    if (!config.sweep) {
+        std::unique_ptr<Result> result(new Result());
+        runSimulation(config, *result);
+        printReport(config, *result);
+        return 0;
+    }
+
+    std::vector<uint16_t> nodeCounts;
+    for (uint16_t nodes = 1; nodes < config.nodes; nodes *= 2) {
+        nodeCounts.push_back(nodes);
+    }
+    nodeCounts.push_back(config.nodes);
+
+    printSweepHeader();
+    uint16_t limit {0};
+    for (auto nodes: nodeCounts) {
+        Config run = config;
+        run.nodes = nodes;
+        std::unique_ptr<Result> result(new Result());
+        runSimulation(run, *result);
+        printSweepLine(*result);
+        if (!limit && (result->queueDropped > 0 || result->poolExhausted > 0 || result->brokerFailed > 0)) {
+            limit = nodes;
+        }
+    }
+    if (limit > 0) {
+        printf("\nfirst overflow with %u nodes (MAX_MESSAGE_QUEUE %d, MAX_QUEUE_NODES %d, MAX_PAYLOADS %d)\n", limit, MAX_MESSAGE_QUEUE, MAX_QUEUE_NODES, MAX_PAYLOADS);
+    } else {
+        printf("\nno overflow up to %u nodes\n", config.nodes);
+    }
+    return 0;
+}
@@ -3,47 +3,256 @@ void operator delete(void* obj, unsigned int n)
     free(obj); 
 } 
 
-bool sendLiveData(MeshMqttClient & client)
+bool sendStateBatch(MeshClient & client, const MessageBatch & batch)
 {
-    char topic[MQTT_MAX_LEN_TOPIC] {0};
-    snprintf_P(topic, COUNT_OF(topic), CHANNEL_KEEP_ALIVE);
-    if (!client.publish(topic, millis())) {
-        error("Failed to publish keep alive");
+    if (batch.size() > 0 && !client.publish(batch)) {
+        error("Failed to publish state");
         return false;
-    }	
+    }
     return true;
 }
 
-bool sendStateData(MeshMqttClient & client, ValueProviderFactory & provider, const Pin & pin)
+// keep alive, every KEEP_ALIVE_STATS th one carries memory and pool usage in the same frames
+// the values size MAX_SUBSCRIBERS etc. from the field
+// sk deepest stack, fr fewest bytes between heap and stack, ao/ai aliases used, ar aliases replaced
+// sb/sbm/sbf subscriptions used/high water/failed, pn pins in the pin collection, tc topics cached
+bool sendLiveData(MeshClient & client, const PoolUsage & subscriptions, uint8_t pinCount, uint8_t cachedTopics, uint16_t keepAlive)
 {
+    MessageBatch batch;
     MqttMessage msg;
-    snprintf_P(msg.topic, COUNT_OF(msg.topic), CHANNEL_INFO, provider.getMatchingTopicType(pin), pin.id);
-    provider.formatMessage(msg.message, COUNT_OF(msg.message), pin);
+    snprintf_P(msg.topic, COUNT_OF(msg.topic), CHANNEL_KEEP_ALIVE);
+    snprintf(msg.message, COUNT_OF(msg.message), "%lu", millis());
+    batch.add(msg);
 
-    if (!client.publish(msg)) {
-        error("Failed to publish state");
+    bool published {true};
+#if KEEP_ALIVE_STATS > 0
+    if (keepAlive % KEEP_ALIVE_STATS == 0) {
+        const char keys[][4] {"sk", "fr", "ao", "ai", "ar", "sb", "sbm", "sbf", "pn", "tc"};
+        const uint16_t values[] {
+            stackHighWater(),
+            stackMargin(),
+            client.getOutboundAliases().used(),
+            client.getInboundAliases().used(),
+            (uint16_t)(client.getOutboundAliases().getReplaced() + client.getInboundAliases().getReplaced()),
+            subscriptions.used,
+            subscriptions.highWater,
+            subscriptions.full,
+            pinCount,
+            cachedTopics
+        };
+        for (uint8_t i = 0; i < COUNT_OF(values); i++) {
+            snprintf_P(msg.topic, COUNT_OF(msg.topic), PSTR(MQTT_CLIENT_NAME "/stats/%s"), keys[i]);
+            snprintf(msg.message, COUNT_OF(msg.message), "%u", values[i]);
+            if (!batch.add(msg)) {
+                published = sendStateBatch(client, batch) && published;
+                batch.clear();
+                batch.add(msg);
+            }
+        }
+    }
+#endif
+    if (!sendStateBatch(client, batch) || !published) {
+        error("Failed to publish keep alive");
         return false;
     }
     return true;
 }
 
-unsigned long subscribeToChannels(MeshMqttClient & client, SubscribeHandler & subscribeHandler, PinStateJsonHandler & jsonHandler)
+// topics of the pins first, then the subscribe and set/json topics
+bool formatTopic(ValueProviderFactory & provider, const Pin * pins, uint8_t count, uint8_t index, char * topic, uint8_t size)
+{
+    if (index < count) {
+        return snprintf_P(topic, size, CHANNEL_INFO, provider.getMatchingTopicType(pins[index]), pins[index].id) < size;
+    }
+    return snprintf_P(topic, size, index == count ? CHANNEL_SUBSCRIBE : CHANNEL_SET_JSON) < size;
+}
+
+template<typename Topics>
+bool buildTopics(Topics & topics, ValueProviderFactory & provider, const Pin * pins, uint8_t count)
+{
+    return topics.build(count + 2, [&](uint8_t index, char * topic, uint8_t size) {
+        return formatTopic(provider, pins, count, index, topic, size);
+    });
+}
+
+// formats the topic only when the cache could not be built
+template<typename Topics>
+void copyTopic(const Topics & topics, ValueProviderFactory & provider, const Pin * pins, uint8_t count, uint8_t index, char * topic, uint8_t size)
+{
+    if (!topics.copy(index, topic, size)) {
+        formatTopic(provider, pins, count, index, topic, size);
+    }
+}
+
+// subscribe topics of this node the subscriber list holds, asked from the list itself
+template<typename Subscribers, typename Topics>
+uint8_t countSubscribed(Subscribers & subscribers, const Topics & topics, ValueProviderFactory & provider, const Pin * pins, uint8_t count)
+{
+    uint8_t subscribed {0};
+    char topic[MQTT_MAX_LEN_TOPIC] {0};
+    for (uint8_t index = count; index < count + 2; index++) {
+        copyTopic(topics, provider, pins, count, index, topic, COUNT_OF(topic));
+        subscribed += subscribers.hasSubscribed(topic) ? 1 : 0;
+    }
+    return subscribed;
+}
+
+// returns false if the formatted value is not a number
+template<typename Topics>
+bool formatStateData(ValueProviderFactory & provider, const Topics & topics, const Pin * pins, uint8_t count, uint8_t index, MqttMessage & msg, float & value)
+{
+    copyTopic(topics, provider, pins, count, index, msg.topic, COUNT_OF(msg.topic));
+    provider.formatMessage(msg.message, COUNT_OF(msg.message), pins[index]);
+    char * end {nullptr};
+    value = strtod(msg.message, &end);
+    return end != msg.message;
+}
+
+// changed pins go through the filter, the ones due are sent together in as few frames as possible
+template<typename Topics, typename Filter>
+uint8_t sendStateData(MeshClient & client, ValueProviderFactory & provider, const Topics & topics, Pin * pins, uint8_t count, Filter & filter)
+{
+    MessageBatch batch;
+    uint8_t sent {0};
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < count; i++) {
+        Pin & pin = pins[i];
+        if (!(pin.id > 0)) {
+            continue;
+        }
+        MqttMessage msg;
+        float value {0};
+        bool formatted {false};
+        if (pin.changed) {
+            pin.changed = false;
+            formatted = true;
+            if (formatStateData(provider, topics, pins, count, i, msg, value)) {
+                filter.update(i, value);
+            } else {
+                filter.changed(i);
+            }
+        }
+        if (!filter.isDue(i, now)) {
+            continue;
+        }
+        // a pin still pending from an earlier pass is formatted with its current value
+        if (!formatted) {
+            formatStateData(provider, topics, pins, count, i, msg, value);
+        }
+        if (!batch.add(msg)) {
+            sendStateBatch(client, batch);
+            batch.clear();
+            batch.add(msg);
+            resetWatchDog();
+        }
+        filter.published(i, value, now);
+        sent++;
+    }
+    sendStateBatch(client, batch);
+    return sent;
+}
+
+// limits with pin 0 apply to the pins without their own entry
+template<typename Filter>
+void setPublishLimits(Filter & filter, const Pin * pins, uint8_t count, const PublishLimits * limits, uint8_t limitCount)
+{
+    for (uint8_t i = 0; i < count; i++) {
+        for (uint8_t j = 0; j < limitCount; j++) {
+            if (limits[j].pin == pins[i].id || limits[j].pin == 0) {
+                filter.setLimits(i, limits[j].deadband, limits[j].minInterval);
+            }
+            if (limits[j].pin == pins[i].id) {
+                break;
+            }
+        }
+    }
+}
+
+// MeshMqttClient registers the handlers, compact subscribe lets the gateway send compact frames with aliases
+template<typename Topics>
+unsigned long subscribeToChannels(
+    MeshMqttClient & client,
+    MeshClient & meshClient,
+    SubscribeHandler & subscribeHandler,
+    PinStateJsonHandler & jsonHandler,
+    ValueProviderFactory & provider,
+    const Topics & topics,
+    const Pin * pins,
+    uint8_t count,
+    PoolUsage & subscriptions
+)
 {
     unsigned long nextSubscribeIn = 5000;
     char topic[MQTT_MAX_LEN_TOPIC] {0};
-    snprintf_P(topic, COUNT_OF(topic), CHANNEL_SUBSCRIBE);
-    if (client.subscribe(topic, &subscribeHandler)) {
+    copyTopic(topics, provider, pins, count, count, topic, COUNT_OF(topic));
+    if (client.subscribe(topic, &subscribeHandler) && meshClient.subscribe(topic)) {
         info("Subscribed for channel: %s", topic);
         char topic[MQTT_MAX_LEN_TOPIC] {0};
-        snprintf_P(topic, COUNT_OF(topic), CHANNEL_SET_JSON);
-        if (client.subscribe(topic, &jsonHandler)) {
+        copyTopic(topics, provider, pins, count, count + 1, topic, COUNT_OF(topic));
+        if (client.subscribe(topic, &jsonHandler) && meshClient.subscribe(topic)) {
             info("Subscribed for channel: %s", topic);
             nextSubscribeIn = (24ul * 3600 * 1000);
         } else {
+            subscriptions.rejected();
             error("Failed to subscribe: %s", topic);
         }
     } else {
+        subscriptions.rejected();
         error("Failed to subscribe: %s");
     }
     return nextSubscribeIn;
 }
+
+#ifdef SLEEP_PERIOD
+#ifndef HOST_BUILD
+ISR(WDT_vect)
+{
+}
+
+// millis counter of the arduino core, timer0 stops in power down
+extern volatile unsigned long timer0_millis;
+
+// power down in watchdog steps from 8s to 16ms, the watchdog is set back to reset mode after
+void powerDown(uint32_t ms)
+{
+    const uint16_t STEPS[] {8000, 4000, 2000, 1000, 500, 250, 125, 64, 32, 16};
+    const uint8_t TIMEOUTS[] {WDTO_8S, WDTO_4S, WDTO_2S, WDTO_1S, WDTO_500MS, WDTO_250MS, WDTO_120MS, WDTO_60MS, WDTO_30MS, WDTO_15MS};
+    uint8_t i {0};
+    while (i < COUNT_OF(STEPS)) {
+        if (ms < STEPS[i]) {
+            i++;
+            continue;
+        }
+        cli();
+        wdt_reset();
+        MCUSR &= ~_BV(WDRF);
+        WDTCSR = _BV(WDCE) | _BV(WDE);
+        // interrupt only, no reset
+        WDTCSR = _BV(WDIE) | (TIMEOUTS[i] & 0x07) | (TIMEOUTS[i] & 0x08 ? _BV(WDP3) : 0);
+        sei();
+        set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+        sleep_enable();
+        sleep_cpu();
+        sleep_disable();
+        ms -= STEPS[i];
+        noInterrupts();
+        timer0_millis += STEPS[i];
+        interrupts();
+    }
+    wdt_enable(WDTO_8S);
+}
+#else
+// host build, with the virtual clock the time moves forward at once
+void powerDown(uint32_t ms)
+{
+    delay(ms);
+}
+#endif
+
+void sleepFor(RF24 & radio, uint32_t ms)
+{
+    radio.powerDown();
+    powerDown(ms);
+    radio.powerUp();
+}
+#endif
@@ -16,6 +16,9 @@
 //#include <OneWire.h>
 //
 #include <MemoryFree.h>
+#if defined(SLEEP_PERIOD) && !defined(HOST_BUILD)
+#include <avr/sleep.h>
+#endif
 #include <ArduinoJson.h>
 
 #include "CommonModule/MacroHelper.h"
@@ -35,6 +38,13 @@
 #include "MqttModule/ValueProviders/AnalogProvider.h"
 #include "MqttModule/ValueProviders/DigitalProvider.h"
 #include "MqttModule/ValueProviders/ValueProviderFactory.h"
+#include "NodeModule/NodeClient.h"
+#include "NodeModule/MessageCodec.h"
+#include "NodeModule/PublishFilter.h"
+#include "NodeModule/SleepCycle.h"
+#include "NodeModule/TopicCache.h"
+#include "NodeModule/PinJson.h"
+#include "NodeModule/MemoryStats.h"
 
 using RadioEncrypted::Encryption;
 using RadioEncrypted::EncryptedNetwork;
@@ -57,11 +67,42 @@ using MqttModule::ValueProviders::DigitalProvider;
 using MqttModule::ValueProviders::AnalogProvider;
 using RadioEncrypted::connectToNetwork;
 using RadioEncrypted::resetWatchDog;
+using NodeModule::NodeClient;
+using NodeModule::MessageBatch;
+using NodeModule::PublishFilter;
+using NodeModule::PublishLimits;
+using NodeModule::SleepCycle;
+using NodeModule::TopicCache;
+using NodeModule::PinCommands;
+using NodeModule::PoolUsage;
+using NodeModule::paintStack;
+using NodeModule::stackHighWater;
+using NodeModule::stackMargin;
 
 #ifdef CUSTOM_PROVIDERS
 #include "CustomValueProviders/ValueProvidersInclude.h"
 #endif
 
+// {pin id, deadband, min publish interval ms}, pin 0 sets the default for all pins
+#ifndef PIN_PUBLISH_LIMITS
+#define PIN_PUBLISH_LIMITS {0, 0, 0}
+#endif
+
+// memory and pool stats go with every KEEP_ALIVE_STATS th keep alive, 0 leaves them out of the build
+#ifndef KEEP_ALIVE_STATS
+#define KEEP_ALIVE_STATS 10
+#endif
+
+// battery mode: the node sleeps SLEEP_PERIOD ms and listens for WAKE_WINDOW ms after each wake
+#if defined(SLEEP_PERIOD) && !defined(WAKE_WINDOW)
+#define WAKE_WINDOW 100
+#endif
+
+const uint8_t MAX_OUT_ALIASES {4};
+const uint8_t MAX_IN_ALIASES {NodeModule::MAX_NODE_ALIASES}; // gateway defines no more per node
+
+using MeshClient = NodeClient<EncryptedNetwork, MAX_OUT_ALIASES, MAX_IN_ALIASES>;
+
 #include "helpers.h"
 
 const uint16_t DISPLAY_TIME {30000};
@@ -73,10 +114,14 @@ const uint16_t NODE_ID {NRF_NODE_ID};
 const uint8_t MAX_SUBSCRIBERS {2};
 const uint8_t MAX_NODES_PER_SUBSCRIBER {2};
 const uint8_t MAX_HANDLERS_PER_SUBSCRIBER {2};
+// topic bytes after the shared prefix, pin topics and the two subscribe topics are cached
+const uint8_t MAX_TOPIC_SUFFIX {12};
 
 int main()
 {
   init();
+  // before anything else runs deep, the stack high water is read from the pattern later
+  paintStack();
   Serial.begin(BAUD_RATE);
 
   info("freeMemory %d", freeMemory());
@@ -96,10 +141,17 @@ int main()
 
   StaticSubscriberList<MAX_SUBSCRIBERS, MAX_NODES_PER_SUBSCRIBER, MAX_HANDLERS_PER_SUBSCRIBER> subscribers;
   MeshMqttClient client(encMesh, subscribers);
+  MeshClient meshClient(encMesh);
+  // the gateway would drop publishes numbered like the ones before a restart
+  meshClient.setSequence(entropy.randomWord());
 
   Pin pins [] {AVAILABLE_PINS};
   StaticPinCollection<COUNT_OF(pins)> pinCollection(pins);
 
+  PublishLimits publishLimits[] {PIN_PUBLISH_LIMITS};
+  PublishFilter<COUNT_OF(pins)> publishFilter;
+  setPublishLimits(publishFilter, pins, COUNT_OF(pins), publishLimits, COUNT_OF(publishLimits));
+
   AnalogProvider analogProvider;
   DigitalProvider digitalProvider;
 
@@ -114,8 +166,26 @@ int main()
 #include "CustomValueProviders/ValueProvidersFactory.h"
 #endif
 
+  TopicCache<COUNT_OF(pins) + 2, MQTT_MAX_LEN_TOPIC + (COUNT_OF(pins) + 2) * MAX_TOPIC_SUFFIX> topics;
+  if (!buildTopics(topics, valueProviderFactory, pins, COUNT_OF(pins))) {
+      warning("Topics do not fit the cache, they are formatted on publish");
+  }
+
+  // set/json commands are parsed without a json document when they have the plain {"pin", "set"} form
+  PinCommands<SubscriberList, ValueProviderFactory, Pin> commands(subscribers, valueProviderFactory, pins, COUNT_OF(pins));
+  char setTopic[MQTT_MAX_LEN_TOPIC] {0};
+  copyTopic(topics, valueProviderFactory, pins, COUNT_OF(pins), COUNT_OF(pins) + 1, setTopic, COUNT_OF(setTopic));
+  commands.setTopic(setTopic);
+
+#ifdef SLEEP_PERIOD
+  SleepCycle sleepCycle(SLEEP_PERIOD, WAKE_WINDOW);
+#endif
+
+  PoolUsage subscriptions;
+
   bool connectedToNrfNetwork = false;
   unsigned long lastRefreshTime = 0;
+  uint16_t keepAlives = 0;
   unsigned long lastSubscribeTime = 0;
 
   if (!connectToNetwork(network, radio, NODE_ID, RADIO_CHANNEL)) {
@@ -128,17 +198,10 @@ int main()
   while (true) {
 
     mesh.update();
-    client.loop();
+    meshClient.loop(commands);
 
-    for (auto & pin: pins) {
-        if (!(pin.id > 0)) {
-            continue;
-        }
-        if (pin.changed) {
-            pin.changed = false;
-            sendStateData(client, valueProviderFactory, pin);
-            resetWatchDog();
-        } 
+    if (sendStateData(meshClient, valueProviderFactory, topics, pins, COUNT_OF(pins), publishFilter) > 0) {
+        resetWatchDog();
     }
 
 	if (millis() - lastRefreshTime >= DISPLAY_TIME) {
@@ -151,16 +214,29 @@ int main()
             connectedToNrfNetwork = true;
         }
 
-        sendLiveData(client);
+        // what the subscriber list holds, a resubscribe that did not add anything shows here
+        subscriptions.sample(countSubscribed(subscribers, topics, valueProviderFactory, pins, COUNT_OF(pins)));
+        sendLiveData(meshClient, subscriptions, COUNT_OF(pins), topics.size(), keepAlives++);
 
         info("Ping");
 		lastRefreshTime = millis();
 	}
 
     if (millis() > lastSubscribeTime)  {
-        lastSubscribeTime = millis() + subscribeToChannels(client, subscribeHandler, jsonHandler);
+        lastSubscribeTime = millis() + subscribeToChannels(
+            client, meshClient, subscribeHandler, jsonHandler, valueProviderFactory, topics, pins, COUNT_OF(pins), subscriptions
+        );
     }
 
+#ifdef SLEEP_PERIOD
+    // the gateway keeps messages for this node until the poll after the next wake
+    if (sleepCycle.isWindowOver(millis())) {
+        sleepFor(radio, sleepCycle.sleepTime(millis()));
+        sleepCycle.woke(millis());
+        meshClient.poll(sleepCycle.getWindow());
+    }
+#endif
+
     resetWatchDog();
 
   }
@@ -1,36 +1,113 @@
+// broker forgets subscriptions with the connection, subscribe again for every node filter
+void subscribeNodeTopics(PubSubClient &)
+{
+    gateway.subscribeAll();
+}
 
-bool addToQueue(MessageQueueItem * messageQueue, size_t len, const MqttMessage & message, uint16_t node)
+// drains radio frames until the budget is used, returns true if frames are left
+// radios take turns frame by frame so a busy channel does not hold up the other
+bool radioTask(const TaskBudget & budget)
 {
-    for (size_t i = 0; i < len; i++) {
-        MessageQueueItem & item = messageQueue[i];
-        if (!item.initialized) {
-            item.message = message;
-            item.node = node;
-            item.initialized = true;
-            return true;
+    bool isAvailable {false};
+    for (auto & meshRadio: meshRadios) {
+        meshRadio.mesh.update();
+    }
+    do {
+        isAvailable = false;
+        for (uint8_t i = 0; i < COUNT_OF(meshRadios); i++) {
+            if (!meshRadios[i].encMesh.isAvailable()) {
+                continue;
+            }
+            gateway.receive(i);
+            resetWatchDog();
+            isAvailable = isAvailable || meshRadios[i].encMesh.isAvailable();
         }
+    } while (isAvailable && !budget.expired());
+    return isAvailable;
+}
+
+bool dhcpTask(const TaskBudget &)
+{
+    for (auto & meshRadio: meshRadios) {
+        meshRadio.mesh.DHCP();
     }
     return false;
 }
 
-uint8_t sendMessages(MessageQueueItem * messageQueue, size_t len)
+// PubSubClient handles one packet per loop call, keep calling while data is waiting
+bool mqttTask(const TaskBudget & budget)
 {
-    uint8_t count = 0;
-    for (size_t i = 0; i < len; i++) {
-        MessageQueueItem & item = messageQueue[i];
-        if (item.initialized == true && item.failedToSend > MAX_MESSAGE_FAILURES) {
-            item = {};
-        }
-        if (!item.initialized) {
-            continue;
-        }
-        if (!encMesh.send(&item.message, sizeof(item.message), (uint8_t)MessageType::Publish, item.node)) {
-            warning("Failed to send data to node: %d %d", item.node, item.failedToSend);
-            item.failedToSend++;
-        } else {
-            count++;
-            item = {};
+    if (!connection.tick(millis())) {
+        return false;
+    }
+    do {
+        client.loop();
+    } while (net.available() > 0 && !budget.expired());
+    return net.available() > 0;
+}
+
+bool queueTask(const TaskBudget &)
+{
+    uint8_t messagesSent = gateway.sendMessages(MAX_SENDS_PER_RUN);
+    if (messagesSent > 0) {
+        info("Messages sent %d", messagesSent);
+    }
+    return false;
+}
+
+bool healthTask(const TaskBudget &)
+{
+    if (connection.isConnected()) {
+        publishFailed += sendLiveData(client) ? 0 : 1;
+    }
+
+    debug("Ping");
+
+    for (uint8_t i = 0; i < scheduler.size(); i++) {
+        const TaskStats & stats = scheduler.getStats(i);
+        debug("Task %s runs %lu avg %lu us max %lu us overruns %lu", stats.name, stats.runs, stats.averageTime(), stats.maxTime, stats.overruns);
+    }
+
+    bool radioFailed {false};
+    for (uint8_t i = 0; i < COUNT_OF(meshRadios); i++) {
+        debug("Radio %d nodes %d", i, gateway.getRadioRoutes().count(i));
+        radioFailed = radioFailed || meshRadios[i].radio.failureDetected;
+    }
+
+    if (connection.getFailures() > MAX_CONNECT_FAILURES || publishFailed > 10 || radioFailed) {
+        ESP.restart();
+    }
+    return false;
+}
+
+bool metricsTask(const TaskBudget &)
+{
+    auto & metrics = gateway.sampleMetrics();
+    metrics.connectFailures = connection.getFailures();
+    metrics.keepAliveFailed = publishFailed;
+    metrics.maxLoopTime = scheduler.getMaxLoopTime();
+    metrics.averageLoopTime = scheduler.getAverageLoopTime();
+    metrics.freeHeap = ESP.getFreeHeap();
+    metrics.freeStack = ESP.getFreeContStack();
+
+    if (!connection.isConnected()) {
+        return false;
+    }
+    char buffer[MAX_LEN_METRICS] {0};
+    metrics.format(buffer, sizeof(buffer), millis());
+    if (!client.publish(metricsTopic, buffer, true)) {
+        error("Failed to publish metrics");
+    }
+    return false;
+}
+
+// replays spilled messages oldest first, stops at the first failure to keep the order
+bool replayTask(const TaskBudget & budget)
+{
+    for (uint8_t i = 0; i < MAX_REPLAYS_PER_RUN && !budget.expired(); i++) {
+        if (!gateway.replayNext()) {
+            break;
         }
     }
-    return count;
+    return false;
 }
@@ -1,6 +1,5 @@
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
-#include <ESP8266WiFiMulti.h>
 #include <RF24.h>
 #include <RF24Network.h>
 #include <RF24Mesh.h>
@@ -12,54 +11,85 @@
 #include <SPI.h>
 #include <PubSubClient.h>
 #include <ESP8266TrueRandom.h>
+#include <LittleFS.h>
+#include <CRC32.h>
 
 // satisfy arduino-builder
 #include "ArduinoBuilderRadioEncrypted.h"
 //#include "ArduinoBuilderMessageHandlers.h"
 #include "ArduinoBuilderMqttModule.h"
 #include "ArduinoBuilderEntropy.h"
+#include "ArduinoBuilderNodeModule.h"
 // end
 //
 #include "CommonModule/MacroHelper.h"
 #include "MqttModule/MqttMessage.h"
-#include "MqttModule/SubscriberList.h"
 #include "RadioEncrypted/Encryption.h"
 #include "RadioEncrypted/EncryptedMesh.h"
 #include "RadioEncrypted/Helpers.h"
 #include "RadioEncrypted/Entropy/EspRandomAdapter.h"
+#include "NodeModule/ConnectionManager.h"
+#include "NodeModule/TaskScheduler.h"
+#include "NodeModule/SpillLog.h"
+#include "NodeModule/MqttCallbacks.h"
+#include "NodeModule/PublishCache.h"
+#include "NodeModule/MeshGateway.h"
 
 using MqttModule::MqttMessage;
-using MqttModule::MessageQueueItem;
 using MqttModule::MessageType;
-using MqttModule::SubscriberList;
-using MqttModule::StaticSubscriberList;
 using RadioEncrypted::Encryption;
 using RadioEncrypted::EncryptedMesh;
 using RadioEncrypted::Entropy::EspRandomAdapter;
 using RadioEncrypted::connectToMesh;
-using RadioEncrypted::connectToMqtt;
 using RadioEncrypted::sendLiveData;
-using RadioEncrypted::connectToWifi;
 using RadioEncrypted::resetWatchDog;
+using NodeModule::ConnectionManager;
+using NodeModule::TaskScheduler;
+using NodeModule::attachCallback;
+using NodeModule::TaskBudget;
+using NodeModule::TaskStats;
+using NodeModule::SpillLog;
+using NodeModule::PublishPolicy;
+using NodeModule::MeshGateway;
 
 const uint8_t MAX_SEND_RETRIES {3};
-const uint8_t MAX_MESSAGE_QUEUE {10};
-const uint8_t MAX_MESSAGE_FAILURES {60};
-const uint8_t WIFI_RETRY = 10;
-const uint8_t MQTT_RETRY = 6;
-
-unsigned long lastRefreshTime {0};
-unsigned long lastSentMessageTime {0};
+const char * ACK_TOPIC_SUFFIX {"/set/json"}; // commands the node has to acknowledge, empty disables acks
+const uint16_t CONNECT_TIMEOUT {2000};
+const uint8_t MAX_CONNECT_FAILURES {10};
+const uint8_t MAX_TASKS {7};
+const uint8_t MAX_SENDS_PER_RUN {4};
+const uint16_t HEALTH_PERIOD {30000};
+const uint16_t METRICS_PERIOD {60000};
+const uint8_t MAX_LEN_METRICS {240};
+const uint16_t SPILL_CAPACITY {64}; // messages kept in flash while mqtt is down
+const uint16_t REPLAY_PERIOD {250};
+const uint8_t MAX_REPLAYS_PER_RUN {4}; // with REPLAY_PERIOD limits replay to 16 messages/s
+// task budgets in us, worst case loop time is their sum
+const uint16_t RADIO_BUDGET {30000};
+const uint16_t DHCP_BUDGET {5000};
+const uint16_t MQTT_BUDGET {30000};
+const uint16_t QUEUE_BUDGET {20000};
+const uint16_t HEALTH_BUDGET {50000};
+const uint16_t METRICS_BUDGET {20000};
+const uint16_t REPLAY_BUDGET {20000};
 
 uint8_t publishFailed {0};
-uint8_t reconnectMqttFailed {0};
+
+// node messages by topic class {mqtt filter, retain, heartbeat ms}, the first matching filter applies
+// an unchanged value is published again after heartbeat ms, 0 publishes every message
+// e.g. -DPUBLISH_POLICIES='{"+/nodes/+/keep-alive", false, 0}, {"#", true, 300000}'
+#ifndef PUBLISH_POLICIES
+#define PUBLISH_POLICIES {"#", true, 300000}
+#endif
 
 // requires WLAN_SSID_1, WLAN_PASSWORD_1, MQTT_SERVER_ADDRESS, SHARED_KEY, MAX_SUBSCRIBERS, MAX_NODES_PER_TOPIC
+// optional SECOND_RADIO_CHANNEL runs a second mesh on another radio sharing the spi bus,
+// SECOND_RADIO_CE_PIN and SECOND_RADIO_CSN_PIN default to D1 and D2
 // int main does not work
 
-ESP8266WiFiMulti wifi;
 WiFiClient net;
 PubSubClient client(net);
+ConnectionManager<ESP8266WiFiClass, PubSubClient> connection(WiFi, client, MQTT_CLIENT_NAME);
 
 RF24 radio(D4, D8);
 RF24Network network(radio);
@@ -71,9 +101,83 @@ EspRandomAdapter entropyAdapter(entropy);
 Encryption encryption (cipher, ENCRYPTION_KEY, entropyAdapter);
 EncryptedMesh encMesh (mesh, network, encryption);
 
-StaticSubscriberList<MAX_SUBSCRIBERS, 2, MAX_NODES_PER_TOPIC> subscribers;
+#ifdef SECOND_RADIO_CHANNEL
+#ifndef SECOND_RADIO_CE_PIN
+#define SECOND_RADIO_CE_PIN D1
+#endif
+#ifndef SECOND_RADIO_CSN_PIN
+#define SECOND_RADIO_CSN_PIN D2
+#endif
+RF24 secondRadio(SECOND_RADIO_CE_PIN, SECOND_RADIO_CSN_PIN);
+RF24Network secondNetwork(secondRadio);
+RF24Mesh secondMesh(secondRadio, secondNetwork);
+EncryptedMesh secondEncMesh (secondMesh, secondNetwork, encryption);
+#endif
+
+struct MeshRadio
+{
+    RF24 & radio;
+    RF24Mesh & mesh;
+    EncryptedMesh & encMesh;
+};
+
+// each radio runs its own mesh on its own channel, nodes join the one on their RADIO_CHANNEL
+// subscriptions, queues and aliases are shared, node ids have to be unique across the meshes
+MeshRadio meshRadios[] {
+    {radio, mesh, encMesh},
+#ifdef SECOND_RADIO_CHANNEL
+    {secondRadio, secondMesh, secondEncMesh},
+#endif
+};
+
+// sizes of the gateway tables, see NodeModule/MeshGateway.h
+struct GatewayLimits
+{
+    static const uint16_t MAX_FILTERS {MAX_SUBSCRIBERS};
+    static const uint8_t MAX_NODES_PER_FILTER {MAX_NODES_PER_TOPIC};
+    static const uint8_t MAX_DESTINATIONS {8}; // nodes with queued messages
+    static const uint8_t MAX_PER_DESTINATION {4};
+    static const uint8_t PAYLOAD_SLOTS {8}; // distinct messages waiting to be sent
+    static const uint8_t MAX_MESSAGE_FAILURES {10};
+    static const uint16_t RETRY_INITIAL_DELAY {200};
+    static const uint16_t RETRY_MAX_DELAY {20000};
+    static const uint8_t MAX_MATCHED_NODES {16};
+    static const uint16_t MAX_NODE_ID {255};
+    static const uint8_t MAX_INBOUND_ALIASES {64};
+    static const uint8_t MAX_OUTBOUND_ALIASES {32};
+    static const uint8_t MAX_SEQUENCE_PEERS {32}; // nodes tracked for duplicates
+    static const uint8_t MAX_SLEEPING_NODES {16};
+    static const uint8_t MAX_PUBLISHED_TOPICS {64}; // last values kept to skip unchanged ones
+    static const uint8_t MAX_FAILING_NODES {4};
+    static const uint8_t RADIOS {COUNT_OF(meshRadios)};
+};
+
+// radios, mqtt and time for the gateway
+struct GatewayHost
+{
+    EncryptedMesh & radio(uint8_t index) { return meshRadios[index].encMesh; }
+    uint16_t nodeId(uint8_t index, uint16_t address) { return meshRadios[index].mesh.getNodeID(address); }
+    bool isConnected() { return connection.isConnected(); }
+    bool publish(const char * topic, const char * message, bool retain) { return client.publish(topic, message, retain); }
+    bool subscribe(const char * filter) { return client.subscribe(filter); }
+    unsigned long now() { return millis(); }
+};
+GatewayHost gatewayHost;
+
+// gateway loop tasks with time budgets, see setup
+TaskScheduler<MAX_TASKS> scheduler;
+
+char metricsTopic[MQTT_MAX_LEN_TOPIC] {0};
 
-MessageQueueItem messageQueue[MAX_MESSAGE_QUEUE];
+PublishPolicy publishPolicies[] {PUBLISH_POLICIES};
+
+// publishes that failed wait here and are replayed in order once mqtt is back
+File spillFile;
+SpillLog<File, SPILL_CAPACITY> spill(spillFile);
+
+// subscriptions, queues and aliases are shared by the radios
+// metrics are published retained to {MQTT_CLIENT_NAME}/stats
+MeshGateway<GatewayHost, EncryptedMesh, SpillLog<File, SPILL_CAPACITY>, GatewayLimits> gateway(gatewayHost, spill, publishPolicies, COUNT_OF(publishPolicies), ACK_TOPIC_SUFFIX);
 
 #include "helpers.h"
 
@@ -86,18 +190,17 @@ void setup()
 
     // We start by connecting to a WiFi network
     WiFi.mode(WIFI_STA);
-    wifi.addAP(WLAN_SSID_1, WLAN_PASSWORD_1);
+    connection.addAccessPoint(WLAN_SSID_1, WLAN_PASSWORD_1);
     #ifdef WLAN_SSID_2
-    wifi.addAP(WLAN_SSID_2, WLAN_PASSWORD_2);
+    connection.addAccessPoint(WLAN_SSID_2, WLAN_PASSWORD_2);
     #endif
 
-    if (!connectToWifi(wifi, WIFI_RETRY)) {
-        error("Unable to connect to wifi. Sleeping..");
-        ESP.deepSleep(120e6);
+    // wifi and mqtt are connected from loop so the radio is serviced while they are down
+    for (auto & meshRadio: meshRadios) {
+        meshRadio.mesh.setNodeID(0);
     }
-    delay(500);
-
-    mesh.setNodeID(0);
+    // nodes would take the numbers of the previous run for repeated frames
+    gateway.setSequence(entropy.random(0x10000));
 
     resetWatchDog();
 
@@ -108,89 +211,49 @@ void setup()
 
     radio.setPALevel(RF24_PA_HIGH);
 
-    resetWatchDog();
-
-    client.setServer(MQTT_SERVER_ADDRESS, 1883);
+#ifdef SECOND_RADIO_CHANNEL
+    // the first mesh keeps the channel of connectToMesh
+    if (!secondMesh.begin(SECOND_RADIO_CHANNEL)) {
+        error("Unable to start mesh on channel %d", SECOND_RADIO_CHANNEL);
+    }
+    secondRadio.setPALevel(RF24_PA_HIGH);
+#endif
 
-    reconnectMqttFailed = connectToMqtt(client, MQTT_CLIENT_NAME, nullptr) ? 0 : 1;
-
-    client.setCallback([&mesh, &subscribers, &encMesh, &messageQueue](const char * topic, uint8_t * payload, uint16_t len) {
-    
-        debug("Mqtt message received for: %s", topic);
-        auto subscriber = subscribers.getSubscribed(topic);
-        if (!subscriber) {
-            warning("No nodes subscribed for %s", topic);
-            return;
-        }
-        for (uint8_t i = 0; i < subscriber->getNodeArrLength(); i++) {
-            auto node = subscriber->getNodeByIndex(i);
-            if (!(node > 0)) {
-                continue;
-            }
-            MqttMessage message(topic);
-            memcpy(message.message, payload, MIN(len, COUNT_OF(message.message)));
-            if (!addToQueue(messageQueue, COUNT_OF(messageQueue), message, node)) {
-                error("Failed to add to queue");
-            }
-        }
-    });
-}
+    resetWatchDog();
 
-void loop()
-{
-    mesh.update();
-    mesh.DHCP();
-    client.loop();
-
-    while (encMesh.isAvailable()) {
-
-        MqttMessage message;
-        RF24NetworkHeader header;
-
-        if (encMesh.receive(&message, sizeof(message), (uint8_t)MessageType::All, header)) {
-
-            if (header.type == (uint8_t)MessageType::Subscribe && !subscribers.hasSubscribed(message.topic)) {
-                uint16_t fromNode = mesh.getNodeID(header.from_node);
-                subscribers.add(message.topic, nullptr, fromNode);
-                //subscribe locally
-                client.subscribe(message.topic);
-                info("Subscribed for: %s nodeI: %d", message.topic, fromNode);
-
-            } else if (header.type == (uint8_t)MessageType::Publish) {
-                // push to the server
-                if (!client.publish(message.topic, message.message, true)) {
-                    error("Failed to send message");
-                }
-                debug("Publish topic: %s Message: %s", message.topic, message.message);
-            }
-
-        } else {
-            error("Failed to receive packets");
-        }
-        resetWatchDog();
+    if (!LittleFS.begin()) {
+        error("Failed to mount filesystem");
     }
-
-    if (millis() - lastSentMessageTime >= 1500) {
-        uint8_t messagesSent = sendMessages(messageQueue, COUNT_OF(messageQueue));
-        if (messagesSent > 0) {
-            info("Messages sent %d", messagesSent);
-        }
-        lastSentMessageTime = millis();
+    spillFile = LittleFS.open("/spill.log", LittleFS.exists("/spill.log") ? "r+" : "w+");
+    if (!spill.begin()) {
+        error("Failed to open spill log");
+    } else if (spill.size() > 0) {
+        info("Spilled messages %d", spill.size());
     }
 
-	if (millis() - lastRefreshTime >= 30000) {
+    snprintf(metricsTopic, COUNT_OF(metricsTopic), "%s/stats", MQTT_CLIENT_NAME);
 
-        publishFailed += sendLiveData(client) ? 0 : 1;
-
-        debug("Ping");
+    net.setTimeout(CONNECT_TIMEOUT);
+    client.setServer(MQTT_SERVER_ADDRESS, 1883);
+    connection.setConnectCallback(subscribeNodeTopics);
 
-        reconnectMqttFailed = connectToMqtt(client, MQTT_CLIENT_NAME, nullptr);
+    // no captures, everything used here is global
+    attachCallback(client, [](void *, const char * topic, uint8_t * payload, uint16_t len) {
+        gateway.onMqttMessage(topic, payload, len);
+    });
 
-        lastRefreshTime = millis();
+    // radio first so the mesh is serviced on every pass, the rest share what is left
+    scheduler.add("radio", radioTask, 0, RADIO_BUDGET);
+    scheduler.add("dhcp", dhcpTask, 0, DHCP_BUDGET);
+    scheduler.add("mqtt", mqttTask, 0, MQTT_BUDGET);
+    scheduler.add("queue", queueTask, 0, QUEUE_BUDGET);
+    scheduler.add("health", healthTask, HEALTH_PERIOD, HEALTH_BUDGET);
+    scheduler.add("metrics", metricsTask, METRICS_PERIOD, METRICS_BUDGET);
+    scheduler.add("replay", replayTask, REPLAY_PERIOD, REPLAY_BUDGET);
+}
 
-        if (reconnectMqttFailed > 10 || publishFailed > 10 || radio.failureDetected) {
-            ESP.restart();
-        }
-	}
+void loop()
+{
+    scheduler.run();
     resetWatchDog();
 }
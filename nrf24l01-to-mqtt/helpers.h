@@ -1,22 +1,108 @@
-bool sendMqttMessage(PubSubClient & client, const MqttMessage & data)
+// while older messages are spilled new ones are appended behind them to keep the order
+// returns true when the message was published or spilled, spilled messages are replayed later
+bool sendMqttMessage(PubSubClient & client, Spill & spill, const MqttMessage & data)
 {
-    if (client.publish(data.topic, data.message)) {
+    if (spill.size() == 0 && client.connected()) {
+        if (client.publish(data.topic, data.message)) {
+            debug("Sent %s %s", data.topic, data.message);
+            return true;
+        }
         error("Failed to publish message. Topic: %s Message: %s", data.topic, data.message);
+    } else {
+        info("Spilled behind %d. Topic: %s", spill.size(), data.topic);
+    }
+    if (!spill.append(data)) {
+        error("Failed to spill message");
         return false;
-    } 
-    debug("Sent %s %s", data.topic, data.message);
+    }
     return true;
 }
 
-bool forwardToMqtt(EncryptedNetwork & network, PubSubClient & mqttClient)
+// publishes up to count spilled messages oldest first, stops at the first failure
+uint8_t replaySpilled(PubSubClient & client, Spill & spill, uint8_t count)
+{
+    uint8_t sent {0};
+    MqttMessage message;
+    while (sent < count && spill.peek(message)) {
+        if (!client.publish(message.topic, message.message)) {
+            warning("Failed to replay message. Topic: %s", message.topic);
+            break;
+        }
+        spill.pop();
+        sent++;
+    }
+    return sent;
+}
+
+// aliased publishes are expanded like in the gateway, an unknown alias makes the node define its topics again
+bool forwardToMqtt(EncryptedNetwork & network, CompactNodes & compactNodes, InboundAliases & aliases, ReceivedSequences & sequences, PubSubClient & mqttClient, Spill & spill)
 {
     MqttMessage message;
     RF24NetworkHeader header;
-    if (!network.receive(&message, sizeof(message), 0, header)) {
+    uint8_t alias {0};
+    FrameSequence sequence;
+    FrameType frameType = receiveFrame(network, message, alias, sequence, (uint8_t)MessageType::All, header);
+    if (frameType == FrameType::Invalid) {
         error("Failed to read message");
         return false;
     }
-    return sendMqttMessage(mqttClient, message);
+    if (isCompactType(header.type)) {
+        compactNodes.add(header.from_node);
+    }
+    if (frameType == FrameType::Restart) {
+        aliases.clear(header.from_node);
+        sequences.reset(header.from_node);
+        return true;
+    }
+    // messages to nodes are sent without aliases, acks and polls are not used by the bridge
+    if (frameType == FrameType::AliasReset || frameType == FrameType::Ack || frameType == FrameType::Poll) {
+        return true;
+    }
+    if (frameType != FrameType::Batch && !aliases.resolve(frameType, header.from_node, alias, message)) {
+        warning("Unknown alias %d from node: %d", alias, header.from_node);
+        sendAliasReset(network, (uint8_t)MessageType::Publish, header.from_node);
+        return false;
+    }
+    if (sequence.present && !sequences.accept(header.from_node, sequence.number)) {
+        debug("Duplicate %u from node: %d", sequence.number, header.from_node);
+        return true;
+    }
+    if (frameType == FrameType::Batch) {
+        // several pin states in one frame, each one has its own topic
+        BatchReader reader(message);
+        MqttMessage entry;
+        bool sent {true};
+        while (reader.next(entry)) {
+            sent = sendMqttMessage(mqttClient, spill, entry) && sent;
+        }
+        return sent;
+    }
+    return sendMqttMessage(mqttClient, spill, message);
+}
+
+// forwards frames until none are pending or the budget in ms is used
+// network.update moves frames from the radio fifo so it is called between frames
+uint8_t forwardPending(RF24Network & network, EncryptedNetwork & encNetwork, CompactNodes & compactNodes, InboundAliases & aliases, ReceivedSequences & sequences, PubSubClient & mqttClient, Spill & spill, uint16_t budget)
+{
+    uint8_t count {0};
+    unsigned long start = millis();
+    network.update();
+    while (encNetwork.isAvailable() && millis() - start < budget) {
+        if (!forwardToMqtt(encNetwork, compactNodes, aliases, sequences, mqttClient, spill)) {
+            error("Failed to forward message");
+        }
+        count += count < 0xFF ? 1 : 0;
+        network.update();
+    }
+    return count;
+}
+
+bool sendToNode(EncryptedNetwork & encNetwork, CompactNodes & compactNodes, MqttMessage & message, uint16_t node)
+{
+    if (compactNodes.contains(node)) {
+        return sendCompactMessage(encNetwork, message, 0, node);
+    }
+    return encNetwork.send(&message, sizeof(message), 0, node);
 }
 
 bool addToQueue(MessageQueueItem * messageQueue, size_t len, const MqttMessage & message, uint16_t node)
@@ -33,7 +119,7 @@ bool addToQueue(MessageQueueItem * messageQueue, size_t len, const MqttMessage &
     return false;
 }
 
-uint8_t sendMessages(EncryptedNetwork & encNetwork, MessageQueueItem * messageQueue, size_t len, uint8_t maxFailures = 60)
+uint8_t sendMessages(EncryptedNetwork & encNetwork, CompactNodes & compactNodes, MessageQueueItem * messageQueue, size_t len, uint8_t maxFailures = 60)
 {
     uint8_t count = 0;
     for (size_t i = 0; i < len; i++) {
@@ -44,7 +130,7 @@ uint8_t sendMessages(EncryptedNetwork & encNetwork, MessageQueueItem * messageQu
         if (!item.initialized) {
             continue;
         }
-        if (!encNetwork.send(&item.message, sizeof(item.message), 0, item.node)) {
+        if (!sendToNode(encNetwork, compactNodes, item.message, item.node)) {
             warning("Failed to send data to node: %d %d", item.node, item.failedToSend);
             item.failedToSend++;
         } else {
@@ -54,4 +140,27 @@ uint8_t sendMessages(EncryptedNetwork & encNetwork, MessageQueueItem * messageQu
         }
     }
     return count;
-}
\ No newline at end of file
+}
+// memory and pool usage for sizing the queue, alias and sequence tables and the spill log from the field
+// heap free heap, stk free stack, q queued for nodes, ai/ar aliases used/replaced
+// sq/sqr nodes with a sequence window/replaced, sp/spd spilled messages/dropped
+bool sendStats(PubSubClient & client, const MessageQueueItem * messageQueue, size_t len, const InboundAliases & aliases, const ReceivedSequences & sequences, const Spill & spill)
+{
+    uint32_t queued {0};
+    for (size_t i = 0; i < len; i++) {
+        queued += messageQueue[i].initialized ? 1 : 0;
+    }
+    const char * const keys[] {"heap", "stk", "q", "ai", "ar", "sq", "sqr", "sp", "spd"};
+    const uint32_t values[] {
+        ESP.getFreeHeap(),
+        ESP.getFreeContStack(),
+        queued,
+        aliases.used(),
+        aliases.getReplaced(),
+        sequences.used(),
+        sequences.getReplaced(),
+        spill.size(),
+        spill.getDropped()
+    };
+    return NodeModule::publishStats(client, MQTT_CLIENT_NAME, keys, values, COUNT_OF(values));
+}
@@ -1,6 +1,5 @@
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
-#include <ESP8266WiFiMulti.h>
 #include <RF24.h>
 #include <RF24Network.h>
 #include <SPI.h>
@@ -9,12 +8,14 @@
 #include <Acorn128.h>
 #include <SPI.h>
 #include <PubSubClient.h>
+#include <LittleFS.h>
 
 // satisfy arduino-builder
 #include "ArduinoBuilderRadioEncrypted.h"
 //#include "ArduinoBuilderMessageHandlers.h"
 #include "ArduinoBuilderMqttModule.h"
 #include "ArduinoBuilderEntropy.h"
+#include "ArduinoBuilderNodeModule.h"
 // end
 //
 #include "CommonModule/MacroHelper.h"
@@ -26,17 +27,48 @@
 #include "RadioEncrypted/EncryptedNetwork.h"
 #include "RadioEncrypted/Entropy/AnalogSignalEntropy.h"
 #include "RadioEncrypted/Helpers.h"
+#include "NodeModule/MessageCodec.h"
+#include "NodeModule/PeerSet.h"
+#include "NodeModule/TopicAliases.h"
+#include "NodeModule/ConnectionManager.h"
+#include "NodeModule/IdleBackoff.h"
+#include "NodeModule/SpillLog.h"
+#include "NodeModule/SequenceWindow.h"
+#include "NodeModule/MqttCallbacks.h"
+#include "NodeModule/MemoryStats.h"
 
 using MqttModule::MqttMessage;
 using MqttModule::MessageQueueItem;
+using MqttModule::MessageType;
 using RadioEncrypted::Encryption;
 using RadioEncrypted::EncryptedNetwork;
 using RadioEncrypted::Entropy::AnalogSignalEntropy;
 using RadioEncrypted::connectToNetwork;
-using RadioEncrypted::connectToMqtt;
 using RadioEncrypted::sendLiveData;
-using RadioEncrypted::connectToWifi;
 using RadioEncrypted::resetWatchDog;
+using NodeModule::PeerSet;
+using NodeModule::TopicAliasTable;
+using NodeModule::sendAliasReset;
+using NodeModule::sendCompactMessage;
+using NodeModule::isCompactType;
+using NodeModule::ConnectionManager;
+using NodeModule::IdleBackoff;
+using NodeModule::SpillLog;
+using NodeModule::FrameType;
+using NodeModule::FrameSequence;
+using NodeModule::SequenceWindows;
+using NodeModule::receiveFrame;
+using NodeModule::BatchReader;
+using NodeModule::attachCallback;
+
+// nodes that sent compact frames receive compact frames, up to the highest network address 05555
+using CompactNodes = PeerSet<05555>;
+// topic aliases defined by the nodes, NodeClient publishes with aliases
+using InboundAliases = TopicAliasTable<32>;
+// messages that failed to publish, replayed in order once mqtt is back
+using Spill = SpillLog<File, 64>;
+// last sequence numbers received from each node, repeated frames are not published again
+using ReceivedSequences = SequenceWindows<32>;
 
 #include "helpers.h"
 
@@ -49,6 +81,10 @@ using RadioEncrypted::resetWatchDog;
 #ifndef WATCHDOG_RESET_TIME
 #define WATCHDOG_RESET_TIME 8000
 #endif
+// memory and pool stats go with every KEEP_ALIVE_STATS th keep alive, 0 leaves them out of the build
+#ifndef KEEP_ALIVE_STATS
+#define KEEP_ALIVE_STATS 10
+#endif
 
 const uint16_t BAUD_RATE {USE_BAUD_RATE};
 const uint16_t WATCHDOG_RESET {WATCHDOG_RESET_TIME};
@@ -59,16 +95,23 @@ const char * NODE_NAME {MQTT_CLIENT_NAME}; // mqtt client name
 const uint16_t NODE_ID {NRF_NODE_ID}; // nrf24 network id
 const char SHARED_KEY[ENCRYPTION_KEY_LENGTH + 1] {ENCRYPTION_KEY}; // nrf24 network encryption key 16 chars
 const uint8_t ENTROPY_PIN {USE_ENTROPY_PIN}; // pin used for analog entropy retrieval
-const uint8_t WIFI_RETRY = 6;
+const uint16_t CONNECT_TIMEOUT {2000};
 const uint8_t MAX_QUEUE_FOR_FAILURES = 60;
+const uint16_t RECEIVE_BUDGET {50}; // ms spent forwarding frames per loop
+const uint8_t MAX_IDLE_SLEEP {5}; // ms
+const uint16_t REPLAY_PERIOD {250};
+const uint8_t MAX_REPLAYS_PER_RUN {4};
 
 bool connectedToNrfNetwork {false};
 unsigned long monitorTime {0};
+unsigned long networkCheckTime {0};
 unsigned long lastSentMessageTime {0};
+unsigned long replayTime {0};
+uint16_t keepAlives {0};
 
-ESP8266WiFiMulti wifi;
 WiFiClient net;
 PubSubClient client(net);
+ConnectionManager<ESP8266WiFiClass, PubSubClient> connection(WiFi, client, NODE_NAME, CHANNEL_MQTT_TO_NRF_NETWORK);
 
 RF24 radio(D4, D8);
 RF24Network network(radio);
@@ -78,36 +121,25 @@ AnalogSignalEntropy entropy(ENTROPY_PIN, NODE_ID);
 Encryption encryption (cipher, SHARED_KEY, entropy);
 EncryptedNetwork encNetwork(NODE_ID, network, encryption);
 MessageQueueItem messageQueue[MAX_QUEUE_FOR_FAILURES];
-
-bool connectCallback()
+CompactNodes compactNodes;
+InboundAliases inboundAliases;
+IdleBackoff<MAX_IDLE_SLEEP> idleBackoff;
+File spillFile;
+Spill spill(spillFile);
+ReceivedSequences receivedSequences;
+
+// radio is restarted when it fails, wifi and mqtt are handled by connection.tick
+void checkNetwork()
 {
-    // if we cant connect to wifi no reason to continue
-    if (!connectToWifi(wifi, WIFI_RETRY)) {
-        error("Unable to connect to wifi");
-        return false;
-    }
-    resetWatchDog();
-    delay(500);
-
     if ((!connectedToNrfNetwork || radio.failureDetected) && !connectToNetwork(network, radio, NODE_ID, RADIO_CHANNEL)) {
         error("Unable to connect to nrf24 network");
-        return false;
+        connectedToNrfNetwork = false;
     } else {
         connectedToNrfNetwork = true;
     }
-
     resetWatchDog();
-    delay(500);
-
-    if (!connectToMqtt(client, NODE_NAME, CHANNEL_MQTT_TO_NRF_NETWORK)) {
-        error("Failed to connect to mqtt server on %s", MQTT_SERVER);
-        return false;
-    }
-    resetWatchDog();
-    return true;
 }
 
-
 void setup()
 {
     Serial.begin(BAUD_RATE);
@@ -115,11 +147,20 @@ void setup()
     ESP.wdtEnable(WATCHDOG_RESET_TIME);
 
     WiFi.mode(WIFI_STA);
-    wifi.addAP(WLAN_SSID_1, WLAN_PASSWORD_1);
+    connection.addAccessPoint(WLAN_SSID_1, WLAN_PASSWORD_1);
     #ifdef WLAN_SSID_2
-    wifi.addAP(WLAN_SSID_2, WLAN_PASSWORD_2);
+    connection.addAccessPoint(WLAN_SSID_2, WLAN_PASSWORD_2);
     #endif
 
+    if (!LittleFS.begin()) {
+        error("Failed to mount filesystem");
+    }
+    spillFile = LittleFS.open("/spill.log", LittleFS.exists("/spill.log") ? "r+" : "w+");
+    if (!spill.begin()) {
+        error("Failed to open spill log");
+    }
+
+    net.setTimeout(CONNECT_TIMEOUT);
     client.setServer(MQTT_SERVER, 1883);
 
     #ifdef MQTT_TO_NRF_NETWORK
@@ -128,10 +169,10 @@ void setup()
         // will be forwarded to nodeId as {topic} message
         // e.g. nrfNetwork/132/heating/nodes/bedroom 1 => heating/nodes/bedroom 1
         // e.g. nrfNetwork/431/sensor1 on => sensor1 on
-        client.setCallback([&mesh, &subscribers, &encMesh, &messageQueue](const char * topic, uint8_t * payload, uint16_t len) {
+        attachCallback(client, [](void *, const char * topic, uint8_t * payload, uint16_t len) {
             MqttMessage message(topic + findNextPos(topic, strlen(topic), '/', 2));
             memcpy(message.message, payload, MIN(len, COUNT_OF(message.message)));
-            if (!encNetwork.send(&message, sizeof(message), 0, node)) {
+            if (!sendToNode(encNetwork, compactNodes, message, node)) {
                 error("Failed to send to node %d", node);
                 if (!addToQueue(messageQueue, COUNT_OF(messageQueue), message, node)) {
                     error("Failed to add to queue");
@@ -142,32 +183,49 @@ void setup()
 
         });
     #endif
-    connectCallback();
+    checkNetwork();
 }
 
 void loop()
 {
-    network.update();
+    connection.tick(millis());
     client.loop();
 
-    if (encNetwork.isAvailable()) {
-        if (!forwardToMqtt(encNetwork, client)) {
-            error("Failed to forward message");
-        }
+    uint8_t forwarded = forwardPending(network, encNetwork, compactNodes, inboundAliases, receivedSequences, client, spill, RECEIVE_BUDGET);
+    if (millis() - networkCheckTime >= 5000UL) {
+        checkNetwork();
+        networkCheckTime = millis();
     }
-    if (millis() - monitorTime < 60000UL) {
-        if (connectCallback()) {
+    if (millis() - monitorTime >= 60000UL) {
+        if (connection.isConnected()) {
             sendLiveData(client);
+#if KEEP_ALIVE_STATS > 0
+            if (keepAlives++ % KEEP_ALIVE_STATS == 0 && !sendStats(client, messageQueue, COUNT_OF(messageQueue), inboundAliases, receivedSequences, spill)) {
+                warning("Failed to publish stats");
+            }
+#endif
         }
         monitorTime = millis();
     }
+    if (millis() - replayTime >= REPLAY_PERIOD) {
+        if (connection.isConnected() && replaySpilled(client, spill, MAX_REPLAYS_PER_RUN) > 0) {
+            debug("Spilled messages left %d", spill.size());
+        }
+        replayTime = millis();
+    }
     if (millis() - lastSentMessageTime >= 1500) {
-        uint8_t messagesSent = sendMessages(encNetwork, messageQueue, COUNT_OF(messageQueue));
+        uint8_t messagesSent = sendMessages(encNetwork, compactNodes, messageQueue, COUNT_OF(messageQueue));
         if (messagesSent > 0) {
             info("Messages sent %d", messagesSent);
         }
         lastSentMessageTime = millis();
     }
-    delay(5);
+    // sleep only when the radio was idle, yield keeps wifi running while busy
+    uint8_t sleep = idleBackoff.next(forwarded > 0);
+    if (sleep > 0) {
+        delay(sleep);
+    } else {
+        yield();
+    }
     resetWatchDog();
 }
@@ -0,0 +1,284 @@
+#include <chrono>
+#include <random>
+#include <thread>
+#include <unistd.h>
+#include <fcntl.h>
+#include "Arduino.h"
+#include "avr/wdt.h"
+
+HardwareSerial Serial;
+EspClass ESP;
+
+namespace
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    bool virtualClock {false};
+    unsigned long long virtualMicros {0};
+    int pinValues[64] {0};
+    std::mt19937 generator {std::random_device{}()};
+    int peeked {-1};
+}
+
+namespace HostHal
+{
+    void useVirtualClock(bool enabled)
+    {
+        virtualClock = enabled;
+    }
+
+    void advanceClock(unsigned long ms)
+    {
+        virtualMicros += (unsigned long long)ms * 1000;
+    }
+
+    void setPinValue(uint8_t pin, int value)
+    {
+        if (pin < 64) {
+            pinValues[pin] = value;
+        }
+    }
+
+    int getPinValue(uint8_t pin)
+    {
+        return pin < 64 ? pinValues[pin] : 0;
+    }
+}
+
+void init()
+{
+    // stdin is used as serial input
+    fcntl(STDIN_FILENO, F_SETFL, fcntl(STDIN_FILENO, F_GETFL) | O_NONBLOCK);
+}
+
+unsigned long micros()
+{
+    if (virtualClock) {
+        return (unsigned long)virtualMicros;
+    }
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+unsigned long millis()
+{
+    if (virtualClock) {
+        return (unsigned long)(virtualMicros / 1000);
+    }
+    return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void delay(unsigned long ms)
+{
+    if (virtualClock) {
+        HostHal::advanceClock(ms);
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    if (virtualClock) {
+        virtualMicros += us;
+        return;
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield()
+{
+}
+
+void pinMode(uint8_t, uint8_t)
+{
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    HostHal::setPinValue(pin, value ? HIGH : LOW);
+}
+
+int digitalRead(uint8_t pin)
+{
+    return HostHal::getPinValue(pin) ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+    return HostHal::getPinValue(pin);
+}
+
+void analogWrite(uint8_t pin, int value)
+{
+    HostHal::setPinValue(pin, value);
+}
+
+long random(long max)
+{
+    return max > 0 ? std::uniform_int_distribution<long>(0, max - 1)(generator) : 0;
+}
+
+long random(long min, long max)
+{
+    return min < max ? min + random(max - min) : min;
+}
+
+void randomSeed(unsigned long seed)
+{
+    generator.seed(seed);
+}
+
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh)
+{
+    return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+}
+
+void HardwareSerial::begin(unsigned long)
+{
+    init();
+}
+
+int HardwareSerial::available()
+{
+    int c = peek();
+    return c >= 0 ? 1 : 0;
+}
+
+int HardwareSerial::peek()
+{
+    if (peeked < 0) {
+        uint8_t c {0};
+        if (::read(STDIN_FILENO, &c, 1) == 1) {
+            peeked = c;
+        }
+    }
+    return peeked;
+}
+
+int HardwareSerial::read()
+{
+    int c = peek();
+    peeked = -1;
+    return c;
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t * buffer, size_t size)
+{
+    return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush()
+{
+    fflush(stdout);
+}
+
+void EspClass::wdtEnable(uint32_t)
+{
+}
+
+void EspClass::wdtDisable()
+{
+}
+
+void EspClass::wdtFeed()
+{
+}
+
+void EspClass::restart()
+{
+    fflush(stdout);
+    exit(HostHal::EXIT_RESTART);
+}
+
+void EspClass::deepSleep(uint64_t us)
+{
+    fflush(stdout);
+    printf("deep sleep for %llu us\n", (unsigned long long)us);
+    exit(HostHal::EXIT_RESTART);
+}
+
+uint32_t EspClass::getFreeHeap()
+{
+    return 40000;
+}
+
+uint32_t EspClass::getFreeContStack()
+{
+    return 2048;
+}
+
+uint32_t EspClass::getChipId()
+{
+    return (uint32_t)getpid();
+}
+
+uint32_t EspClass::getCycleCount()
+{
+    return micros() * 80;
+}
+
+static const char * rtcFile()
+{
+    const char * file = getenv("HOST_RTC_FILE");
+    return file ? file : "rtc.bin";
+}
+
+// same bounds as the 512 bytes of user memory on the chip
+static bool isRtcRange(uint32_t offset, size_t size)
+{
+    return size % 4 == 0 && offset < 128 && offset * 4 + size <= 512;
+}
+
+bool EspClass::rtcUserMemoryRead(uint32_t offset, uint32_t * data, size_t size)
+{
+    if (!isRtcRange(offset, size)) {
+        return false;
+    }
+    uint8_t memory[512] {0};
+    FILE * file = fopen(rtcFile(), "rb");
+    if (file) {
+        size_t count = fread(memory, 1, sizeof(memory), file);
+        (void)count;
+        fclose(file);
+    }
+    memcpy(data, memory + offset * 4, size);
+    return true;
+}
+
+bool EspClass::rtcUserMemoryWrite(uint32_t offset, uint32_t * data, size_t size)
+{
+    if (!isRtcRange(offset, size)) {
+        return false;
+    }
+    uint8_t memory[512] {0};
+    FILE * file = fopen(rtcFile(), "rb");
+    if (file) {
+        size_t count = fread(memory, 1, sizeof(memory), file);
+        (void)count;
+        fclose(file);
+    }
+    memcpy(memory + offset * 4, data, size);
+    file = fopen(rtcFile(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = fwrite(memory, 1, sizeof(memory), file) == sizeof(memory);
+    fclose(file);
+    return written;
+}
+
+void wdt_enable(uint8_t)
+{
+}
+
+void wdt_disable()
+{
+}
+
+void wdt_reset()
+{
+}
@@ -0,0 +1,140 @@
+#ifndef HOST_HAL_ARDUINO_H
+#define HOST_HAL_ARDUINO_H
+
+// stand-in for the arduino core when firmwares are built for linux (see host.mk)
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "pgmspace.h"
+#include "Print.h"
+#include "Stream.h"
+#include "WString.h"
+
+using std::min;
+using std::max;
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef uint16_t word;
+
+#define HIGH 0x1
+#define LOW 0x0
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define DEC 10
+#define HEX 16
+#define OCT 8
+#define BIN 2
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+// nodemcu pin names
+#define D0 16
+#define D1 5
+#define D2 4
+#define D3 0
+#define D4 2
+#define D5 14
+#define D6 12
+#define D7 13
+#define D8 15
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit) ((value) |= (1UL << (bit)))
+#define bitClear(value, bit) ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue) ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define lowByte(w) ((uint8_t) ((w) & 0xff))
+#define highByte(w) ((uint8_t) ((w) >> 8))
+
+template<typename T, typename L, typename H>
+T constrain(T value, L low, H high)
+{
+    return value < low ? low : (value > high ? high : value);
+}
+
+void init();
+void setup();
+void loop();
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+long map(long value, long fromLow, long fromHigh, long toLow, long toHigh);
+
+class HardwareSerial: public Stream
+{
+    public:
+        void begin(unsigned long baud);
+        void end() {}
+        int available() override;
+        int read() override;
+        int peek() override;
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t * buffer, size_t size) override;
+        using Print::write;
+        void flush() override;
+        operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass
+{
+    public:
+        void wdtEnable(uint32_t timeout);
+        void wdtDisable();
+        void wdtFeed();
+        void restart();
+        void deepSleep(uint64_t us);
+        uint32_t getFreeHeap();
+        uint32_t getFreeContStack();
+        uint32_t getChipId();
+        uint32_t getCycleCount();
+        // rtc user memory, offset in 4 byte blocks, kept in $HOST_RTC_FILE across deep sleep
+        bool rtcUserMemoryRead(uint32_t offset, uint32_t * data, size_t size);
+        bool rtcUserMemoryWrite(uint32_t offset, uint32_t * data, size_t size);
+};
+
+extern EspClass ESP;
+
+namespace HostHal
+{
+    // time only moves with advanceClock, delay() advances it instead of sleeping
+    void useVirtualClock(bool enabled);
+    void advanceClock(unsigned long ms);
+
+    // simulated pin levels read by digitalRead/analogRead
+    void setPinValue(uint8_t pin, int value);
+    int getPinValue(uint8_t pin);
+
+    // ESP.restart and ESP.deepSleep end the process with this exit code
+    const int EXIT_RESTART {3};
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef HOST_HAL_DALLAS_TEMPERATURE_H
+#define HOST_HAL_DALLAS_TEMPERATURE_H
+
+#include "Arduino.h"
+#include "OneWire.h"
+
+#define DEVICE_DISCONNECTED_C -127
+
+typedef uint8_t DeviceAddress[8];
+
+// one simulated sensor per bus, temperature is the host pin value in 1/100 C
+class DallasTemperature
+{
+    private:
+        OneWire * wire;
+
+    public:
+        DallasTemperature(): wire(nullptr) {}
+        DallasTemperature(OneWire * wire): wire(wire) {}
+
+        void setOneWire(OneWire * value) { wire = value; }
+        void begin() {}
+        uint8_t getDeviceCount() { return wire ? 1 : 0; }
+        bool getAddress(uint8_t * address, uint8_t index) { memset(address, 0, 8); return wire && index == 0; }
+        bool isConnected(const uint8_t *) { return wire != nullptr; }
+        void setResolution(uint8_t) {}
+        void setWaitForConversion(bool) {}
+        bool isConversionComplete() { return true; }
+        void requestTemperatures() {}
+        bool requestTemperaturesByIndex(uint8_t index) { return index == 0; }
+        bool requestTemperaturesByAddress(const uint8_t *) { return true; }
+        float getTempC(const uint8_t *) { return getTempCByIndex(0); }
+        float getTempCByIndex(uint8_t index)
+        {
+            return wire && index == 0 ? HostHal::getPinValue(wire->getPin()) / 100.0 : DEVICE_DISCONNECTED_C;
+        }
+};
+
+#endif
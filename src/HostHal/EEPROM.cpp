@@ -0,0 +1,44 @@
+#include "EEPROM.h"
+
+EEPROMClass EEPROM;
+
+static const char * eepromFile()
+{
+    const char * file = getenv("HOST_EEPROM_FILE");
+    return file ? file : "eeprom.bin";
+}
+
+void EEPROMClass::begin(size_t requested)
+{
+    size = requested < sizeof(data) ? requested : sizeof(data);
+    memset(data, 0xFF, sizeof(data));
+    FILE * file = fopen(eepromFile(), "rb");
+    if (file) {
+        size_t count = fread(data, 1, size, file);
+        (void)count;
+        fclose(file);
+    }
+}
+
+uint8_t EEPROMClass::read(int address)
+{
+    return address >= 0 && (size_t)address < size ? data[address] : 0xFF;
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+    if (address >= 0 && (size_t)address < size) {
+        data[address] = value;
+    }
+}
+
+bool EEPROMClass::commit()
+{
+    FILE * file = fopen(eepromFile(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = fwrite(data, 1, size, file) == size;
+    fclose(file);
+    return written;
+}
@@ -0,0 +1,42 @@
+#ifndef HOST_HAL_EEPROM_H
+#define HOST_HAL_EEPROM_H
+
+#include "Arduino.h"
+
+// eeprom kept in a file, HOST_EEPROM_FILE environment variable overrides the default eeprom.bin
+class EEPROMClass
+{
+    private:
+        uint8_t data[4096] {0};
+        size_t size {1024};
+
+    public:
+        void begin(size_t size);
+        uint8_t read(int address);
+        void write(int address, uint8_t value);
+        bool commit();
+        void end() { commit(); }
+        size_t length() const { return size; }
+
+        template<typename T>
+        T & get(int address, T & value)
+        {
+            if (address >= 0 && address + sizeof(T) <= size) {
+                memcpy(&value, data + address, sizeof(T));
+            }
+            return value;
+        }
+
+        template<typename T>
+        const T & put(int address, const T & value)
+        {
+            if (address >= 0 && address + sizeof(T) <= size) {
+                memcpy(data + address, &value, sizeof(T));
+            }
+            return value;
+        }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef HOST_HAL_ESP8266_HTTP_CLIENT_H
+#define HOST_HAL_ESP8266_HTTP_CLIENT_H
+
+#include <string>
+#include "ESP8266WiFi.h"
+
+#define HTTP_CODE_OK 200
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+// http/1.1 client with the ESP8266HTTPClient interface used by the firmwares
+class HTTPClient
+{
+    private:
+        WiFiClient client;
+        std::string host;
+        uint16_t port {80};
+        std::string path;
+        std::string headers;
+        bool reuse {false};
+        unsigned long timeout {5000};
+
+        int readResponse();
+
+    public:
+        bool begin(const char * url);
+        bool begin(const String & url) { return begin(url.c_str()); }
+        void setReuse(bool value) { reuse = value; }
+        void setTimeout(uint16_t value) { timeout = value; }
+        void addHeader(const char * name, const char * value);
+        int POST(const uint8_t * payload, size_t size);
+        int POST(const String & payload) { return POST((const uint8_t *)payload.c_str(), payload.length()); }
+        void end();
+        bool connected() { return client.connected(); }
+};
+
+#endif
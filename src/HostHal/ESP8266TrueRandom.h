@@ -0,0 +1,18 @@
+#ifndef HOST_HAL_ESP8266_TRUE_RANDOM_H
+#define HOST_HAL_ESP8266_TRUE_RANDOM_H
+
+#include "Arduino.h"
+
+class ESP8266TrueRandomClass
+{
+    public:
+        int rand() { return random(0x8000); }
+        long random() { return ::random(0x7FFFFFFF); }
+        long random(long max) { return ::random(max); }
+        long random(long min, long max) { return ::random(min, max); }
+        char randomBit() { return ::random(2); }
+        char randomByte() { return ::random(256); }
+        void memfill(char * location, int size) { while (size--) { *location++ = randomByte(); } }
+};
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef HOST_HAL_ESP8266_WIFI_H
+#define HOST_HAL_ESP8266_WIFI_H
+
+#include "Arduino.h"
+#include "Client.h"
+#include "IPAddress.h"
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA = 1,
+    WIFI_AP = 2,
+    WIFI_AP_STA = 3
+} WiFiMode_t;
+
+// host network is always connected
+// a static config and a channel/bssid begin are accepted, the address is still the loopback
+class ESP8266WiFiClass
+{
+    private:
+        wl_status_t state {WL_DISCONNECTED};
+        char ssid[33] {0};
+        IPAddress gateway {127, 0, 0, 1};
+        IPAddress subnet {255, 0, 0, 0};
+        IPAddress dns {127, 0, 0, 1};
+
+    public:
+        bool mode(WiFiMode_t) { return true; }
+        void persistent(bool) {}
+        bool config(IPAddress, IPAddress gateway, IPAddress subnet, IPAddress dns = IPAddress())
+        {
+            this->gateway = gateway;
+            this->subnet = subnet;
+            this->dns = dns;
+            return true;
+        }
+        wl_status_t begin(const char * ssid, const char * = nullptr, int32_t = 0, const uint8_t * = nullptr, bool = true)
+        {
+            strncpy(this->ssid, ssid, sizeof(this->ssid) - 1);
+            state = WL_CONNECTED;
+            return state;
+        }
+        wl_status_t status() const { return state; }
+        bool isConnected() const { return state == WL_CONNECTED; }
+        bool disconnect(bool = false) { state = WL_DISCONNECTED; return true; }
+        void setConnected(bool connected) { state = connected ? WL_CONNECTED : WL_DISCONNECTED; }
+        String SSID() const { return String(ssid); }
+        IPAddress localIP() const { return IPAddress(127, 0, 0, 1); }
+        IPAddress gatewayIP() const { return gateway; }
+        IPAddress subnetMask() const { return subnet; }
+        IPAddress dnsIP(uint8_t = 0) const { return dns; }
+        int32_t RSSI() const { return -40; }
+        int32_t channel() const { return 1; }
+        uint8_t * BSSID() { static uint8_t bssid[6] {0}; return bssid; }
+        int hostByName(const char * host, IPAddress & address);
+};
+
+extern ESP8266WiFiClass WiFi;
+
+// tcp client over posix sockets
+class WiFiClient: public Client
+{
+    private:
+        int socket {-1};
+        int peeked {-1};
+
+    public:
+        WiFiClient() {}
+        WiFiClient(const WiFiClient &) = delete;
+        WiFiClient & operator=(const WiFiClient &) = delete;
+        ~WiFiClient() { stop(); }
+
+        int connect(IPAddress ip, uint16_t port) override;
+        int connect(const char * host, uint16_t port) override;
+        size_t write(uint8_t c) override;
+        size_t write(const uint8_t * buffer, size_t size) override;
+        using Print::write;
+        int available() override;
+        int read() override;
+        int read(uint8_t * buffer, size_t size) override;
+        int peek() override;
+        void flush() override {}
+        void stop() override;
+        uint8_t connected() override;
+        operator bool() override { return connected(); }
+        void setNoDelay(bool) {}
+};
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef HOST_HAL_ESP8266_WIFI_MULTI_H
+#define HOST_HAL_ESP8266_WIFI_MULTI_H
+
+#include "ESP8266WiFi.h"
+
+class ESP8266WiFiMulti
+{
+    private:
+        const char * ssid {nullptr};
+
+    public:
+        bool addAP(const char * ssid, const char * = nullptr)
+        {
+            if (!this->ssid) {
+                this->ssid = ssid;
+            }
+            return ssid != nullptr;
+        }
+        wl_status_t run() { return WiFi.begin(ssid ? ssid : "host"); }
+};
+
+#endif
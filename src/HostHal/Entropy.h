@@ -0,0 +1,23 @@
+#ifndef HOST_HAL_ENTROPY_H
+#define HOST_HAL_ENTROPY_H
+
+#include "Arduino.h"
+
+#define WDT_RETURN_BYTE 256
+#define WDT_RETURN_WORD 65536
+
+class EntropyClass
+{
+    public:
+        void initialize() {}
+        uint32_t random() { return ((uint32_t)::random(0x10000) << 16) | ::random(0x10000); }
+        uint32_t random(uint32_t max) { return max > 0 ? random() % max : 0; }
+        uint32_t random(uint32_t min, uint32_t max) { return min < max ? min + random(max - min) : min; }
+        uint8_t randomByte() { return random(WDT_RETURN_BYTE); }
+        uint16_t randomWord() { return random(WDT_RETURN_WORD); }
+        int available() { return 4; }
+};
+
+extern EntropyClass Entropy;
+
+#endif
@@ -0,0 +1,118 @@
+#include <sys/stat.h>
+#include "LittleFS.h"
+
+fs::FS LittleFS;
+
+static const char * fsDirectory()
+{
+    const char * directory = getenv("HOST_FS_DIR");
+    return directory ? directory : "littlefs";
+}
+
+namespace fs
+{
+    File & File::operator=(File && other)
+    {
+        if (this != &other) {
+            close();
+            file = other.file;
+            other.file = nullptr;
+        }
+        return *this;
+    }
+
+    size_t File::write(const uint8_t * buffer, size_t size)
+    {
+        return file ? fwrite(buffer, 1, size, file) : 0;
+    }
+
+    size_t File::read(uint8_t * buffer, size_t size)
+    {
+        return file ? fread(buffer, 1, size, file) : 0;
+    }
+
+    int File::read()
+    {
+        return file ? fgetc(file) : -1;
+    }
+
+    bool File::seek(uint32_t position, SeekMode mode)
+    {
+        int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+        return file && fseek(file, position, whence) == 0;
+    }
+
+    size_t File::position() const
+    {
+        return file ? ftell(file) : 0;
+    }
+
+    size_t File::size() const
+    {
+        if (!file) {
+            return 0;
+        }
+        long current = ftell(file);
+        fseek(file, 0, SEEK_END);
+        long end = ftell(file);
+        fseek(file, current, SEEK_SET);
+        return end;
+    }
+
+    void File::flush()
+    {
+        if (file) {
+            fflush(file);
+        }
+    }
+
+    void File::close()
+    {
+        if (file) {
+            fclose(file);
+            file = nullptr;
+        }
+    }
+
+    void FS::path(char * buffer, size_t length, const char * name) const
+    {
+        snprintf(buffer, length, "%s/%s", fsDirectory(), name[0] == '/' ? name + 1 : name);
+    }
+
+    bool FS::begin()
+    {
+        mkdir(fsDirectory(), 0777);
+        struct stat info;
+        return stat(fsDirectory(), &info) == 0 && S_ISDIR(info.st_mode);
+    }
+
+    bool FS::format()
+    {
+        return begin();
+    }
+
+    File FS::open(const char * name, const char * mode)
+    {
+        char buffer[256] {0};
+        path(buffer, sizeof(buffer), name);
+        // binary mode, fopen accepts the same letters as the esp8266 api
+        char binaryMode[4] {0};
+        snprintf(binaryMode, sizeof(binaryMode), "%c%sb", mode[0], mode[1] == '+' ? "+" : "");
+        return File(fopen(buffer, binaryMode));
+    }
+
+    bool FS::exists(const char * name)
+    {
+        char buffer[256] {0};
+        path(buffer, sizeof(buffer), name);
+        struct stat info;
+        return stat(buffer, &info) == 0;
+    }
+
+    bool FS::remove(const char * name)
+    {
+        char buffer[256] {0};
+        path(buffer, sizeof(buffer), name);
+        return ::remove(buffer) == 0;
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef HOST_HAL_FS_H
+#define HOST_HAL_FS_H
+
+#include "Arduino.h"
+
+// esp8266 filesystem api over files in a host directory
+namespace fs
+{
+    enum SeekMode
+    {
+        SeekSet = 0,
+        SeekCur = 1,
+        SeekEnd = 2
+    };
+
+    class File
+    {
+        private:
+            FILE * file {nullptr};
+
+        public:
+            File() {}
+            explicit File(FILE * file): file(file) {}
+            File(const File &) = delete;
+            File & operator=(const File &) = delete;
+            File(File && other): file(other.file) { other.file = nullptr; }
+            File & operator=(File && other);
+            ~File() { close(); }
+
+            operator bool() const { return file != nullptr; }
+            size_t write(const uint8_t * buffer, size_t size);
+            size_t write(uint8_t value) { return write(&value, 1); }
+            size_t read(uint8_t * buffer, size_t size);
+            int read();
+            bool seek(uint32_t position, SeekMode mode = SeekSet);
+            size_t position() const;
+            size_t size() const;
+            void flush();
+            void close();
+    };
+
+    class FS
+    {
+        private:
+            void path(char * buffer, size_t length, const char * name) const;
+
+        public:
+            bool begin();
+            void end() {}
+            bool format();
+            // modes as fopen: "r", "r+", "w", "w+", "a", "a+"
+            File open(const char * name, const char * mode);
+            bool exists(const char * name);
+            bool remove(const char * name);
+    };
+}
+
+using fs::File;
+using fs::FS;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+#endif
@@ -0,0 +1,99 @@
+#include <strings.h>
+#include "ESP8266HTTPClient.h"
+
+bool HTTPClient::begin(const char * url)
+{
+    std::string value(url);
+    const std::string scheme("http://");
+    if (value.compare(0, scheme.size(), scheme) != 0) {
+        return false;
+    }
+    value = value.substr(scheme.size());
+    size_t pathStart = value.find('/');
+    std::string authority = value.substr(0, pathStart);
+    std::string newPath = pathStart == std::string::npos ? "/" : value.substr(pathStart);
+    size_t portStart = authority.find(':');
+    std::string newHost = authority.substr(0, portStart);
+    uint16_t newPort = portStart == std::string::npos ? 80 : atoi(authority.substr(portStart + 1).c_str());
+
+    if (newHost != host || newPort != port) {
+        client.stop();
+    }
+    host = newHost;
+    port = newPort;
+    path = newPath;
+    headers.clear();
+    return true;
+}
+
+void HTTPClient::addHeader(const char * name, const char * value)
+{
+    headers += std::string(name) + ": " + value + "\r\n";
+}
+
+int HTTPClient::POST(const uint8_t * payload, size_t size)
+{
+    if (!client.connected() && !client.connect(host.c_str(), port)) {
+        return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    std::string request = "POST " + path + " HTTP/1.1\r\n"
+        + "Host: " + host + "\r\n"
+        + "Connection: " + (reuse ? "keep-alive" : "close") + "\r\n"
+        + "Content-Length: " + std::to_string(size) + "\r\n"
+        + headers + "\r\n";
+    if (client.write((const uint8_t *)request.data(), request.size()) != request.size()
+        || client.write(payload, size) != size) {
+        client.stop();
+        return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+    }
+    return readResponse();
+}
+
+int HTTPClient::readResponse()
+{
+    std::string line;
+    int code {HTTPC_ERROR_READ_TIMEOUT};
+    long contentLength {0};
+    bool statusLine {true};
+    unsigned long start = millis();
+    while (millis() - start < timeout) {
+        int c = client.read();
+        if (c < 0) {
+            if (!client.connected()) {
+                break;
+            }
+            continue;
+        }
+        if (c != '\n') {
+            if (c != '\r') {
+                line += (char)c;
+            }
+            continue;
+        }
+        if (statusLine) {
+            size_t codeStart = line.find(' ');
+            code = codeStart == std::string::npos ? HTTPC_ERROR_READ_TIMEOUT : atoi(line.c_str() + codeStart + 1);
+            statusLine = false;
+        } else if (line.empty()) {
+            // skip body, connection stays usable for the next request
+            while (contentLength > 0 && millis() - start < timeout) {
+                if (client.read() >= 0) {
+                    contentLength--;
+                }
+            }
+            return code;
+        } else if (strncasecmp(line.c_str(), "content-length:", 15) == 0) {
+            contentLength = atol(line.c_str() + 15);
+        }
+        line.clear();
+    }
+    client.stop();
+    return code;
+}
+
+void HTTPClient::end()
+{
+    if (!reuse) {
+        client.stop();
+    }
+}
@@ -0,0 +1,13 @@
+#include "Arduino.h"
+
+// entry point for sketches using setup/loop, sketches with their own main
+// build with HOST_MAIN=0
+int main()
+{
+    init();
+    setup();
+    while (true) {
+        loop();
+    }
+    return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef HOST_HAL_IP_ADDRESS_H
+#define HOST_HAL_IP_ADDRESS_H
+
+#include "Arduino.h"
+
+class IPAddress
+{
+    private:
+        uint8_t bytes[4] {0};
+
+    public:
+        IPAddress() {}
+        IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{a, b, c, d} {}
+        IPAddress(uint32_t address) { memcpy(bytes, &address, sizeof(bytes)); }
+
+        uint8_t operator[](int index) const { return bytes[index]; }
+        uint8_t & operator[](int index) { return bytes[index]; }
+        operator uint32_t() const { uint32_t address; memcpy(&address, bytes, sizeof(address)); return address; }
+        bool fromString(const char * address);
+        String toString() const;
+};
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef HOST_HAL_LITTLE_FS_H
+#define HOST_HAL_LITTLE_FS_H
+
+#include "FS.h"
+
+// files live in HOST_FS_DIR, default ./littlefs
+extern fs::FS LittleFS;
+
+#endif
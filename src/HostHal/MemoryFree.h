@@ -0,0 +1,8 @@
+#ifndef HOST_HAL_MEMORY_FREE_H
+#define HOST_HAL_MEMORY_FREE_H
+
+#include "Arduino.h"
+
+int freeMemory();
+
+#endif
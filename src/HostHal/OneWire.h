@@ -0,0 +1,17 @@
+#ifndef HOST_HAL_ONE_WIRE_H
+#define HOST_HAL_ONE_WIRE_H
+
+#include "Arduino.h"
+
+class OneWire
+{
+    private:
+        uint8_t pin;
+
+    public:
+        OneWire(uint8_t pin): pin(pin) {}
+        uint8_t getPin() const { return pin; }
+        uint8_t reset() { return 1; }
+};
+
+#endif
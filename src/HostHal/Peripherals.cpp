@@ -0,0 +1,13 @@
+#include "SPI.h"
+#include "Wire.h"
+#include "Entropy.h"
+#include "MemoryFree.h"
+
+SPIClass SPI;
+TwoWire Wire;
+EntropyClass Entropy;
+
+int freeMemory()
+{
+    return 1024;
+}
@@ -0,0 +1,63 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include "Print.h"
+#include "WString.h"
+
+size_t Print::write(const uint8_t * buffer, size_t size)
+{
+    size_t written {0};
+    while (size--) {
+        written += write(*buffer++);
+    }
+    return written;
+}
+
+size_t Print::print(const String & value)
+{
+    return write(value.c_str());
+}
+
+size_t Print::printNumber(unsigned long value, uint8_t base)
+{
+    char buffer[8 * sizeof(long) + 1] {0};
+    char * position = &buffer[sizeof(buffer) - 1];
+    if (base < 2) {
+        base = 10;
+    }
+    do {
+        char digit = value % base;
+        value /= base;
+        *--position = digit < 10 ? digit + '0' : digit + 'A' - 10;
+    } while (value);
+    return write(position);
+}
+
+size_t Print::print(long value, int base)
+{
+    if (base == 10 && value < 0) {
+        return write('-') + printNumber(-(unsigned long)value, 10);
+    }
+    return printNumber((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    return printNumber(value, base);
+}
+
+size_t Print::print(double value, int digits)
+{
+    char buffer[32] {0};
+    snprintf(buffer, sizeof(buffer), "%.*f", digits, value);
+    return write(buffer);
+}
+
+size_t Print::printf(const char * format, ...)
+{
+    char buffer[256] {0};
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(buffer, sizeof(buffer), format, arguments);
+    va_end(arguments);
+    return write(buffer);
+}
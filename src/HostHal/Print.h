@@ -0,0 +1,54 @@
+#ifndef HOST_HAL_PRINT_H
+#define HOST_HAL_PRINT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "pgmspace.h"
+
+class String;
+
+class Print
+{
+    private:
+        size_t printNumber(unsigned long value, uint8_t base);
+
+    public:
+        virtual ~Print() {}
+
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t * buffer, size_t size);
+        virtual void flush() {}
+
+        size_t write(const char * value) { return value ? write((const uint8_t *)value, strlen(value)) : 0; }
+        size_t write(const char * buffer, size_t size) { return write((const uint8_t *)buffer, size); }
+
+        size_t print(const __FlashStringHelper * value) { return write((const char *)value); }
+        size_t print(const String & value);
+        size_t print(const char * value) { return write(value); }
+        size_t print(char value) { return write((uint8_t)value); }
+        size_t print(unsigned char value, int base = 10) { return print((unsigned long)value, base); }
+        size_t print(int value, int base = 10) { return print((long)value, base); }
+        size_t print(unsigned int value, int base = 10) { return print((unsigned long)value, base); }
+        size_t print(long value, int base = 10);
+        size_t print(unsigned long value, int base = 10);
+        size_t print(double value, int digits = 2);
+
+        template<typename T>
+        size_t println(const T & value)
+        {
+            size_t written = print(value);
+            return written + println();
+        }
+        template<typename T>
+        size_t println(const T & value, int format)
+        {
+            size_t written = print(value, format);
+            return written + println();
+        }
+        size_t println() { return write("\r\n"); }
+
+        size_t printf(const char * format, ...) __attribute__ ((format (printf, 2, 3)));
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "RF24.h"
+
+static const char * radioDirectory()
+{
+    const char * directory = getenv("HOST_RADIO_DIR");
+    return directory ? directory : "/tmp/rf24-host";
+}
+
+static long radioLoss()
+{
+    const char * loss = getenv("HOST_RADIO_LOSS");
+    return loss ? atol(loss) : 0;
+}
+
+RF24::RF24(uint16_t, uint16_t, uint32_t)
+{
+}
+
+RF24::~RF24()
+{
+    if (socket >= 0) {
+        close(socket);
+    }
+}
+
+bool RF24::begin()
+{
+    failureDetected = false;
+    return true;
+}
+
+void RF24::setChannel(uint8_t value)
+{
+    if (value != channel && socket >= 0) {
+        close(socket);
+        socket = -1;
+        channel = value;
+        openAddress(address);
+        return;
+    }
+    channel = value;
+}
+
+void RF24::addressPath(char * path, size_t length, uint16_t node) const
+{
+    snprintf(path, length, "%s/%u/%u", radioDirectory(), channel, node);
+}
+
+bool RF24::openAddress(uint16_t node)
+{
+    if (socket >= 0) {
+        close(socket);
+    }
+    address = node;
+    char directory[96] {0};
+    snprintf(directory, sizeof(directory), "%s/%u", radioDirectory(), channel);
+    mkdir(radioDirectory(), 0777);
+    mkdir(directory, 0777);
+
+    sockaddr_un local {};
+    local.sun_family = AF_UNIX;
+    addressPath(local.sun_path, sizeof(local.sun_path), node);
+    unlink(local.sun_path);
+
+    socket = ::socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (socket < 0 || bind(socket, (sockaddr *)&local, sizeof(local)) != 0) {
+        failureDetected = true;
+        return false;
+    }
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+bool RF24::sendFrame(uint16_t node, const uint8_t * frame, size_t length)
+{
+    if (socket < 0 || !poweredUp) {
+        return false;
+    }
+    // lost frames look like missing acks to the sender
+    if (random(100) < radioLoss()) {
+        return false;
+    }
+    sockaddr_un remote {};
+    remote.sun_family = AF_UNIX;
+    addressPath(remote.sun_path, sizeof(remote.sun_path), node);
+    return sendto(socket, frame, length, 0, (sockaddr *)&remote, sizeof(remote)) == (ssize_t)length;
+}
+
+int RF24::receiveFrame(uint8_t * frame, size_t length)
+{
+    if (socket < 0 || !poweredUp) {
+        return -1;
+    }
+    ssize_t received = recv(socket, frame, length, 0);
+    return received < 0 ? -1 : (int)received;
+}
@@ -0,0 +1,60 @@
+#ifndef HOST_HAL_RF24_H
+#define HOST_HAL_RF24_H
+
+#include "Arduino.h"
+
+typedef enum { RF24_PA_MIN = 0, RF24_PA_LOW, RF24_PA_HIGH, RF24_PA_MAX, RF24_PA_ERROR } rf24_pa_dbm_e;
+typedef enum { RF24_1MBPS = 0, RF24_2MBPS, RF24_250KBPS } rf24_datarate_e;
+typedef enum { RF24_CRC_DISABLED = 0, RF24_CRC_8, RF24_CRC_16 } rf24_crclength_e;
+
+// nrf24l01 stand-in, frames are unix datagrams exchanged under
+// $HOST_RADIO_DIR (default /tmp/rf24-host)/<channel>/<address>
+// HOST_RADIO_LOSS=<percent> drops sent frames at random
+class RF24
+{
+    private:
+        uint8_t channel {76};
+        uint8_t paLevel {RF24_PA_MAX};
+        rf24_datarate_e dataRate {RF24_1MBPS};
+        int socket {-1};
+        uint16_t address {0xFFFF};
+        bool poweredUp {true};
+
+        void addressPath(char * path, size_t length, uint16_t node) const;
+
+    public:
+        bool failureDetected {false};
+
+        RF24(uint16_t cePin, uint16_t csPin, uint32_t spiSpeed = 10000000);
+        ~RF24();
+
+        bool begin();
+        bool isChipConnected() { return true; }
+        bool isPVariant() { return true; }
+        void startListening() {}
+        void stopListening() {}
+        void powerDown() { poweredUp = false; }
+        void powerUp() { poweredUp = true; }
+        bool isPoweredUp() const { return poweredUp; }
+        void printDetails() {}
+        void setPALevel(uint8_t level, bool = true) { paLevel = level; }
+        uint8_t getPALevel() { return paLevel; }
+        bool setDataRate(rf24_datarate_e rate) { dataRate = rate; return true; }
+        rf24_datarate_e getDataRate() { return dataRate; }
+        void setChannel(uint8_t value);
+        uint8_t getChannel() { return channel; }
+        void setRetries(uint8_t, uint8_t) {}
+        void setAutoAck(bool) {}
+        void setAutoAck(uint8_t, bool) {}
+        void setCRCLength(rf24_crclength_e) {}
+        void setPayloadSize(uint8_t) {}
+        bool testCarrier() { return false; }
+        bool testRPD() { return false; }
+
+        // used by RF24Network stand-in
+        bool openAddress(uint16_t node);
+        bool sendFrame(uint16_t node, const uint8_t * frame, size_t length);
+        int receiveFrame(uint8_t * frame, size_t length);
+};
+
+#endif
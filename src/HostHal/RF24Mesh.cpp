@@ -0,0 +1,113 @@
+#include "RF24Mesh.h"
+
+bool RF24Mesh::begin(uint8_t value, rf24_datarate_e dataRate, uint32_t timeout)
+{
+    channel = value;
+    radio.begin();
+    radio.setChannel(channel);
+    radio.setDataRate(dataRate);
+    return renewAddress(timeout) != MESH_DEFAULT_ADDRESS;
+}
+
+uint8_t RF24Mesh::update()
+{
+    return network.update();
+}
+
+void RF24Mesh::DHCP()
+{
+    // addresses are static on the host, the master only records who talked to it
+    if (_nodeID != 0 || !network.available()) {
+        return;
+    }
+    RF24NetworkHeader header;
+    network.peek(header);
+    if (getAddress(header.from_node) < 0) {
+        setAddress(header.from_node, header.from_node);
+    }
+}
+
+bool RF24Mesh::write(const void * data, uint8_t type, size_t size, uint8_t nodeID)
+{
+    int16_t address = getAddress(nodeID);
+    if (address < 0) {
+        return false;
+    }
+    return write(address, data, type, size);
+}
+
+bool RF24Mesh::write(uint16_t toNode, const void * data, uint8_t type, size_t size)
+{
+    if (mesh_address == MESH_DEFAULT_ADDRESS) {
+        return false;
+    }
+    RF24NetworkHeader header(toNode, type);
+    return network.write(header, data, size);
+}
+
+void RF24Mesh::setChannel(uint8_t value)
+{
+    channel = value;
+    radio.setChannel(value);
+}
+
+void RF24Mesh::setAddress(uint8_t nodeID, uint16_t address, bool)
+{
+    for (uint8_t i = 0; i < addrListTop; i++) {
+        if (addrList[i].nodeID == nodeID) {
+            addrList[i].address = address;
+            return;
+        }
+    }
+    if (addrListTop < MESH_MAX_ADDRESSES) {
+        addrList[addrListTop++] = {nodeID, address};
+    }
+}
+
+int16_t RF24Mesh::getNodeID(uint16_t address)
+{
+    if (address == MESH_BLANK_ID) {
+        return _nodeID;
+    }
+    return address;
+}
+
+int16_t RF24Mesh::getAddress(uint8_t nodeID)
+{
+    if (nodeID == 0) {
+        return 0;
+    }
+    if (_nodeID != 0) {
+        // a child reaches any node directly
+        return nodeID;
+    }
+    for (uint8_t i = 0; i < addrListTop; i++) {
+        if (addrList[i].nodeID == nodeID) {
+            return addrList[i].address;
+        }
+    }
+    return -1;
+}
+
+bool RF24Mesh::checkConnection()
+{
+    return mesh_address != MESH_DEFAULT_ADDRESS && !radio.failureDetected;
+}
+
+uint16_t RF24Mesh::renewAddress(uint32_t)
+{
+    mesh_address = _nodeID;
+    network.begin(mesh_address);
+    assigned = !radio.failureDetected;
+    if (!assigned) {
+        mesh_address = MESH_DEFAULT_ADDRESS;
+    }
+    return mesh_address;
+}
+
+bool RF24Mesh::releaseAddress()
+{
+    mesh_address = MESH_DEFAULT_ADDRESS;
+    assigned = false;
+    return true;
+}
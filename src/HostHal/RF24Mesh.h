@@ -0,0 +1,51 @@
+#ifndef HOST_HAL_RF24_MESH_H
+#define HOST_HAL_RF24_MESH_H
+
+#include "RF24Network.h"
+
+#define MESH_DEFAULT_CHANNEL 97
+#define MESH_RENEWAL_TIMEOUT 7500
+#define MESH_BLANK_ID 65535
+#define MESH_DEFAULT_ADDRESS 04444
+#define MESH_MAX_ADDRESSES 255
+
+// RF24Mesh stand-in, the mesh address of a node is its node id
+class RF24Mesh
+{
+    private:
+        RF24 & radio;
+        RF24Network & network;
+        uint8_t channel {MESH_DEFAULT_CHANNEL};
+        bool assigned {false};
+
+    public:
+        struct addrListStruct
+        {
+            uint8_t nodeID;
+            uint16_t address;
+        };
+
+        uint16_t mesh_address {MESH_DEFAULT_ADDRESS};
+        uint8_t _nodeID {0};
+        addrListStruct addrList[MESH_MAX_ADDRESSES];
+        uint8_t addrListTop {0};
+
+        RF24Mesh(RF24 & radio, RF24Network & network): radio(radio), network(network) {}
+
+        bool begin(uint8_t channel = MESH_DEFAULT_CHANNEL, rf24_datarate_e dataRate = RF24_1MBPS, uint32_t timeout = MESH_RENEWAL_TIMEOUT);
+        uint8_t update();
+        void DHCP();
+        bool write(const void * data, uint8_t type, size_t size, uint8_t nodeID = 0);
+        bool write(uint16_t toNode, const void * data, uint8_t type, size_t size);
+        void setNodeID(uint8_t nodeID) { _nodeID = nodeID; }
+        void setChannel(uint8_t value);
+        void setChild(bool) {}
+        void setAddress(uint8_t nodeID, uint16_t address, bool searchByAddress = false);
+        int16_t getNodeID(uint16_t address = MESH_BLANK_ID);
+        int16_t getAddress(uint8_t nodeID);
+        bool checkConnection();
+        uint16_t renewAddress(uint32_t timeout = MESH_RENEWAL_TIMEOUT);
+        bool releaseAddress();
+};
+
+#endif
@@ -0,0 +1,97 @@
+#include "RF24Network.h"
+
+uint16_t RF24NetworkHeader::next_id {1};
+
+const char * RF24NetworkHeader::toString() const
+{
+    static char buffer[45];
+    snprintf(buffer, sizeof(buffer), "id %u from 0%o to 0%o type %d", id, from_node, to_node, type);
+    return buffer;
+}
+
+void RF24Network::begin(uint16_t nodeAddress)
+{
+    node_address = nodeAddress;
+    frameHead = 0;
+    frameCount = 0;
+    radio.openAddress(nodeAddress);
+}
+
+void RF24Network::begin(uint8_t channel, uint16_t nodeAddress)
+{
+    radio.setChannel(channel);
+    begin(nodeAddress);
+}
+
+uint8_t RF24Network::update()
+{
+    uint8_t type {0};
+    uint8_t datagram[sizeof(RF24NetworkHeader) + MAX_PAYLOAD_SIZE];
+    int length;
+    while ((length = radio.receiveFrame(datagram, sizeof(datagram))) >= (int)sizeof(RF24NetworkHeader)) {
+        // like the real fifo, frames arriving at a full queue are lost
+        if (frameCount == MAX_FRAME_QUEUE) {
+            continue;
+        }
+        RF24NetworkFrame & frame = frames[(frameHead + frameCount) % MAX_FRAME_QUEUE];
+        memcpy(&frame.header, datagram, sizeof(RF24NetworkHeader));
+        frame.message_size = length - sizeof(RF24NetworkHeader);
+        memcpy(frame.message_buffer, datagram + sizeof(RF24NetworkHeader), frame.message_size);
+        type = frame.header.type;
+        frameCount++;
+    }
+    return type;
+}
+
+bool RF24Network::available()
+{
+    return frameCount > 0;
+}
+
+uint16_t RF24Network::peek(RF24NetworkHeader & header)
+{
+    if (!available()) {
+        return 0;
+    }
+    header = frames[frameHead].header;
+    return frames[frameHead].message_size;
+}
+
+void RF24Network::peek(RF24NetworkHeader & header, void * message, uint16_t maxLength)
+{
+    uint16_t length = peek(header);
+    if (message && length) {
+        memcpy(message, frames[frameHead].message_buffer, (length < maxLength ? length : maxLength));
+    }
+}
+
+uint16_t RF24Network::read(RF24NetworkHeader & header, void * message, uint16_t maxLength)
+{
+    if (!available()) {
+        return 0;
+    }
+    uint16_t length = frames[frameHead].message_size < maxLength ? frames[frameHead].message_size : maxLength;
+    peek(header, message, maxLength);
+    frameHead = (frameHead + 1) % MAX_FRAME_QUEUE;
+    frameCount--;
+    return length;
+}
+
+bool RF24Network::write(RF24NetworkHeader & header, const void * message, uint16_t length)
+{
+    return write(header, message, length, 070);
+}
+
+bool RF24Network::write(RF24NetworkHeader & header, const void * message, uint16_t length, uint16_t)
+{
+    if (length > MAX_PAYLOAD_SIZE) {
+        return false;
+    }
+    header.from_node = node_address;
+    uint8_t datagram[sizeof(RF24NetworkHeader) + MAX_PAYLOAD_SIZE];
+    memcpy(datagram, &header, sizeof(RF24NetworkHeader));
+    if (length) {
+        memcpy(datagram + sizeof(RF24NetworkHeader), message, length);
+    }
+    return radio.sendFrame(header.to_node, datagram, sizeof(RF24NetworkHeader) + length);
+}
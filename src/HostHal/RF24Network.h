@@ -0,0 +1,69 @@
+#ifndef HOST_HAL_RF24_NETWORK_H
+#define HOST_HAL_RF24_NETWORK_H
+
+#include "RF24.h"
+
+#define MAX_PAYLOAD_SIZE 144
+#define MAX_FRAME_QUEUE 12
+#define NETWORK_ADDR_RESPONSE 128
+#define NETWORK_PING 130
+#define NETWORK_POLL 194
+#define NETWORK_REQ_ADDRESS 195
+#define NETWORK_ACK 193
+
+struct RF24NetworkHeader
+{
+    uint16_t from_node {0};
+    uint16_t to_node {0};
+    uint16_t id {0};
+    unsigned char type {0};
+    unsigned char reserved {0};
+
+    static uint16_t next_id;
+
+    RF24NetworkHeader() {}
+    RF24NetworkHeader(uint16_t to, unsigned char type = 0): to_node(to), id(next_id++), type(type) {}
+
+    const char * toString() const;
+};
+
+struct RF24NetworkFrame
+{
+    RF24NetworkHeader header;
+    uint16_t message_size {0};
+    uint8_t message_buffer[MAX_PAYLOAD_SIZE];
+};
+
+// RF24Network stand-in, no tree routing: every address is reachable directly
+class RF24Network
+{
+    private:
+        RF24 & radio;
+        RF24NetworkFrame frames[MAX_FRAME_QUEUE];
+        uint8_t frameHead {0};
+        uint8_t frameCount {0};
+
+    public:
+        uint16_t node_address {0};
+        uint16_t txTimeout {25};
+        uint16_t routeTimeout {75};
+        bool returnSysMsgs {false};
+        uint8_t networkFlags {0};
+
+        RF24Network(RF24 & radio): radio(radio) {}
+
+        void begin(uint16_t nodeAddress);
+        void begin(uint8_t channel, uint16_t nodeAddress);
+        uint8_t update();
+        bool available();
+        uint16_t peek(RF24NetworkHeader & header);
+        void peek(RF24NetworkHeader & header, void * message, uint16_t maxLength);
+        uint16_t read(RF24NetworkHeader & header, void * message, uint16_t maxLength);
+        bool write(RF24NetworkHeader & header, const void * message, uint16_t length);
+        bool write(RF24NetworkHeader & header, const void * message, uint16_t length, uint16_t writeDirect);
+        uint16_t parent() const { return 0; }
+        bool is_valid_address(uint16_t) { return true; }
+        uint8_t frameQueueSize() const { return frameCount; }
+};
+
+#endif
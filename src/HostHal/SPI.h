@@ -0,0 +1,16 @@
+#ifndef HOST_HAL_SPI_H
+#define HOST_HAL_SPI_H
+
+#include "Arduino.h"
+
+class SPIClass
+{
+    public:
+        void begin() {}
+        void end() {}
+        uint8_t transfer(uint8_t) { return 0; }
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef HOST_HAL_SOFTWARE_SERIAL_H
+#define HOST_HAL_SOFTWARE_SERIAL_H
+
+#include <deque>
+#include <functional>
+#include "Arduino.h"
+
+// bytes written by the firmware are kept in tx, tests and simulations feed rx with inject()
+// a fake device answering commands gets each written byte through onWrite and replies with inject()
+class SoftwareSerial: public Stream
+{
+    private:
+        std::deque<uint8_t> rx;
+        std::deque<uint8_t> tx;
+        std::function<void(uint8_t)> writeCallback;
+
+    public:
+        SoftwareSerial(uint8_t, uint8_t, bool = false) {}
+        virtual ~SoftwareSerial() {}
+
+        void begin(long) {}
+        bool listen() { return true; }
+        bool isListening() { return true; }
+        int available() override { return rx.size(); }
+        int read() override
+        {
+            if (rx.empty()) {
+                return -1;
+            }
+            uint8_t c = rx.front();
+            rx.pop_front();
+            return c;
+        }
+        int peek() override { return rx.empty() ? -1 : rx.front(); }
+        size_t write(uint8_t c) override
+        {
+            tx.push_back(c);
+            if (writeCallback) {
+                writeCallback(c);
+            }
+            return 1;
+        }
+        using Print::write;
+        // drops the received bytes like SoftwareSerial of the esp8266 core
+        void flush() override { rx.clear(); }
+
+        void inject(const uint8_t * data, size_t size) { rx.insert(rx.end(), data, data + size); }
+        std::deque<uint8_t> & written() { return tx; }
+        void onWrite(std::function<void(uint8_t)> callback) { writeCallback = callback; }
+};
+
+#endif
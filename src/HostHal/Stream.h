@@ -0,0 +1,23 @@
+#ifndef HOST_HAL_STREAM_H
+#define HOST_HAL_STREAM_H
+
+#include "Print.h"
+
+class Stream: public Print
+{
+    protected:
+        unsigned long timeout {1000};
+
+        int timedRead();
+
+    public:
+        virtual int available() = 0;
+        virtual int read() = 0;
+        virtual int peek() = 0;
+
+        void setTimeout(unsigned long value) { timeout = value; }
+        size_t readBytes(char * buffer, size_t length);
+        size_t readBytes(uint8_t * buffer, size_t length) { return readBytes((char *)buffer, length); }
+};
+
+#endif
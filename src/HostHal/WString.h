@@ -0,0 +1,40 @@
+#ifndef HOST_HAL_WSTRING_H
+#define HOST_HAL_WSTRING_H
+
+#include <stdlib.h>
+#include <string>
+#include "pgmspace.h"
+
+// small subset of arduino String
+class String
+{
+    private:
+        std::string value;
+
+    public:
+        String(const char * value = "") : value(value ? value : "") {}
+        String(const __FlashStringHelper * value) : value((const char *)value) {}
+        String(const std::string & value) : value(value) {}
+        explicit String(char value) : value(1, value) {}
+        explicit String(int value) : value(std::to_string(value)) {}
+        explicit String(unsigned int value) : value(std::to_string(value)) {}
+        explicit String(long value) : value(std::to_string(value)) {}
+        explicit String(unsigned long value) : value(std::to_string(value)) {}
+
+        const char * c_str() const { return value.c_str(); }
+        unsigned int length() const { return value.length(); }
+        char operator[](unsigned int index) const { return value[index]; }
+        bool operator==(const String & other) const { return value == other.value; }
+        bool operator!=(const String & other) const { return value != other.value; }
+        String & operator+=(const String & other) { value += other.value; return *this; }
+        String & operator+=(const char * other) { value += other; return *this; }
+        String & operator+=(char other) { value += other; return *this; }
+        friend String operator+(const String & left, const String & right) { return String(left.value + right.value); }
+        int indexOf(char c) const { auto pos = value.find(c); return pos == std::string::npos ? -1 : (int)pos; }
+        String substring(unsigned int from) const { return String(value.substr(from)); }
+        String substring(unsigned int from, unsigned int to) const { return String(value.substr(from, to - from)); }
+        long toInt() const { return atol(value.c_str()); }
+        bool reserve(unsigned int size) { value.reserve(size); return true; }
+};
+
+#endif
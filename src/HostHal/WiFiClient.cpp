@@ -0,0 +1,165 @@
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "ESP8266WiFi.h"
+
+ESP8266WiFiClass WiFi;
+
+bool IPAddress::fromString(const char * address)
+{
+    unsigned int a, b, c, d;
+    if (sscanf(address, "%u.%u.%u.%u", &a, &b, &c, &d) != 4 || a > 255 || b > 255 || c > 255 || d > 255) {
+        return false;
+    }
+    *this = IPAddress(a, b, c, d);
+    return true;
+}
+
+String IPAddress::toString() const
+{
+    char address[16] {0};
+    snprintf(address, sizeof(address), "%u.%u.%u.%u", bytes[0], bytes[1], bytes[2], bytes[3]);
+    return String(address);
+}
+
+int ESP8266WiFiClass::hostByName(const char * host, IPAddress & address)
+{
+    if (address.fromString(host)) {
+        return 1;
+    }
+    addrinfo hints {};
+    hints.ai_family = AF_INET;
+    addrinfo * result {nullptr};
+    if (getaddrinfo(host, nullptr, &hints, &result) != 0) {
+        return 0;
+    }
+    address = IPAddress((uint32_t)((sockaddr_in *)result->ai_addr)->sin_addr.s_addr);
+    freeaddrinfo(result);
+    return 1;
+}
+
+int WiFiClient::connect(IPAddress ip, uint16_t port)
+{
+    return connect(ip.toString().c_str(), port);
+}
+
+int WiFiClient::connect(const char * host, uint16_t port)
+{
+    stop();
+    char service[6] {0};
+    snprintf(service, sizeof(service), "%u", port);
+    addrinfo hints {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo * result {nullptr};
+    if (getaddrinfo(host, service, &hints, &result) != 0) {
+        return 0;
+    }
+    socket = ::socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+    if (socket < 0 || ::connect(socket, result->ai_addr, result->ai_addrlen) != 0) {
+        freeaddrinfo(result);
+        stop();
+        return 0;
+    }
+    freeaddrinfo(result);
+    int flag {1};
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+    return 1;
+}
+
+size_t WiFiClient::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+size_t WiFiClient::write(const uint8_t * buffer, size_t size)
+{
+    size_t written {0};
+    while (socket >= 0 && written < size) {
+        ssize_t count = ::send(socket, buffer + written, size - written, MSG_NOSIGNAL);
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            continue;
+        }
+        if (count <= 0) {
+            stop();
+            break;
+        }
+        written += count;
+    }
+    return written;
+}
+
+int WiFiClient::available()
+{
+    if (socket < 0) {
+        return 0;
+    }
+    int count {0};
+    ioctl(socket, FIONREAD, &count);
+    return count + (peeked >= 0 ? 1 : 0);
+}
+
+int WiFiClient::read()
+{
+    uint8_t c {0};
+    return read(&c, 1) == 1 ? c : -1;
+}
+
+int WiFiClient::read(uint8_t * buffer, size_t size)
+{
+    if (size == 0) {
+        return 0;
+    }
+    size_t count {0};
+    if (peeked >= 0) {
+        buffer[count++] = (uint8_t)peeked;
+        peeked = -1;
+    }
+    if (socket >= 0 && count < size) {
+        ssize_t received = ::recv(socket, buffer + count, size - count, 0);
+        if (received == 0) {
+            stop();
+        } else if (received > 0) {
+            count += received;
+        }
+    }
+    return count > 0 ? (int)count : -1;
+}
+
+int WiFiClient::peek()
+{
+    if (peeked < 0) {
+        peeked = read();
+    }
+    return peeked;
+}
+
+void WiFiClient::stop()
+{
+    if (socket >= 0) {
+        close(socket);
+    }
+    socket = -1;
+    peeked = -1;
+}
+
+uint8_t WiFiClient::connected()
+{
+    if (socket < 0) {
+        return 0;
+    }
+    uint8_t c {0};
+    ssize_t received = ::recv(socket, &c, 1, MSG_PEEK);
+    if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        stop();
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,14 @@
+#ifndef HOST_HAL_WIRE_H
+#define HOST_HAL_WIRE_H
+
+#include "Arduino.h"
+
+class TwoWire
+{
+    public:
+        void begin() {}
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef HOST_HAL_AVR_WDT_H
+#define HOST_HAL_AVR_WDT_H
+
+#define WDTO_15MS 0
+#define WDTO_1S 6
+#define WDTO_2S 7
+#define WDTO_4S 8
+#define WDTO_8S 9
+
+void wdt_enable(uint8_t timeout);
+void wdt_disable();
+void wdt_reset();
+
+#endif
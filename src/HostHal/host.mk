@@ -0,0 +1,51 @@
+# shared rules for building a sketch natively with the HostHal stand-ins
+#
+# sketch makefiles set:
+#   HOST_LIBS  - arduino-link libraries to compile (stand-ins are used for radio, wifi, spi)
+#   HOST_FLAGS - defines normally provided by platform.local.txt or CXXFLAGS_STD
+#   HOST_MAIN  - 0 when the sketch provides its own main
+#
+# radio frames are exchanged through $HOST_RADIO_DIR, mqtt goes to MQTT_SERVER_ADDRESS (default 127.0.0.1)
+
+HOST_HAL_DIR := $(realpath $(dir $(lastword $(MAKEFILE_LIST))))
+LINK_DIR := $(realpath $(HOST_HAL_DIR)/../../arduino-link)
+
+SKETCH ?= main.cpp
+TARGET_DIR ?= $(CURDIR)/build-host
+TARGET ?= $(TARGET_DIR)/$(notdir $(CURDIR))
+HOST_MAIN ?= 1
+HOST_LIBS ?=
+HOST_FLAGS ?=
+
+CXX ?= g++
+CXXFLAGS += -std=gnu++14 -g -O2 -Wall -Wno-unused-function -DHOST_BUILD=1 -DMQTT_SERVER_ADDRESS='"127.0.0.1"' $(HOST_FLAGS)
+CPPFLAGS += -I $(HOST_HAL_DIR) -I $(LINK_DIR) $(foreach lib,$(HOST_LIBS),-I $(LINK_DIR)/$(lib) -I $(LINK_DIR)/$(lib)/src)
+
+HAL_SOURCES := $(filter-out $(HOST_HAL_DIR)/HostMain.cpp,$(wildcard $(HOST_HAL_DIR)/*.cpp))
+ifeq ($(HOST_MAIN),1)
+HAL_SOURCES += $(HOST_HAL_DIR)/HostMain.cpp
+endif
+LIB_SOURCES := $(foreach lib,$(HOST_LIBS),$(wildcard $(LINK_DIR)/$(lib)/*.cpp $(LINK_DIR)/$(lib)/src/*.cpp))
+SOURCES := $(CURDIR)/$(SKETCH) $(HAL_SOURCES) $(LIB_SOURCES)
+OBJECTS := $(patsubst /%.cpp,$(TARGET_DIR)/obj/%.o,$(abspath $(SOURCES)))
+
+all: $(TARGET)
+
+$(TARGET): $(OBJECTS)
+	$(CXX) $(CXXFLAGS) -o $@ $^ $(LDFLAGS)
+
+# headers are tracked in .d files, the sketches and tests are mostly headers
+$(TARGET_DIR)/obj/%.o: /%.cpp
+	@ mkdir -p $(dir $@)
+	$(CXX) $(CPPFLAGS) $(CXXFLAGS) -MMD -MP -c -o $@ $<
+
+-include $(OBJECTS:.o=.d)
+
+# ESP.restart and ESP.deepSleep exit with 3, start the sketch again like the chip would
+run: $(TARGET)
+	while $(TARGET); [ $$? -eq 3 ]; do :; done
+
+clean:
+	rm -rf $(TARGET_DIR)
+
+.PHONY: all run clean
@@ -0,0 +1,39 @@
+#ifndef HOST_HAL_PGMSPACE_H
+#define HOST_HAL_PGMSPACE_H
+
+#include <string.h>
+#include <stdio.h>
+
+// flash and ram share one address space on the host
+
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+class __FlashStringHelper;
+#define FPSTR(s) (reinterpret_cast<const __FlashStringHelper *>(s))
+#define F(s) FPSTR(PSTR(s))
+
+#define pgm_read_byte(address) (*(const uint8_t *)(address))
+#define pgm_read_word(address) (*(const uint16_t *)(address))
+#define pgm_read_dword(address) (*(const uint32_t *)(address))
+#define pgm_read_float(address) (*(const float *)(address))
+#define pgm_read_ptr(address) (*(const void * const *)(address))
+
+#define memcpy_P memcpy
+#define memcmp_P memcmp
+#define strlen_P strlen
+#define strcpy_P strcpy
+#define strncpy_P strncpy
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define strcat_P strcat
+#define strstr_P strstr
+#define sprintf_P sprintf
+#define snprintf_P snprintf
+#define vsnprintf_P vsnprintf
+#define printf_P printf
+
+#endif
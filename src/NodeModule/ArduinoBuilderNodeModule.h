@@ -0,0 +1 @@
+// satisfy arduino-builder library detection for NodeModule
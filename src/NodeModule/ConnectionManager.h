@@ -0,0 +1,167 @@
+#ifndef NODE_MODULE_CONNECTION_MANAGER_H
+#define NODE_MODULE_CONNECTION_MANAGER_H
+
+#include <Arduino.h>
+#include "CommonModule/MacroHelper.h"
+
+namespace NodeModule
+{
+    enum class ConnectionState : uint8_t
+    {
+        WifiConnect,
+        WifiWait,
+        MqttConnect,
+        Connected
+    };
+
+    // brings wifi and mqtt up one step per tick instead of blocking in retry loops
+    // so the radio keeps being serviced during wifi or broker outages
+    //
+    // wifi is started with begin() and polled, access points are tried in turn
+    // a single mqtt connect attempt is the only blocking step, bound it with
+    // WiFiClient::setTimeout and MQTT_SOCKET_TIMEOUT
+    //
+    // Wifi is ESP8266WiFiClass, MqttClient is PubSubClient
+    template<typename Wifi, typename MqttClient, uint8_t MAX_ACCESS_POINTS = 2>
+    class ConnectionManager
+    {
+        public:
+            // called after every successful mqtt connect e.g. to subscribe again
+            typedef void (*ConnectCallback)(MqttClient & client);
+
+        private:
+            struct AccessPoint
+            {
+                const char * ssid {nullptr};
+                const char * password {nullptr};
+            };
+
+            Wifi & wifi;
+            MqttClient & client;
+            const char * clientName;
+            const char * channel;
+            ConnectCallback connectCallback {nullptr};
+            AccessPoint accessPoints[MAX_ACCESS_POINTS] {};
+            uint8_t accessPointCount {0};
+            uint8_t nextAccessPoint {0};
+            ConnectionState state {ConnectionState::WifiConnect};
+            unsigned long stateTime {0};
+            unsigned long nextAttempt {0};
+            uint8_t failures {0};
+
+            void setState(ConnectionState value, unsigned long now)
+            {
+                state = value;
+                stateTime = now;
+            }
+
+            unsigned long retryDelay() const
+            {
+                unsigned long wait = MQTT_RETRY_DELAY;
+                for (uint8_t i = 1; i < failures && wait < MAX_RETRY_DELAY; i++) {
+                    wait <<= 1;
+                }
+                return wait < MAX_RETRY_DELAY ? wait : MAX_RETRY_DELAY;
+            }
+
+        public:
+            static const uint16_t WIFI_CONNECT_TIMEOUT {10000};
+            static const uint16_t MQTT_RETRY_DELAY {1000};
+            static const uint16_t MAX_RETRY_DELAY {30000};
+
+            // channel is subscribed after connecting, may be nullptr
+            ConnectionManager(Wifi & wifi, MqttClient & client, const char * clientName, const char * channel = nullptr):
+                wifi(wifi), client(client), clientName(clientName), channel(channel)
+            {}
+
+            bool addAccessPoint(const char * ssid, const char * password)
+            {
+                if (accessPointCount >= MAX_ACCESS_POINTS) {
+                    return false;
+                }
+                accessPoints[accessPointCount++] = {ssid, password};
+                return true;
+            }
+
+            void setConnectCallback(ConnectCallback callback)
+            {
+                connectCallback = callback;
+            }
+
+            // returns true while mqtt is connected
+            bool tick(unsigned long now)
+            {
+                if (state != ConnectionState::WifiConnect && state != ConnectionState::WifiWait && !wifi.isConnected()) {
+                    warning("Wifi connection lost");
+                    setState(ConnectionState::WifiConnect, now);
+                    nextAttempt = now;
+                }
+
+                switch (state) {
+                    case ConnectionState::WifiConnect:
+                        if (wifi.isConnected()) {
+                            setState(ConnectionState::MqttConnect, now);
+                        } else if (accessPointCount > 0 && (long)(now - nextAttempt) >= 0) {
+                            const AccessPoint & accessPoint = accessPoints[nextAccessPoint];
+                            nextAccessPoint = (nextAccessPoint + 1) % accessPointCount;
+                            info("Connecting to wifi %s", accessPoint.ssid);
+                            wifi.begin(accessPoint.ssid, accessPoint.password);
+                            setState(ConnectionState::WifiWait, now);
+                        }
+                        return false;
+
+                    case ConnectionState::WifiWait:
+                        if (wifi.isConnected()) {
+                            info("Connected to wifi");
+                            setState(ConnectionState::MqttConnect, now);
+                            nextAttempt = now;
+                        } else if (now - stateTime >= WIFI_CONNECT_TIMEOUT) {
+                            error("Unable to connect to wifi");
+                            failures += failures < 0xFF ? 1 : 0;
+                            setState(ConnectionState::WifiConnect, now);
+                            // next access point right away, the same one again after a pause
+                            nextAttempt = nextAccessPoint == 0 ? now + retryDelay() : now;
+                        }
+                        return false;
+
+                    case ConnectionState::MqttConnect:
+                        if ((long)(now - nextAttempt) < 0) {
+                            return false;
+                        }
+                        if (!client.connect(clientName)) {
+                            failures += failures < 0xFF ? 1 : 0;
+                            nextAttempt = now + retryDelay();
+                            error("Failed to connect to mqtt server. Retry in %lu ms", nextAttempt - now);
+                            return false;
+                        }
+                        if (channel && !client.subscribe(channel)) {
+                            error("Failed to subscribe: %s", channel);
+                        }
+                        if (connectCallback) {
+                            connectCallback(client);
+                        }
+                        info("Connected to mqtt server");
+                        failures = 0;
+                        setState(ConnectionState::Connected, now);
+                        return true;
+
+                    case ConnectionState::Connected:
+                        if (!client.connected()) {
+                            warning("Mqtt connection lost");
+                            setState(ConnectionState::MqttConnect, now);
+                            nextAttempt = now;
+                            return false;
+                        }
+                        return true;
+                }
+                return false;
+            }
+
+            bool isConnected() const { return state == ConnectionState::Connected; }
+            ConnectionState getState() const { return state; }
+            // consecutive failed wifi or mqtt attempts
+            uint8_t getFailures() const { return failures; }
+    };
+}
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef NODE_MODULE_GATEWAY_METRICS_H
+#define NODE_MODULE_GATEWAY_METRICS_H
+
+#include <Arduino.h>
+#include "MemoryStats.h"
+
+namespace NodeModule
+{
+    // counters since boot and gauges set before publishing
+    // formatted as one compact line of key=value pairs:
+    //
+    // up    uptime s              rx    valid frames received
+    // bad   frames failed to decrypt or decode
+    // pub   publishes ok          pubf  publishes failed
+    // same  unchanged values not published
+    // q     queue depth           qmax  queue high water mark
+    // qd    queue drops           sf    sends to nodes failed
+    // cf    connect failures      lf    keep alive publish failures
+    // lmax  loop max us           lavg  loop average us
+    // heap  free heap bytes       sp    messages spilled to flash
+    // spd   spilled messages overwritten before replay
+    // dup   repeated frames dropped  ack   commands acknowledged by nodes
+    // stk   fewest free stack bytes
+    // nr    broker messages no node subscribed to
+    // ar    alias resets sent     poll  polls from sleeping nodes
+    // pl    payload slots used/high water/refused
+    // tf    topic filters used/high water/refused
+    // sn    sleeping nodes used/high water/replaced
+    // nf    node:send failures for the worst nodes, an upper bound for nodes that replaced another
+    template<uint8_t MAX_FAILING_NODES>
+    class GatewayMetrics
+    {
+        private:
+            struct NodeFailures
+            {
+                uint16_t node {0};
+                uint16_t count {0};
+            };
+
+            NodeFailures nodeFailures[MAX_FAILING_NODES] {};
+
+        public:
+            uint32_t framesReceived {0};
+            uint32_t framesInvalid {0};
+            uint32_t published {0};
+            uint32_t publishFailed {0};
+            uint32_t unchanged {0};
+            uint32_t sendFailed {0};
+            uint8_t queueSize {0};
+            uint8_t queueHighWater {0};
+            uint16_t queueDropped {0};
+            uint8_t connectFailures {0};
+            uint8_t keepAliveFailed {0};
+            unsigned long maxLoopTime {0};
+            unsigned long averageLoopTime {0};
+            uint32_t freeHeap {0};
+            uint16_t spillSize {0};
+            uint16_t spillDropped {0};
+            uint32_t duplicates {0};
+            uint32_t acked {0};
+            uint32_t freeStack {0};
+            uint32_t unroutable {0};
+            uint32_t aliasResets {0};
+            uint32_t polls {0};
+            PoolUsage payloads;
+            PoolUsage filters;
+            PoolUsage sleeping;
+
+            void sampleQueue(uint8_t size)
+            {
+                queueSize = size;
+                queueHighWater = size > queueHighWater ? size : queueHighWater;
+            }
+
+            // keeps the nodes with most failures, a new node replaces the one with the fewest (Space-Saving)
+            // and takes over its count + 1, so a node failing often is not pushed out by a burst of others
+            void nodeSendFailed(uint16_t node)
+            {
+                sendFailed++;
+                NodeFailures * fewest = &nodeFailures[0];
+                for (auto & entry: nodeFailures) {
+                    if (entry.count > 0 && entry.node == node) {
+                        entry.count += entry.count < 0xFFFF ? 1 : 0;
+                        return;
+                    }
+                    if (entry.count < fewest->count) {
+                        fewest = &entry;
+                    }
+                }
+                fewest->node = node;
+                fewest->count += fewest->count < 0xFFFF ? 1 : 0;
+            }
+
+            // returns formatted length, output is cut when the buffer is too small
+            uint16_t format(char * buffer, uint16_t length, unsigned long now) const
+            {
+                int written = snprintf(buffer, length,
+                    "up=%lu,rx=%lu,bad=%lu,pub=%lu,pubf=%lu,same=%lu,q=%u,qmax=%u,qd=%u,sf=%lu,cf=%u,lf=%u,lmax=%lu,lavg=%lu,heap=%lu,sp=%u,spd=%u,dup=%lu,ack=%lu,stk=%lu,nr=%lu,ar=%lu,poll=%lu,"
+                    "pl=%u/%u/%u,tf=%u/%u/%u,sn=%u/%u/%u,nf=",
+                    now / 1000, (unsigned long)framesReceived, (unsigned long)framesInvalid,
+                    (unsigned long)published, (unsigned long)publishFailed, (unsigned long)unchanged,
+                    queueSize, queueHighWater, queueDropped, (unsigned long)sendFailed,
+                    connectFailures, keepAliveFailed, maxLoopTime, averageLoopTime, (unsigned long)freeHeap, spillSize, spillDropped,
+                    (unsigned long)duplicates, (unsigned long)acked, (unsigned long)freeStack,
+                    (unsigned long)unroutable, (unsigned long)aliasResets, (unsigned long)polls,
+                    payloads.used, payloads.highWater, payloads.full,
+                    filters.used, filters.highWater, filters.full,
+                    sleeping.used, sleeping.highWater, sleeping.full);
+                bool first {true};
+                for (const auto & entry: nodeFailures) {
+                    if (written < 0 || written >= length) {
+                        break;
+                    }
+                    if (entry.count == 0) {
+                        continue;
+                    }
+                    written += snprintf(buffer + written, length - written, first ? "%u:%u" : "/%u:%u", entry.node, entry.count);
+                    first = false;
+                }
+                if (written < 0) {
+                    return 0;
+                }
+                return written < length ? written : length - 1;
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef NODE_MODULE_HTTP_BATCH_H
+#define NODE_MODULE_HTTP_BATCH_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // collects json objects into one array and posts it over a kept alive connection
+    // the array is sent when the next object does not fit or maxAge ms after the first was added
+    //
+    // Http is HTTPClient (ESP8266HTTPClient or src/HostHal), SIZE includes the brackets
+    template<typename Http, uint16_t SIZE>
+    class HttpBatch
+    {
+        private:
+            Http & http;
+            const char * url;
+            const uint32_t maxAge;
+            char buffer[SIZE] {'['};
+            uint16_t length {1};
+            uint8_t count {0};
+            unsigned long firstAdded {0};
+            uint16_t dropped {0};
+
+        public:
+            HttpBatch(Http & http, const char * url, uint32_t maxAge):
+                http(http), url(url), maxAge(maxAge)
+            {
+                http.setReuse(true);
+            }
+
+            // element is a serialized json object, false if it can not be queued
+            bool add(const char * element, uint16_t size)
+            {
+                // separator and closing bracket
+                if (length + size + 2 > SIZE) {
+                    flush();
+                }
+                if (length + size + 2 > SIZE) {
+                    dropped++;
+                    return false;
+                }
+                if (count > 0) {
+                    buffer[length++] = ',';
+                } else {
+                    firstAdded = millis();
+                }
+                memcpy(buffer + length, element, size);
+                length += size;
+                count++;
+                return true;
+            }
+
+            bool isDue(unsigned long now) const
+            {
+                return count > 0 && now - firstAdded >= maxAge;
+            }
+
+            // posts the queued objects, they are dropped when the server does not accept them
+            bool flush()
+            {
+                if (count == 0) {
+                    return true;
+                }
+                buffer[length] = ']';
+                bool sent = http.begin(url);
+                if (sent) {
+                    http.addHeader("Content-Type", "application/json");
+                    sent = http.POST((uint8_t *)buffer, length + 1) == 200;
+                    // keeps the connection open because of setReuse
+                    http.end();
+                }
+                if (!sent) {
+                    dropped += count;
+                }
+                length = 1;
+                count = 0;
+                return sent;
+            }
+
+            uint8_t size() const { return count; }
+            uint16_t getDropped() const { return dropped; }
+    };
+}
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef NODE_MODULE_IDLE_BACKOFF_H
+#define NODE_MODULE_IDLE_BACKOFF_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // sleep time for a polling loop: nothing while there is work,
+    // growing by one ms per idle loop up to MAX_SLEEP
+    template<uint8_t MAX_SLEEP>
+    class IdleBackoff
+    {
+        private:
+            uint8_t sleep {0};
+
+        public:
+            // returns ms to sleep after a loop that did or did not find work
+            uint8_t next(bool busy)
+            {
+                if (busy) {
+                    sleep = 0;
+                } else if (sleep < MAX_SLEEP) {
+                    sleep++;
+                }
+                return sleep;
+            }
+    };
+}
+
+#endif
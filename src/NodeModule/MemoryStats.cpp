@@ -0,0 +1,65 @@
+#include "MemoryStats.h"
+
+namespace NodeModule
+{
+#if defined(__AVR__)
+    extern "C" {
+        extern uint8_t __heap_start;
+        extern void * __brkval;
+    }
+
+    static const uint8_t PAINT {0xC5};
+    // left unpainted below the frame of paintStack
+    static const uint8_t PAINT_MARGIN {16};
+    static bool painted {false};
+
+    static uint8_t * heapEnd()
+    {
+        return __brkval ? (uint8_t *)__brkval : &__heap_start;
+    }
+
+    // first byte the stack has written to
+    static const uint8_t * stackLowest()
+    {
+        const uint8_t * position = heapEnd();
+        while (position <= (const uint8_t *)RAMEND && *position == PAINT) {
+            position++;
+        }
+        return position;
+    }
+
+    void paintStack()
+    {
+        uint8_t * position = heapEnd();
+        uint8_t * top = (uint8_t *)SP - PAINT_MARGIN;
+        while (position < top) {
+            *position++ = PAINT;
+        }
+        painted = true;
+    }
+
+    uint16_t stackHighWater()
+    {
+        return painted ? (const uint8_t *)RAMEND - stackLowest() + 1 : 0;
+    }
+
+    uint16_t stackMargin()
+    {
+        return painted ? stackLowest() - heapEnd() : 0;
+    }
+#else
+    void paintStack()
+    {
+    }
+
+    uint16_t stackHighWater()
+    {
+        return 0;
+    }
+
+    uint16_t stackMargin()
+    {
+        return 0;
+    }
+#endif
+}
@@ -0,0 +1,59 @@
+#ifndef NODE_MODULE_MEMORY_STATS_H
+#define NODE_MODULE_MEMORY_STATS_H
+
+#include <Arduino.h>
+#include "MqttModule/MqttConfig.h"
+
+namespace NodeModule
+{
+    // occupancy of a static container for sizing it from field data
+    struct PoolUsage
+    {
+        uint16_t used {0};
+        uint16_t highWater {0};
+        // adds refused or entries replaced because the container was full
+        uint16_t full {0};
+
+        void sample(uint16_t size)
+        {
+            used = size;
+            highWater = size > highWater ? size : highWater;
+        }
+
+        void rejected()
+        {
+            full += full < 0xFFFF ? 1 : 0;
+        }
+    };
+
+    // avr only, elsewhere these return 0
+    //
+    // paintStack fills the free ram between heap and stack with a pattern, call it first thing in main
+    // the pattern the stack has not overwritten since shows how close it came to the heap
+    // heap growth after painting is taken from the margin as well
+    void paintStack();
+
+    // deepest stack seen in bytes
+    uint16_t stackHighWater();
+
+    // fewest bytes left between heap and stack
+    uint16_t stackMargin();
+
+    // keep alive stats of the sketches with their own mqtt connection, value i to {name}/stats/{keys[i]}
+    // the topics the nrf24 node publishes through the gateway
+    template<typename Client>
+    bool publishStats(Client & client, const char * name, const char * const * keys, const uint32_t * values, uint8_t count)
+    {
+        char topic[MQTT_MAX_LEN_TOPIC] {0};
+        char value[11] {0};
+        bool published {true};
+        for (uint8_t i = 0; i < count; i++) {
+            snprintf(topic, sizeof(topic), "%s/stats/%s", name, keys[i]);
+            snprintf(value, sizeof(value), "%lu", (unsigned long)values[i]);
+            published = client.publish(topic, value) && published;
+        }
+        return published;
+    }
+}
+
+#endif
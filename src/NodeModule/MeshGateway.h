@@ -0,0 +1,344 @@
+#ifndef NODE_MODULE_MESH_GATEWAY_H
+#define NODE_MODULE_MESH_GATEWAY_H
+
+#include <Arduino.h>
+#include <RF24Network.h>
+#include "CommonModule/MacroHelper.h"
+#include "MqttModule/MqttMessage.h"
+#include "MessageScheduler.h"
+#include "PayloadPool.h"
+#include "TopicIndex.h"
+#include "MessageCodec.h"
+#include "PeerSet.h"
+#include "TopicAliases.h"
+#include "SequenceWindow.h"
+#include "SleepingNodes.h"
+#include "RadioRoutes.h"
+#include "PublishCache.h"
+#include "GatewayMetrics.h"
+
+namespace NodeModule
+{
+    using MqttModule::MqttMessage;
+    using MqttModule::MessageType;
+
+    // routing of nrf24l01-mqtt-gateway between the node meshes and the broker
+    // shared by the sketch and mesh-simulator so the simulated gateway runs the same code
+    //
+    // Host provides the radios, the broker connection and the time:
+    //   Transport & radio(uint8_t index)     EncryptedMesh of the radio, index as passed to receive
+    //   uint16_t nodeId(uint8_t index, uint16_t address)
+    //   bool isConnected()
+    //   bool publish(const char * topic, const char * message, bool retain)
+    //   bool subscribe(const char * filter)
+    //   unsigned long now()                  ms
+    // Spill is SpillLog or anything with append, peek, pop, size and getDropped
+    // Limits holds the table sizes and retry settings as static const members, see nrf24l01-mqtt-gateway/main.cpp
+    template<typename Host, typename Transport, typename Spill, typename Limits>
+    class MeshGateway
+    {
+        private:
+            // queue holds payload slots, message is stored once for all subscribed nodes
+            // the sequence number stays the same for retries so nodes can drop repeated frames
+            struct QueuedMessage
+            {
+                uint8_t slot {0};
+                uint16_t sequence {0};
+            };
+            using MessageQueue = MessageScheduler<QueuedMessage, Limits::MAX_DESTINATIONS, Limits::MAX_PER_DESTINATION>;
+
+            // the scheduler release callback has no context, there is one gateway at a time
+            static MeshGateway * active;
+
+            Host & host;
+            Spill & spill;
+            // commands the node has to acknowledge, empty disables acks
+            const char * ackTopicSuffix;
+            // node subscriptions, topics may contain + and # wildcards
+            TopicIndex<Limits::MAX_FILTERS, Limits::MAX_NODES_PER_FILTER> subscribers;
+            // nodes that subscribed with compact frames receive compact frames as well
+            PeerSet<Limits::MAX_NODE_ID> compactNodes;
+            // topic aliases defined by nodes and by the gateway for each node
+            TopicAliasTable<Limits::MAX_INBOUND_ALIASES> inboundAliases;
+            TopicAliasTable<Limits::MAX_OUTBOUND_ALIASES> outboundAliases;
+            PayloadPool<MqttMessage, Limits::PAYLOAD_SLOTS> payloads;
+            MessageQueue messageQueue;
+            uint16_t nextSequence {0};
+            // last sequence numbers received from each node
+            SequenceWindows<Limits::MAX_SEQUENCE_PEERS> receivedSequences;
+            // queues of sleeping nodes are held as mailboxes until the node polls
+            SleepingNodes<Limits::MAX_SLEEPING_NODES> sleepingNodes;
+            // radio a node was last heard on, messages to it are sent there
+            RadioRoutes<Limits::MAX_NODE_ID, Limits::RADIOS> radioRoutes;
+            PublishCache<Limits::MAX_PUBLISHED_TOPICS> publishCache;
+            GatewayMetrics<Limits::MAX_FAILING_NODES> metrics;
+
+            // commands are acknowledged by the node, a retry after a lost ack is dropped by the node
+            bool requiresAck(const char * topic) const
+            {
+                size_t length = strlen(topic);
+                size_t suffixLength = strlen(ackTopicSuffix);
+                return suffixLength > 0 && length >= suffixLength && strcmp(topic + length - suffixLength, ackTopicSuffix) == 0;
+            }
+
+            bool sendToCompactNode(Transport & transport, const MqttMessage & message, uint16_t node, const FrameSequence & sequence)
+            {
+                uint8_t alias = outboundAliases.getAlias(node, message.topic);
+                bool isDefined = alias > 0;
+                if (!isDefined) {
+                    // the node keeps MAX_NODE_ALIASES, more would push out definitions it still needs
+                    alias = outboundAliases.assign(node, message.topic, MAX_NODE_ALIASES);
+                }
+                uint8_t assignedAlias = alias;
+                bool sent = sendAliasedMessage(transport, alias, isDefined, message, (uint8_t)MessageType::Publish, node, sequence);
+                if (!isDefined && (!sent || alias == 0)) {
+                    outboundAliases.remove(node, assignedAlias);
+                }
+                return sent;
+            }
+
+            // messages go behind the spilled ones while any are waiting so the broker sees them in order
+            // values equal to the last one published are dropped until the heartbeat of their topic class
+            void publishOrSpill(const MqttMessage & message)
+            {
+                PublishPolicy policy = publishCache.getPolicy(message.topic);
+                if (!publishCache.isDue(message, policy, host.now())) {
+                    debug("Unchanged topic: %s", message.topic);
+                    return;
+                }
+                if (spill.size() == 0 && host.isConnected()) {
+                    if (host.publish(message.topic, message.message, policy.retain)) {
+                        metrics.published++;
+                        publishCache.published(message, policy, host.now());
+                        return;
+                    }
+                    metrics.publishFailed++;
+                    error("Failed to send message");
+                }
+                if (!spill.append(message)) {
+                    error("Failed to spill message");
+                }
+            }
+
+            // states of several pins in one frame are published as separate topics
+            void publishBatch(const MqttMessage & frame)
+            {
+                BatchReader reader(frame);
+                MqttMessage message;
+                while (reader.next(message)) {
+                    publishOrSpill(message);
+                    debug("Publish topic: %s Message: %s", message.topic, message.message);
+                }
+            }
+
+            void subscribe(const MqttMessage & message, uint16_t fromNode, bool isCompact)
+            {
+                if (isCompact) {
+                    compactNodes.add(fromNode);
+                }
+                bool subscribedLocally = subscribers.hasSubscribed(message.topic);
+                if (!subscribers.add(message.topic, fromNode)) {
+                    metrics.filters.rejected();
+                    error("Failed to subscribe: %s nodeI: %d", message.topic, fromNode);
+                } else if (!subscribedLocally) {
+                    //subscribe locally
+                    host.subscribe(message.topic);
+                    info("Subscribed for: %s nodeI: %d", message.topic, fromNode);
+                }
+                metrics.filters.sample(subscribers.size());
+            }
+
+        public:
+            MeshGateway(Host & host, Spill & spill, const PublishPolicy * policies, uint8_t policyCount, const char * ackTopicSuffix):
+                host(host),
+                spill(spill),
+                ackTopicSuffix(ackTopicSuffix),
+                messageQueue(Limits::RETRY_INITIAL_DELAY, Limits::RETRY_MAX_DELAY, Limits::MAX_MESSAGE_FAILURES, [](QueuedMessage & item) {
+                    active->payloads.release(item.slot);
+                }),
+                publishCache(policies, policyCount)
+            {
+                active = this;
+            }
+
+            // nodes would take the numbers of the previous run for repeated frames, start from a random one
+            void setSequence(uint16_t sequence)
+            {
+                nextSequence = sequence;
+            }
+
+            // broker message, queued once for every node subscribed to the topic
+            void onMqttMessage(const char * topic, const uint8_t * payload, uint16_t len)
+            {
+                debug("Mqtt message received for: %s", topic);
+                uint16_t nodes[Limits::MAX_MATCHED_NODES] {0};
+                uint8_t nodeCount = subscribers.getSubscribedNodes(topic, nodes, COUNT_OF(nodes));
+                if (!(nodeCount > 0)) {
+                    metrics.unroutable++;
+                    warning("No nodes subscribed for %s", topic);
+                    return;
+                }
+                uint8_t slot = payloads.acquire();
+                if (slot == payloads.NO_SLOT) {
+                    metrics.payloads.rejected();
+                    error("Failed to add to queue. No free payload slots");
+                    return;
+                }
+                metrics.payloads.sample(payloads.used());
+                MqttMessage & message = payloads.get(slot);
+                strncpy(message.topic, topic, COUNT_OF(message.topic) - 1);
+                memcpy(message.message, payload, MIN(len, COUNT_OF(message.message) - 1));
+                QueuedMessage item {slot, nextSequence++};
+                for (uint8_t i = 0; i < nodeCount; i++) {
+                    payloads.retain(slot);
+                    if (!messageQueue.add(item, nodes[i], host.now())) {
+                        payloads.release(slot);
+                        error("Failed to add to queue");
+                    }
+                }
+                payloads.release(slot);
+            }
+
+            // receives one frame, index is the radio it is waiting on, replies go back on the same radio
+            void receive(uint8_t index)
+            {
+                MqttMessage message;
+                RF24NetworkHeader header;
+                Transport & transport = host.radio(index);
+
+                uint8_t alias {0};
+                FrameSequence sequence;
+                FrameType frameType = receiveFrame(transport, message, alias, sequence, (uint8_t)MessageType::All, header);
+                if (frameType == FrameType::Invalid) {
+                    metrics.framesInvalid++;
+                    error("Failed to receive packets");
+                    return;
+                }
+                metrics.framesReceived++;
+
+                uint8_t type = fromCompactType(header.type);
+                uint16_t fromNode = host.nodeId(index, header.from_node);
+                if (radioRoutes.heard(fromNode, index)) {
+                    warning("Node: %d moved to radio %d", fromNode, index);
+                }
+                if (frameType == FrameType::AliasReset) {
+                    outboundAliases.clear(fromNode);
+                } else if (frameType == FrameType::Restart) {
+                    // node started again, its alias tables are empty and its sequence starts again
+                    // only on RESTART, a subscribe alone would let repeated frames through
+                    outboundAliases.clear(fromNode);
+                    inboundAliases.clear(fromNode);
+                    receivedSequences.reset(fromNode);
+                    sleepingNodes.remove(fromNode);
+                    info("Node: %d restarted", fromNode);
+                } else if (frameType == FrameType::Ack) {
+                    bool acked = messageQueue.acknowledge(fromNode, [&sequence](const QueuedMessage & item) {
+                        return item.sequence == sequence.number;
+                    });
+                    metrics.acked += acked ? 1 : 0;
+                } else if (frameType == FrameType::Poll) {
+                    // sleeping node listens now, its mailbox is sent by sendMessages
+                    metrics.polls++;
+                    sleepingNodes.wake(fromNode, host.now(), getPollWindow(message));
+                    messageQueue.resume(fromNode, host.now());
+                } else if (frameType == FrameType::Batch) {
+                    if (sequence.present && !receivedSequences.accept(fromNode, sequence.number)) {
+                        metrics.duplicates++;
+                    } else {
+                        publishBatch(message);
+                    }
+                } else if (!inboundAliases.resolve(frameType, fromNode, alias, message)) {
+                    metrics.aliasResets++;
+                    warning("Unknown alias %d from node: %d", alias, fromNode);
+                    sendAliasReset(transport, (uint8_t)MessageType::Publish, fromNode);
+                } else if (sequence.present && !receivedSequences.accept(fromNode, sequence.number)) {
+                    metrics.duplicates++;
+                    debug("Duplicate %u from node: %d", sequence.number, fromNode);
+                } else if (type == (uint8_t)MessageType::Subscribe) {
+                    subscribe(message, fromNode, isCompactType(header.type));
+                } else if (type == (uint8_t)MessageType::Publish) {
+                    publishOrSpill(message);
+                    debug("Publish topic: %s Message: %s", message.topic, message.message);
+                }
+            }
+
+            // sends queued messages to awake nodes, maxAttempts bounds the time of one run
+            uint8_t sendMessages(uint8_t maxAttempts)
+            {
+                uint8_t sent = messageQueue.process([this](QueuedMessage & item, uint16_t node) {
+                    MqttMessage & message = payloads.get(item.slot);
+                    Transport & transport = host.radio(radioRoutes.get(node));
+                    bool isCompact = compactNodes.contains(node);
+                    FrameSequence sequence {item.sequence, true, isCompact && requiresAck(message.topic)};
+                    bool sent = isCompact
+                        ? sendToCompactNode(transport, message, node, sequence)
+                        : transport.send(&message, sizeof(message), (uint8_t)MessageType::Publish, node);
+                    if (!sent) {
+                        metrics.nodeSendFailed(node);
+                        warning("Failed to send data to node: %d", node);
+                        return SendResult::Failed;
+                    }
+                    // kept for a retry until the ack arrives, see receive
+                    return sequence.ackRequested ? SendResult::AwaitingAck : SendResult::Delivered;
+                }, host.now(), maxAttempts, [this](uint16_t node) {
+                    return sleepingNodes.isAwake(node, host.now());
+                });
+                metrics.sampleQueue(messageQueue.size());
+                return sent;
+            }
+
+            // broker forgets subscriptions with the connection, subscribe again for every node filter
+            void subscribeAll()
+            {
+                for (uint16_t i = 0; i < subscribers.size(); i++) {
+                    if (!host.subscribe(subscribers.getFilter(i))) {
+                        error("Failed to subscribe: %s", subscribers.getFilter(i));
+                    }
+                }
+            }
+
+            // publishes the oldest spilled message, returns false when none is left or publish failed
+            // stops at the first failure to keep the order
+            bool replayNext()
+            {
+                MqttMessage message;
+                if (!host.isConnected() || !spill.peek(message)) {
+                    return false;
+                }
+                PublishPolicy policy = publishCache.getPolicy(message.topic);
+                if (!host.publish(message.topic, message.message, policy.retain)) {
+                    metrics.publishFailed++;
+                    warning("Failed to replay message, spilled %d", spill.size());
+                    return false;
+                }
+                metrics.published++;
+                publishCache.published(message, policy, host.now());
+                spill.pop();
+                return true;
+            }
+
+            // gauges of the gateway tables, the host sets its own before publishing
+            GatewayMetrics<Limits::MAX_FAILING_NODES> & sampleMetrics()
+            {
+                metrics.queueDropped = messageQueue.getDropped();
+                metrics.spillSize = spill.size();
+                metrics.spillDropped = spill.getDropped();
+                metrics.payloads.sample(payloads.used());
+                metrics.sleeping.sample(sleepingNodes.size());
+                metrics.sleeping.full = sleepingNodes.getReplaced();
+                metrics.unchanged = publishCache.getSuppressed();
+                return metrics;
+            }
+
+            const GatewayMetrics<Limits::MAX_FAILING_NODES> & getMetrics() const { return metrics; }
+            const RadioRoutes<Limits::MAX_NODE_ID, Limits::RADIOS> & getRadioRoutes() const { return radioRoutes; }
+            uint8_t getQueueSize() const { return messageQueue.size(); }
+            uint16_t getQueueDropped() const { return messageQueue.getDropped(); }
+            uint8_t getPayloadsUsed() const { return payloads.used(); }
+    };
+
+    template<typename Host, typename Transport, typename Spill, typename Limits>
+    MeshGateway<Host, Transport, Spill, Limits> * MeshGateway<Host, Transport, Spill, Limits>::active {nullptr};
+}
+
+#endif
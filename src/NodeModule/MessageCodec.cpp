@@ -0,0 +1,250 @@
+#include "MessageCodec.h"
+
+namespace NodeModule
+{
+    static uint8_t stringLength(const char * value, uint8_t maxLength)
+    {
+        uint8_t length {0};
+        while (length < maxLength && value[length] != '\0') {
+            length++;
+        }
+        return length;
+    }
+
+    static uint16_t encodeString(const char * value, uint8_t maxLength, uint8_t * buffer, uint16_t length)
+    {
+        // keep room for the terminating 0 on the receiving side
+        uint8_t valueLength = stringLength(value, maxLength - 1);
+        if (valueLength + 1 > length) {
+            return 0;
+        }
+        buffer[0] = valueLength;
+        memcpy(buffer + 1, value, valueLength);
+        return valueLength + 1;
+    }
+
+    static uint16_t decodeString(const uint8_t * buffer, uint16_t length, char * value, uint8_t maxLength)
+    {
+        if (length < 1 || buffer[0] >= maxLength || buffer[0] + 1 > length) {
+            return 0;
+        }
+        memcpy(value, buffer + 1, buffer[0]);
+        value[buffer[0]] = '\0';
+        return buffer[0] + 1;
+    }
+
+    uint16_t encodeMessage(const MqttMessage & message, uint8_t * buffer, uint16_t length)
+    {
+        uint16_t topicLength = encodeString(message.topic, sizeof(message.topic), buffer, length);
+        if (topicLength == 0) {
+            return 0;
+        }
+        uint16_t messageLength = encodeString(message.message, sizeof(message.message), buffer + topicLength, length - topicLength);
+        return messageLength > 0 ? topicLength + messageLength : 0;
+    }
+
+    uint16_t encodeAliasDefine(uint8_t alias, const MqttMessage & message, uint8_t * buffer, uint16_t length)
+    {
+        if (length < 2) {
+            return 0;
+        }
+        buffer[0] = ALIAS_DEFINE;
+        buffer[1] = alias;
+        uint16_t messageLength = encodeMessage(message, buffer + 2, length - 2);
+        return messageLength > 0 ? messageLength + 2 : 0;
+    }
+
+    uint16_t encodeAliasUse(uint8_t alias, const MqttMessage & message, uint8_t * buffer, uint16_t length)
+    {
+        if (length < 2) {
+            return 0;
+        }
+        buffer[0] = ALIAS_USE;
+        buffer[1] = alias;
+        uint16_t messageLength = encodeString(message.message, sizeof(message.message), buffer + 2, length - 2);
+        return messageLength > 0 ? messageLength + 2 : 0;
+    }
+
+    bool MessageBatch::add(const MqttMessage & message)
+    {
+        uint8_t topicLength = stringLength(message.topic, sizeof(message.topic) - 1);
+        uint8_t messageLength = stringLength(message.message, sizeof(message.message) - 1);
+        uint8_t shared {0};
+        while (shared < topicLength && previous[shared] == message.topic[shared]) {
+            shared++;
+        }
+        uint16_t entryLength = 3 + topicLength - shared + messageLength;
+        if (buffer[1] == 0xFF || length + entryLength > MAX_LEN_BATCH) {
+            return false;
+        }
+        uint8_t * entry = buffer + length;
+        entry[0] = shared;
+        entry[1] = topicLength - shared;
+        memcpy(entry + 2, message.topic + shared, topicLength - shared);
+        entry[2 + topicLength - shared] = messageLength;
+        memcpy(entry + 3 + topicLength - shared, message.message, messageLength);
+        length += entryLength;
+        buffer[1]++;
+        memcpy(previous, message.topic, topicLength);
+        previous[topicLength] = '\0';
+        return true;
+    }
+
+    void MessageBatch::clear()
+    {
+        buffer[1] = 0;
+        length = 2;
+        previous[0] = '\0';
+    }
+
+    BatchReader::BatchReader(const uint8_t * buffer, uint16_t length):
+        buffer(buffer), length(length)
+    {
+        remaining = length >= 2 && buffer[0] == BATCH ? buffer[1] : 0;
+    }
+
+    BatchReader::BatchReader(const MqttMessage & frame):
+        BatchReader(reinterpret_cast<const uint8_t *>(&frame), sizeof(frame))
+    {}
+
+    bool BatchReader::next(MqttMessage & message)
+    {
+        if (remaining == 0 || position + 2 > length) {
+            return false;
+        }
+        uint8_t shared = buffer[position];
+        uint8_t rest = buffer[position + 1];
+        if (shared > strlen(previous) || shared + rest >= (int)sizeof(message.topic) || position + 2 + rest >= length) {
+            remaining = 0;
+            return false;
+        }
+        message = {};
+        memcpy(message.topic, previous, shared);
+        memcpy(message.topic + shared, buffer + position + 2, rest);
+        position += 2 + rest;
+        uint16_t messageLength = decodeString(buffer + position, length - position, message.message, sizeof(message.message));
+        if (messageLength == 0) {
+            remaining = 0;
+            return false;
+        }
+        position += messageLength;
+        remaining--;
+        strcpy(previous, message.topic);
+        return true;
+    }
+
+    uint16_t encodePoll(uint16_t window, uint8_t * buffer, uint16_t length)
+    {
+        if (length < 3) {
+            return 0;
+        }
+        buffer[0] = POLL;
+        buffer[1] = window & 0xFF;
+        buffer[2] = window >> 8;
+        return 3;
+    }
+
+    uint16_t getPollWindow(const MqttMessage & frame)
+    {
+        const uint8_t * buffer = reinterpret_cast<const uint8_t *>(&frame);
+        return buffer[0] == POLL ? buffer[1] | (uint16_t)buffer[2] << 8 : 0;
+    }
+
+    uint16_t encodeSequence(const FrameSequence & sequence, uint8_t * buffer, uint16_t length)
+    {
+        if (!sequence.present || length < SEQUENCE_HEADER_SIZE) {
+            return 0;
+        }
+        buffer[0] = sequence.ackRequested ? SEQUENCED_ACK : SEQUENCED;
+        buffer[1] = sequence.number & 0xFF;
+        buffer[2] = sequence.number >> 8;
+        return SEQUENCE_HEADER_SIZE;
+    }
+
+    uint16_t encodeAck(uint16_t sequence, uint8_t * buffer, uint16_t length)
+    {
+        if (length < SEQUENCE_HEADER_SIZE) {
+            return 0;
+        }
+        buffer[0] = ACK;
+        buffer[1] = sequence & 0xFF;
+        buffer[2] = sequence >> 8;
+        return SEQUENCE_HEADER_SIZE;
+    }
+
+    bool decodeMessage(const uint8_t * buffer, uint16_t length, MqttMessage & message)
+    {
+        message = {};
+        uint16_t topicLength = decodeString(buffer, length, message.topic, sizeof(message.topic));
+        return topicLength > 0
+            && decodeString(buffer + topicLength, length - topicLength, message.message, sizeof(message.message)) > 0;
+    }
+
+    FrameType decodeFrame(const uint8_t * buffer, uint16_t length, MqttMessage & message, uint8_t & alias, FrameSequence & sequence)
+    {
+        sequence = {};
+        if (length < 1) {
+            return FrameType::Invalid;
+        }
+        switch (buffer[0]) {
+            case POLL:
+                if (length < 3) {
+                    return FrameType::Invalid;
+                }
+                message = {};
+                memcpy(&message, buffer, 3);
+                return FrameType::Poll;
+            case BATCH:
+                if (length < 2) {
+                    return FrameType::Invalid;
+                }
+                message = {};
+                memcpy(&message, buffer, length < sizeof(message) ? length : sizeof(message));
+                return FrameType::Batch;
+            case ACK:
+            case SEQUENCED:
+            case SEQUENCED_ACK:
+                if (length < SEQUENCE_HEADER_SIZE) {
+                    return FrameType::Invalid;
+                }
+                sequence.number = buffer[1] | (uint16_t)buffer[2] << 8;
+                if (buffer[0] == ACK) {
+                    return FrameType::Ack;
+                }
+                sequence.present = true;
+                sequence.ackRequested = buffer[0] == SEQUENCED_ACK;
+                // sequence and ack frames are not nested
+                if (length == SEQUENCE_HEADER_SIZE || (buffer[SEQUENCE_HEADER_SIZE] >= ACK && buffer[SEQUENCE_HEADER_SIZE] <= SEQUENCED)) {
+                    return FrameType::Invalid;
+                }
+                return decodeFrame(buffer + SEQUENCE_HEADER_SIZE, length - SEQUENCE_HEADER_SIZE, message, alias);
+            case ALIAS_RESET:
+                return FrameType::AliasReset;
+            case RESTART:
+                return FrameType::Restart;
+            case ALIAS_DEFINE:
+                if (length < 2 || buffer[1] == 0) {
+                    return FrameType::Invalid;
+                }
+                alias = buffer[1];
+                return decodeMessage(buffer + 2, length - 2, message) ? FrameType::AliasDefine : FrameType::Invalid;
+            case ALIAS_USE:
+                if (length < 2 || buffer[1] == 0) {
+                    return FrameType::Invalid;
+                }
+                alias = buffer[1];
+                message = {};
+                return decodeString(buffer + 2, length - 2, message.message, sizeof(message.message)) > 0
+                    ? FrameType::AliasUse
+                    : FrameType::Invalid;
+            default:
+                return decodeMessage(buffer, length, message) ? FrameType::Message : FrameType::Invalid;
+        }
+    }
+
+    FrameType decodeFrame(const uint8_t * buffer, uint16_t length, MqttMessage & message, uint8_t & alias)
+    {
+        FrameSequence sequence;
+        return decodeFrame(buffer, length, message, alias, sequence);
+    }
+}
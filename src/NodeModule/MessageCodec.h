@@ -0,0 +1,216 @@
+#ifndef NODE_MODULE_MESSAGE_CODEC_H
+#define NODE_MODULE_MESSAGE_CODEC_H
+
+#include <Arduino.h>
+#include "MqttModule/MqttMessage.h"
+
+namespace NodeModule
+{
+    using MqttModule::MqttMessage;
+
+    // compact frame: [topic length][topic][message length][message]
+    // only used bytes are sent instead of the whole MqttMessage
+    //
+    // first byte values above the topic length are used for topic aliases:
+    // [ALIAS_DEFINE][alias][topic length][topic][message length][message]
+    // [ALIAS_USE][alias][message length][message]
+    // [ALIAS_RESET] receiver does not know the alias, sender should define its aliases again
+    // frames never exceed the size of MqttMessage, a definition that does not fit is sent without alias
+    //
+    // any of the frames above can carry the sender sequence number so the receiver can drop duplicates:
+    // [SEQUENCED][sequence 2][frame]
+    // [SEQUENCED_ACK][sequence 2][frame] receiver answers with [ACK][sequence 2]
+    // a frame that does not fit with the sequence is sent without it
+    //
+    // several messages in one frame, topics share their start with the previous topic:
+    // [BATCH][count]{[shared length][rest length][rest of topic][message length][message]}
+    //
+    // a sleeping node woke up and listens for window ms: [POLL][window 2]
+    //
+    // the sender started again, the receiver drops its aliases and sequence numbers: [RESTART]
+    const uint16_t MAX_LEN_ENCODED_MESSAGE {MQTT_MAX_LEN_TOPIC + MQTT_MAX_LEN_MESSAGE};
+    const uint8_t ALIAS_DEFINE {0xFF};
+    const uint8_t ALIAS_USE {0xFE};
+    const uint8_t ALIAS_RESET {0xFD};
+    const uint8_t SEQUENCED {0xFC};
+    const uint8_t SEQUENCED_ACK {0xFB};
+    const uint8_t ACK {0xFA};
+    const uint8_t BATCH {0xF9};
+    const uint8_t POLL {0xF8};
+    const uint8_t RESTART {0xF7};
+    const uint8_t SEQUENCE_HEADER_SIZE {3};
+
+    static_assert(MQTT_MAX_LEN_TOPIC < RESTART, "Topic length collides with alias, sequence, batch, poll and restart frames");
+
+    enum class FrameType : uint8_t
+    {
+        Invalid,
+        Message,
+        AliasDefine,
+        AliasUse,
+        AliasReset,
+        Ack,
+        Batch,
+        Poll,
+        Restart
+    };
+
+    struct FrameSequence
+    {
+        uint16_t number {0};
+        bool present {false};
+        bool ackRequested {false};
+    };
+
+    // compact frames use their own header types so that full size frames
+    // from nodes that do not support them can still be received
+    const uint8_t COMPACT_TYPE_OFFSET {32};
+
+    inline uint8_t toCompactType(uint8_t type) { return type + COMPACT_TYPE_OFFSET; }
+    inline bool isCompactType(uint8_t type) { return type >= COMPACT_TYPE_OFFSET && type < COMPACT_TYPE_OFFSET * 2; }
+    inline uint8_t fromCompactType(uint8_t type) { return isCompactType(type) ? type - COMPACT_TYPE_OFFSET : type; }
+
+    // encode functions return encoded length or 0 if buffer is too small
+    uint16_t encodeMessage(const MqttMessage & message, uint8_t * buffer, uint16_t length);
+    uint16_t encodeAliasDefine(uint8_t alias, const MqttMessage & message, uint8_t * buffer, uint16_t length);
+    uint16_t encodeAliasUse(uint8_t alias, const MqttMessage & message, uint8_t * buffer, uint16_t length);
+
+    // builds a BATCH frame, room for the sequence header is left in MAX_LEN_ENCODED_MESSAGE
+    class MessageBatch
+    {
+        public:
+            static const uint16_t MAX_LEN_BATCH {MAX_LEN_ENCODED_MESSAGE - SEQUENCE_HEADER_SIZE};
+
+        private:
+            uint8_t buffer[MAX_LEN_BATCH] {BATCH, 0};
+            uint16_t length {2};
+            char previous[MQTT_MAX_LEN_TOPIC] {0};
+
+        public:
+            // returns false when the message does not fit, the batch is unchanged then
+            bool add(const MqttMessage & message);
+            void clear();
+
+            uint8_t size() const { return buffer[1]; }
+            const uint8_t * getBuffer() const { return buffer; }
+            uint16_t getLength() const { return length; }
+    };
+
+    // reads the messages of a BATCH frame in order
+    class BatchReader
+    {
+        private:
+            const uint8_t * buffer;
+            uint16_t length;
+            uint16_t position {2};
+            uint8_t remaining {0};
+            char previous[MQTT_MAX_LEN_TOPIC] {0};
+
+        public:
+            BatchReader(const uint8_t * buffer, uint16_t length);
+            // Batch frames are stored unchanged in the message by decodeFrame
+            BatchReader(const MqttMessage & frame);
+
+            // returns false after the last message or for a malformed frame
+            bool next(MqttMessage & message);
+    };
+
+    // returns SEQUENCE_HEADER_SIZE or 0, sequence without present is not encoded
+    uint16_t encodeSequence(const FrameSequence & sequence, uint8_t * buffer, uint16_t length);
+    uint16_t encodeAck(uint16_t sequence, uint8_t * buffer, uint16_t length);
+
+    bool decodeMessage(const uint8_t * buffer, uint16_t length, MqttMessage & message);
+
+    // AliasUse frames leave message topic empty, it has to be resolved by the receiver
+    // Ack frames set only sequence.number, Batch frames are copied to message, read them with BatchReader
+    // Poll frames are copied to message as well, see getPollWindow
+    FrameType decodeFrame(const uint8_t * buffer, uint16_t length, MqttMessage & message, uint8_t & alias, FrameSequence & sequence);
+    FrameType decodeFrame(const uint8_t * buffer, uint16_t length, MqttMessage & message, uint8_t & alias);
+
+    uint16_t encodePoll(uint16_t window, uint8_t * buffer, uint16_t length);
+    uint16_t getPollWindow(const MqttMessage & frame);
+
+    // transport is EncryptedMesh or EncryptedNetwork
+    template<typename Transport>
+    bool sendCompactMessage(Transport & transport, const MqttMessage & message, uint8_t type, uint16_t node, const FrameSequence & sequence = {})
+    {
+        uint8_t buffer[MAX_LEN_ENCODED_MESSAGE] {0};
+        uint16_t headerLength = encodeSequence(sequence, buffer, sizeof(buffer));
+        uint16_t length = encodeMessage(message, buffer + headerLength, sizeof(buffer) - headerLength);
+        if (length == 0 && headerLength > 0) {
+            headerLength = 0;
+            length = encodeMessage(message, buffer, sizeof(buffer));
+        }
+        return length > 0 && transport.send(buffer, headerLength + length, toCompactType(type), node);
+    }
+
+    template<typename Transport>
+    bool sendBatch(Transport & transport, const MessageBatch & batch, uint8_t type, uint16_t node, const FrameSequence & sequence = {})
+    {
+        uint8_t buffer[MAX_LEN_ENCODED_MESSAGE] {0};
+        uint16_t headerLength = encodeSequence(sequence, buffer, sizeof(buffer));
+        memcpy(buffer + headerLength, batch.getBuffer(), batch.getLength());
+        return batch.size() > 0 && transport.send(buffer, headerLength + batch.getLength(), toCompactType(type), node);
+    }
+
+    template<typename Transport>
+    bool sendPoll(Transport & transport, uint8_t type, uint16_t node, uint16_t window)
+    {
+        uint8_t buffer[3] {0};
+        return encodePoll(window, buffer, sizeof(buffer)) > 0 && transport.send(buffer, sizeof(buffer), toCompactType(type), node);
+    }
+
+    template<typename Transport>
+    bool sendAck(Transport & transport, uint8_t type, uint16_t node, uint16_t sequence)
+    {
+        uint8_t buffer[SEQUENCE_HEADER_SIZE] {0};
+        return encodeAck(sequence, buffer, sizeof(buffer)) > 0 && transport.send(buffer, sizeof(buffer), toCompactType(type), node);
+    }
+
+    template<typename Transport>
+    bool sendAliasReset(Transport & transport, uint8_t type, uint16_t node)
+    {
+        uint8_t buffer[] {ALIAS_RESET};
+        return transport.send(buffer, sizeof(buffer), toCompactType(type), node);
+    }
+
+    template<typename Transport>
+    bool sendRestart(Transport & transport, uint8_t type, uint16_t node)
+    {
+        uint8_t buffer[] {RESTART};
+        return transport.send(buffer, sizeof(buffer), toCompactType(type), node);
+    }
+
+    // accepts compact and full size frames, use fromCompactType(header.type) for the message type
+    // sequence.present is false for frames sent without sequence number
+    template<typename Transport, typename Header>
+    FrameType receiveFrame(Transport & transport, MqttMessage & message, uint8_t & alias, FrameSequence & sequence, uint8_t type, Header & header)
+    {
+        uint8_t buffer[sizeof(MqttMessage)] {0};
+        sequence = {};
+        if (!transport.receive(buffer, sizeof(buffer), type, header)) {
+            return FrameType::Invalid;
+        }
+        if (isCompactType(header.type)) {
+            return decodeFrame(buffer, sizeof(buffer), message, alias, sequence);
+        }
+        memcpy(&message, buffer, sizeof(message));
+        return FrameType::Message;
+    }
+
+    template<typename Transport, typename Header>
+    FrameType receiveFrame(Transport & transport, MqttMessage & message, uint8_t & alias, uint8_t type, Header & header)
+    {
+        FrameSequence sequence;
+        return receiveFrame(transport, message, alias, sequence, type, header);
+    }
+
+    template<typename Transport, typename Header>
+    bool receiveMessage(Transport & transport, MqttMessage & message, uint8_t type, Header & header)
+    {
+        uint8_t alias {0};
+        return receiveFrame(transport, message, alias, type, header) == FrameType::Message;
+    }
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifndef NODE_MODULE_MESSAGE_SCHEDULER_H
+#define NODE_MODULE_MESSAGE_SCHEDULER_H
+
+#include <Arduino.h>
+#include "RingQueue.h"
+
+namespace NodeModule
+{
+    enum class SendResult : uint8_t
+    {
+        Failed,
+        Delivered,
+        // sent, the item stays until acknowledge() and is sent again if the ack does not come
+        AwaitingAck
+    };
+
+    template<typename T>
+    struct ScheduledItem
+    {
+        T payload {};
+        unsigned long nextAttempt {0};
+        uint8_t failedToSend {0};
+        // sends without ack, counted apart from failures so a node slow to ack keeps its failure budget
+        uint8_t unacked {0};
+    };
+
+    // outbound messages are kept in a separate queue per destination node
+    // only the head of each queue is retried and every failure doubles its delay
+    // so an unreachable node can not hold back messages for other nodes
+    template<typename T, uint8_t MAX_NODES, uint8_t MAX_PER_NODE>
+    class MessageScheduler
+    {
+        public:
+            // called for every item leaving the queue, delivered or dropped
+            typedef void (*ReleaseCallback)(T & payload);
+
+        private:
+            struct Destination
+            {
+                uint16_t node {0};
+                RingQueue<ScheduledItem<T>, MAX_PER_NODE> queue;
+            };
+
+            Destination destinations[MAX_NODES] {};
+            const uint16_t initialDelay;
+            const uint16_t maxDelay;
+            const uint8_t maxFailures;
+            const ReleaseCallback releaseCallback;
+            uint8_t nextDestination {0};
+            uint16_t dropped {0};
+
+            Destination * findDestination(uint16_t node)
+            {
+                Destination * freeDestination {nullptr};
+                for (auto & destination: destinations) {
+                    if (destination.node == node) {
+                        return &destination;
+                    }
+                    if (!freeDestination && destination.queue.isEmpty()) {
+                        freeDestination = &destination;
+                    }
+                }
+                if (freeDestination) {
+                    freeDestination->node = node;
+                }
+                return freeDestination;
+            }
+
+            void remove(Destination & destination)
+            {
+                if (releaseCallback) {
+                    releaseCallback(destination.queue.front()->payload);
+                }
+                destination.queue.pop();
+            }
+
+            unsigned long retryDelay(uint8_t failedToSend) const
+            {
+                unsigned long wait = initialDelay;
+                while (--failedToSend > 0 && wait < maxDelay) {
+                    wait <<= 1;
+                }
+                return wait < maxDelay ? wait : maxDelay;
+            }
+
+        public:
+            MessageScheduler(uint16_t initialDelay, uint16_t maxDelay, uint8_t maxFailures, ReleaseCallback releaseCallback = nullptr):
+                initialDelay(initialDelay), maxDelay(maxDelay), maxFailures(maxFailures), releaseCallback(releaseCallback)
+            {}
+
+            // when the node queue is full the oldest message is dropped
+            bool add(const T & payload, uint16_t node, unsigned long now)
+            {
+                Destination * destination = findDestination(node);
+                if (!destination) {
+                    dropped++;
+                    return false;
+                }
+                if (destination->queue.isFull()) {
+                    remove(*destination);
+                    dropped++;
+                }
+                ScheduledItem<T> item;
+                item.payload = payload;
+                item.nextAttempt = now;
+                return destination->queue.push(item);
+            }
+
+            // sender(T & payload, uint16_t node) returns SendResult
+            // failed sends and sends left without ack each drop the item after maxFailures retries
+            // maxAttempts limits the number of sender calls so one run takes bounded time
+            template<typename Sender>
+            uint8_t process(Sender sender, unsigned long now, uint8_t maxAttempts = 0xFF)
+            {
+                return process(sender, now, maxAttempts, [](uint16_t) { return true; });
+            }
+
+            // queues of nodes for which isAwake(uint16_t node) is false are kept as mailboxes
+            // nothing is sent to them and no failures are counted
+            template<typename Sender, typename Awake>
+            uint8_t process(Sender sender, unsigned long now, uint8_t maxAttempts, Awake isAwake)
+            {
+                uint8_t count {0};
+                uint8_t attempts {0};
+                for (uint8_t i = 0; i < MAX_NODES && attempts < maxAttempts; i++) {
+                    Destination & destination = destinations[(nextDestination + i) % MAX_NODES];
+                    if (destination.queue.isEmpty() || !isAwake(destination.node)) {
+                        continue;
+                    }
+                    ScheduledItem<T> * item {nullptr};
+                    while (attempts < maxAttempts && (item = destination.queue.front()) && (long)(now - item->nextAttempt) >= 0) {
+                        attempts++;
+                        SendResult result = sender(item->payload, destination.node);
+                        if (result == SendResult::Delivered) {
+                            remove(destination);
+                            count++;
+                            continue;
+                        }
+                        uint8_t & retries = result == SendResult::AwaitingAck ? item->unacked : item->failedToSend;
+                        retries++;
+                        if (retries > maxFailures) {
+                            remove(destination);
+                            dropped++;
+                        } else {
+                            item->nextAttempt = now + retryDelay(retries);
+                        }
+                        break;
+                    }
+                }
+                nextDestination = (nextDestination + 1) % MAX_NODES;
+                return count;
+            }
+
+            // node is listening again, its waiting message is sent on the next run
+            void resume(uint16_t node, unsigned long now)
+            {
+                for (auto & destination: destinations) {
+                    ScheduledItem<T> * item = destination.queue.front();
+                    if (item && destination.node == node) {
+                        item->nextAttempt = now;
+                    }
+                }
+            }
+
+            // removes the head of the node queue if isAcked(payload) returns true
+            // for messages that are delivered when the node acknowledges them instead of when sent
+            template<typename Predicate>
+            bool acknowledge(uint16_t node, Predicate isAcked)
+            {
+                for (auto & destination: destinations) {
+                    ScheduledItem<T> * item = destination.queue.front();
+                    if (item && destination.node == node && isAcked(item->payload)) {
+                        remove(destination);
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            uint8_t size() const
+            {
+                uint8_t count {0};
+                for (const auto & destination: destinations) {
+                    count += destination.queue.size();
+                }
+                return count;
+            }
+
+            uint16_t getDropped() const { return dropped; }
+    };
+}
+
+#endif
@@ -0,0 +1,23 @@
+#include "MqttCallbacks.h"
+
+namespace NodeModule
+{
+    MqttCallbacks::Entry MqttCallbacks::entries[MqttCallbacks::MAX_CALLBACKS];
+
+    const MqttCallbacks::Receiver MqttCallbacks::receivers[MqttCallbacks::MAX_CALLBACKS] {
+        &MqttCallbacks::receive<0>,
+        &MqttCallbacks::receive<1>
+    };
+
+    MqttCallbacks::Receiver MqttCallbacks::attach(MqttCallback callback, void * context)
+    {
+        for (uint8_t i = 0; i < MAX_CALLBACKS; i++) {
+            if (entries[i].callback == nullptr || (entries[i].callback == callback && entries[i].context == context)) {
+                entries[i].callback = callback;
+                entries[i].context = context;
+                return receivers[i];
+            }
+        }
+        return nullptr;
+    }
+}
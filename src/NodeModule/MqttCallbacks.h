@@ -0,0 +1,54 @@
+#ifndef NODE_MODULE_MQTT_CALLBACKS_H
+#define NODE_MODULE_MQTT_CALLBACKS_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // context is what was given to attachCallback, topic and payload point into the client buffer
+    typedef void (*MqttCallback)(void * context, const char * topic, uint8_t * payload, uint16_t length);
+
+    // PubSubClient keeps its callback in a std::function on esp8266, a closure bigger than
+    // two pointers is allocated on the heap there and again whenever the function is copied
+    // the table gives the client a plain function for each slot and keeps callback and context itself
+    class MqttCallbacks
+    {
+        public:
+            static const uint8_t MAX_CALLBACKS {2};
+            typedef void (*Receiver)(char * topic, uint8_t * payload, unsigned int length);
+
+            // returns the function for client.setCallback, nullptr when all slots are taken
+            static Receiver attach(MqttCallback callback, void * context);
+
+        private:
+            struct Entry
+            {
+                MqttCallback callback {nullptr};
+                void * context {nullptr};
+            };
+
+            static Entry entries[MAX_CALLBACKS];
+
+            template<uint8_t SLOT>
+            static void receive(char * topic, uint8_t * payload, unsigned int length)
+            {
+                entries[SLOT].callback(entries[SLOT].context, topic, payload, length);
+            }
+
+            static const Receiver receivers[MAX_CALLBACKS];
+    };
+
+    // MqttClient is PubSubClient, callback has to be a function or a lambda without captures
+    template<typename MqttClient>
+    bool attachCallback(MqttClient & client, MqttCallback callback, void * context = nullptr)
+    {
+        MqttCallbacks::Receiver receiver = MqttCallbacks::attach(callback, context);
+        if (receiver == nullptr) {
+            return false;
+        }
+        client.setCallback(receiver);
+        return true;
+    }
+}
+
+#endif
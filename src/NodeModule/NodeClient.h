@@ -0,0 +1,149 @@
+#ifndef NODE_MODULE_NODE_CLIENT_H
+#define NODE_MODULE_NODE_CLIENT_H
+
+#include <Arduino.h>
+#include <RF24Network.h>
+#include "MqttModule/MqttMessage.h"
+#include "MessageCodec.h"
+#include "TopicAliases.h"
+#include "SequenceWindow.h"
+
+namespace NodeModule
+{
+    using MqttModule::MqttMessage;
+    using MqttModule::MessageType;
+
+    const uint16_t GATEWAY_NODE {0};
+
+    // node side of the compact protocol with the gateway
+    // publishes use topic aliases, received frames are expanded and passed to the subscriber list
+    // publishes carry a sequence number, repeated frames from the gateway are dropped and acked again
+    // the last publish sent with ALIAS_USE is kept, when the gateway answers ALIAS_RESET it did not know
+    // the alias (restart, alias replaced) and the publish is sent again with the topic
+    // the first subscribe after start is preceded by RESTART, the gateway drops what it kept from the last run
+    template<typename Transport, uint8_t MAX_OUT_ALIASES, uint8_t MAX_IN_ALIASES>
+    class NodeClient
+    {
+        static_assert(MAX_IN_ALIASES >= MAX_NODE_ALIASES, "Node has to keep every alias the gateway defines");
+
+        private:
+            Transport & transport;
+            TopicAliasCache<MAX_OUT_ALIASES> outboundAliases;
+            TopicAliasTable<MAX_IN_ALIASES> inboundAliases;
+            SequenceWindow received;
+            uint16_t nextSequence {0};
+            MqttMessage lastAliased;
+            bool restarted {true};
+
+        public:
+            NodeClient(Transport & transport):
+                transport(transport)
+            {}
+
+            // start from a random number so a restarted node is not taken for repeated frames
+            void setSequence(uint16_t sequence)
+            {
+                nextSequence = sequence;
+            }
+
+            bool publish(const MqttMessage & message)
+            {
+                uint8_t alias = outboundAliases.getAlias(message.topic);
+                bool isDefined = alias > 0;
+                if (!isDefined) {
+                    alias = outboundAliases.assign(message.topic);
+                }
+                uint8_t assignedAlias = alias;
+                FrameSequence sequence {nextSequence++, true, false};
+                bool sent = sendAliasedMessage(transport, alias, isDefined, message, (uint8_t)MessageType::Publish, GATEWAY_NODE, sequence);
+                if (!isDefined && (!sent || alias == 0)) {
+                    outboundAliases.remove(assignedAlias);
+                }
+                if (sent && isDefined) {
+                    lastAliased = message;
+                }
+                return sent;
+            }
+
+            // a batch of one message is sent as a normal publish so it can use an alias
+            bool publish(const MessageBatch & batch)
+            {
+                if (batch.size() == 1) {
+                    MqttMessage message;
+                    BatchReader reader(batch.getBuffer(), batch.getLength());
+                    return reader.next(message) && publish(message);
+                }
+                FrameSequence sequence {nextSequence++, true, false};
+                return sendBatch(transport, batch, (uint8_t)MessageType::Publish, GATEWAY_NODE, sequence);
+            }
+
+            // compact subscribe also tells the gateway to send compact frames to this node
+            bool subscribe(const char * topic)
+            {
+                // later subscribes (resubscribe, more topics) keep the aliases and sequence numbers
+                if (restarted) {
+                    restarted = !sendRestart(transport, (uint8_t)MessageType::Subscribe, GATEWAY_NODE);
+                    if (restarted) {
+                        return false;
+                    }
+                }
+                MqttMessage message(topic);
+                return sendCompactMessage(transport, message, (uint8_t)MessageType::Subscribe, GATEWAY_NODE);
+            }
+
+            // sleeping node woke up, the gateway sends what it kept for this node within window ms
+            bool poll(uint16_t window)
+            {
+                return sendPoll(transport, (uint8_t)MessageType::Publish, GATEWAY_NODE, window);
+            }
+
+            // receives pending frames and passes messages to subscribers.call
+            // returns number of messages received
+            template<typename Subscribers>
+            uint8_t loop(Subscribers & subscribers)
+            {
+                uint8_t count {0};
+                while (transport.isAvailable()) {
+                    MqttMessage message;
+                    RF24NetworkHeader header;
+                    uint8_t alias {0};
+                    FrameSequence sequence;
+                    FrameType frameType = receiveFrame(transport, message, alias, sequence, (uint8_t)MessageType::All, header);
+                    if (frameType == FrameType::AliasReset) {
+                        outboundAliases.clear();
+                        // the gateway may have published it already, a repeated value is harmless
+                        if (lastAliased.topic[0] != '\0') {
+                            MqttMessage message = lastAliased;
+                            lastAliased.topic[0] = '\0';
+                            publish(message);
+                        }
+                        continue;
+                    }
+                    if (!inboundAliases.resolve(frameType, GATEWAY_NODE, alias, message)) {
+                        if (frameType == FrameType::AliasUse) {
+                            sendAliasReset(transport, (uint8_t)MessageType::Publish, GATEWAY_NODE);
+                        }
+                        continue;
+                    }
+                    if (sequence.present) {
+                        // the ack may have been lost, a repeated frame is acked again
+                        bool isNew = received.accept(sequence.number);
+                        if (sequence.ackRequested) {
+                            sendAck(transport, (uint8_t)MessageType::Publish, GATEWAY_NODE, sequence.number);
+                        }
+                        if (!isNew) {
+                            continue;
+                        }
+                    }
+                    subscribers.call(message);
+                    count++;
+                }
+                return count;
+            }
+
+            const TopicAliasCache<MAX_OUT_ALIASES> & getOutboundAliases() const { return outboundAliases; }
+            const TopicAliasTable<MAX_IN_ALIASES> & getInboundAliases() const { return inboundAliases; }
+    };
+}
+
+#endif
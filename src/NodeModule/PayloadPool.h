@@ -0,0 +1,63 @@
+#ifndef NODE_MODULE_PAYLOAD_POOL_H
+#define NODE_MODULE_PAYLOAD_POOL_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // static slots shared by reference count
+    // one payload can be queued for many nodes while stored only once
+    template<typename T, uint8_t SIZE>
+    class PayloadPool
+    {
+        private:
+            T payloads[SIZE] {};
+            uint8_t references[SIZE] {0};
+
+        public:
+            static const uint8_t NO_SLOT {0xFF};
+
+            // returns free slot holding one reference or NO_SLOT
+            uint8_t acquire()
+            {
+                for (uint8_t slot = 0; slot < SIZE; slot++) {
+                    if (references[slot] == 0) {
+                        payloads[slot] = {};
+                        references[slot] = 1;
+                        return slot;
+                    }
+                }
+                return NO_SLOT;
+            }
+
+            void retain(uint8_t slot)
+            {
+                if (slot < SIZE && references[slot] < 0xFF) {
+                    references[slot]++;
+                }
+            }
+
+            void release(uint8_t slot)
+            {
+                if (slot < SIZE && references[slot] > 0) {
+                    references[slot]--;
+                }
+            }
+
+            T & get(uint8_t slot)
+            {
+                return payloads[slot];
+            }
+
+            uint8_t used() const
+            {
+                uint8_t count {0};
+                for (auto reference: references) {
+                    count += reference > 0 ? 1 : 0;
+                }
+                return count;
+            }
+    };
+}
+
+#endif
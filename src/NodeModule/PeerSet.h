@@ -0,0 +1,37 @@
+#ifndef NODE_MODULE_PEER_SET_H
+#define NODE_MODULE_PEER_SET_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // one bit per node id
+    template<uint16_t MAX_NODE_ID>
+    class PeerSet
+    {
+        private:
+            uint8_t bits[MAX_NODE_ID / 8 + 1] {0};
+
+        public:
+            void add(uint16_t node)
+            {
+                if (node <= MAX_NODE_ID) {
+                    bits[node / 8] |= 1 << (node % 8);
+                }
+            }
+
+            void remove(uint16_t node)
+            {
+                if (node <= MAX_NODE_ID) {
+                    bits[node / 8] &= ~(1 << (node % 8));
+                }
+            }
+
+            bool contains(uint16_t node) const
+            {
+                return node <= MAX_NODE_ID && (bits[node / 8] & (1 << (node % 8)));
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include "PinJson.h"
+
+namespace NodeModule
+{
+    static const char * skipSpace(const char * position, const char * end)
+    {
+        while (position < end && (*position == ' ' || *position == '\t' || *position == '\r' || *position == '\n')) {
+            position++;
+        }
+        return position;
+    }
+
+    // "name" without escapes
+    static bool matchKey(const char *& position, const char * end, const char * name)
+    {
+        uint8_t length = strlen(name);
+        if (end - position < length + 2 || position[0] != '"' || position[length + 1] != '"'
+            || strncmp(position + 1, name, length) != 0) {
+            return false;
+        }
+        position += length + 2;
+        return true;
+    }
+
+    static bool parseInteger(const char *& position, const char * end, int32_t & value)
+    {
+        if (end - position >= 4 && strncmp(position, "true", 4) == 0) {
+            value = 1;
+            position += 4;
+            return true;
+        }
+        if (end - position >= 5 && strncmp(position, "false", 5) == 0) {
+            value = 0;
+            position += 5;
+            return true;
+        }
+        bool negative = position < end && *position == '-';
+        if (negative) {
+            position++;
+        }
+        const char * start = position;
+        int32_t result {0};
+        while (position < end && *position >= '0' && *position <= '9') {
+            if (result > (INT32_MAX - 9) / 10) {
+                return false;
+            }
+            result = result * 10 + (*position++ - '0');
+        }
+        // fractions and exponents go to the general parser
+        if (position == start || (position < end && (*position == '.' || *position == 'e' || *position == 'E'))) {
+            return false;
+        }
+        value = negative ? -result : result;
+        return true;
+    }
+
+    bool parsePinCommand(const char * text, uint16_t length, PinCommand & command)
+    {
+        const char * end = text + length;
+        const char * position = skipSpace(text, end);
+        if (position >= end || *position++ != '{') {
+            return false;
+        }
+        bool hasPin {false};
+        bool hasValue {false};
+        while (true) {
+            position = skipSpace(position, end);
+            bool isPin = matchKey(position, end, "pin");
+            if (!isPin && !matchKey(position, end, "set")) {
+                return false;
+            }
+            position = skipSpace(position, end);
+            if (position >= end || *position++ != ':') {
+                return false;
+            }
+            position = skipSpace(position, end);
+            int32_t value {0};
+            if (!parseInteger(position, end, value)) {
+                return false;
+            }
+            if (isPin) {
+                if (hasPin || value < 0 || value > 255) {
+                    return false;
+                }
+                command.pin = value;
+                hasPin = true;
+            } else {
+                if (hasValue) {
+                    return false;
+                }
+                command.value = value;
+                hasValue = true;
+            }
+            position = skipSpace(position, end);
+            if (position < end && *position == ',') {
+                position++;
+                continue;
+            }
+            if (position >= end || *position++ != '}') {
+                return false;
+            }
+            break;
+        }
+        return hasPin && hasValue && skipSpace(position, end) == end;
+    }
+
+    // integers as ArduinoJson prints them, no leading zeros, no -0 and within int32
+    // fractions are printed with the float precision of the document, they are left to it
+    static bool isInteger(const char * value)
+    {
+        bool negative = *value == '-';
+        if (negative) {
+            value++;
+        }
+        size_t digits = strspn(value, "0123456789");
+        return digits > 0 && digits < 10 && value[digits] == '\0'
+            && (value[0] != '0' || (digits == 1 && !negative));
+    }
+
+    static bool append(char * buffer, uint16_t size, uint16_t & length, const char * value)
+    {
+        uint16_t valueLength = strlen(value);
+        if (length + valueLength >= size) {
+            return false;
+        }
+        memcpy(buffer + length, value, valueLength);
+        length += valueLength;
+        buffer[length] = '\0';
+        return true;
+    }
+
+    uint16_t writePinState(char * buffer, uint16_t size, const char * type, uint8_t pin, const char * value)
+    {
+        if (!isInteger(value) || strchr(type, '"') != nullptr || strchr(type, '\\') != nullptr) {
+            return 0;
+        }
+        char id[4] {0};
+        uint8_t digits {0};
+        do {
+            id[2 - digits++] = '0' + pin % 10;
+            pin /= 10;
+        } while (pin > 0);
+        uint16_t length {0};
+        bool written = append(buffer, size, length, "{\"type\":\"")
+            && append(buffer, size, length, type)
+            && append(buffer, size, length, "\",\"pin\":")
+            && append(buffer, size, length, id + 3 - digits)
+            && append(buffer, size, length, ",\"value\":")
+            && append(buffer, size, length, value)
+            && append(buffer, size, length, "}");
+        return written ? length : 0;
+    }
+}
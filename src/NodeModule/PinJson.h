@@ -0,0 +1,76 @@
+#ifndef NODE_MODULE_PIN_JSON_H
+#define NODE_MODULE_PIN_JSON_H
+
+#include <Arduino.h>
+#include "MqttModule/MqttMessage.h"
+
+namespace NodeModule
+{
+    using MqttModule::MqttMessage;
+
+    // {"pin": 13, "set": 1}
+    struct PinCommand
+    {
+        uint8_t pin {0};
+        int32_t value {0};
+    };
+
+    // parses the set/json command in place without a json document
+    // keys in any order with whitespace, integer or true/false values
+    // anything else (other keys, strings, fractions, nesting) returns false for the general parser
+    bool parsePinCommand(const char * text, uint16_t length, PinCommand & command);
+
+    // writes {"type":"<type>","pin":<pin>,"value":<value>}, the bytes serializeJson gives for a document
+    // with type, pin and the integer value added in that order
+    // returns the length without the terminator, 0 when it does not fit or value is not an integer
+    uint16_t writePinState(char * buffer, uint16_t size, const char * type, uint8_t pin, const char * value);
+
+    // subscriber list wrapper for NodeClient::loop and the mqtt callback
+    // set/json commands the fixed parser understands are applied directly with provider.setValue,
+    // everything else is passed to subscribers.call (PinStateJsonHandler with ArduinoJson)
+    template<typename Subscribers, typename Provider, typename Pin>
+    class PinCommands
+    {
+        private:
+            Subscribers & subscribers;
+            Provider & provider;
+            Pin * pins;
+            const uint8_t count;
+            char topic[MQTT_MAX_LEN_TOPIC] {0};
+
+            bool apply(const PinCommand & command)
+            {
+                for (uint8_t i = 0; i < count; i++) {
+                    if (pins[i].id == command.pin) {
+                        // read only pins are rejected by the json handler with its own message
+                        return !pins[i].readOnly && provider.setValue(pins[i], command.value);
+                    }
+                }
+                return false;
+            }
+
+        public:
+            PinCommands(Subscribers & subscribers, Provider & provider, Pin * pins, uint8_t count):
+                subscribers(subscribers), provider(provider), pins(pins), count(count)
+            {}
+
+            void setTopic(const char * value)
+            {
+                strncpy(topic, value, sizeof(topic) - 1);
+            }
+
+            uint8_t call(const MqttMessage & message)
+            {
+                PinCommand command;
+                if (topic[0] != '\0' && strcmp(message.topic, topic) == 0
+                    && parsePinCommand(message.message, strnlen(message.message, sizeof(message.message)), command)
+                    && apply(command)
+                ) {
+                    return 1;
+                }
+                return subscribers.call(message);
+            }
+    };
+}
+
+#endif
@@ -0,0 +1,120 @@
+#ifndef NODE_MODULE_PUBLISH_CACHE_H
+#define NODE_MODULE_PUBLISH_CACHE_H
+
+#include <Arduino.h>
+#include <CRC32.h>
+#include "MqttModule/MqttMessage.h"
+#include "TopicMatch.h"
+
+namespace NodeModule
+{
+    using MqttModule::MqttMessage;
+
+    // how messages of a topic class are published to the broker
+    struct PublishPolicy
+    {
+        // mqtt filter with + and # wildcards
+        const char * filter;
+        bool retain;
+        // unchanged values are published again after heartbeat ms, 0 publishes every message
+        uint32_t heartbeat;
+    };
+
+    // last value published for each topic, kept as topic hash and crc32 of the payload
+    // a value equal to the last one is skipped until the heartbeat of its policy has passed
+    // the first policy matching the topic applies, topics without one are retained and always published
+    // when full the entry published longest ago is replaced
+    template<uint8_t SIZE>
+    class PublishCache
+    {
+        private:
+            struct Entry
+            {
+                uint32_t topic {0};
+                uint32_t payload {0};
+                unsigned long publishedAt {0};
+                bool used {false};
+            };
+
+            const PublishPolicy * policies;
+            const uint8_t policyCount;
+            Entry entries[SIZE] {};
+            uint32_t suppressed {0};
+
+            static uint32_t payloadHash(const MqttMessage & message)
+            {
+                return CRC32::calculate(message.message, strnlen(message.message, sizeof(message.message)));
+            }
+
+            Entry * find(uint32_t topic)
+            {
+                for (auto & entry: entries) {
+                    if (entry.used && entry.topic == topic) {
+                        return &entry;
+                    }
+                }
+                return nullptr;
+            }
+
+            Entry & replace(unsigned long now)
+            {
+                Entry * oldest = &entries[0];
+                for (auto & entry: entries) {
+                    if (!entry.used) {
+                        return entry;
+                    }
+                    if (now - entry.publishedAt > now - oldest->publishedAt) {
+                        oldest = &entry;
+                    }
+                }
+                return *oldest;
+            }
+
+        public:
+            PublishCache(const PublishPolicy * policies, uint8_t policyCount):
+                policies(policies), policyCount(policyCount)
+            {}
+
+            PublishPolicy getPolicy(const char * topic) const
+            {
+                for (uint8_t i = 0; i < policyCount; i++) {
+                    if (topicMatches(policies[i].filter, topic)) {
+                        return policies[i];
+                    }
+                }
+                return {"#", true, 0};
+            }
+
+            // false when the same value was published less than heartbeat ms ago
+            bool isDue(const MqttMessage & message, const PublishPolicy & policy, unsigned long now)
+            {
+                if (policy.heartbeat == 0) {
+                    return true;
+                }
+                Entry * entry = find(topicHash(message.topic));
+                if (entry && entry->payload == payloadHash(message) && now - entry->publishedAt < policy.heartbeat) {
+                    suppressed++;
+                    return false;
+                }
+                return true;
+            }
+
+            // call after the broker accepted the message
+            void published(const MqttMessage & message, const PublishPolicy & policy, unsigned long now)
+            {
+                if (policy.heartbeat == 0) {
+                    return;
+                }
+                uint32_t topic = topicHash(message.topic);
+                Entry * entry = find(topic);
+                if (!entry) {
+                    entry = &replace(now);
+                }
+                *entry = {topic, payloadHash(message), now, true};
+            }
+
+            uint32_t getSuppressed() const { return suppressed; }
+    };
+}
+
+#endif
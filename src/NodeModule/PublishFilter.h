@@ -0,0 +1,86 @@
+#ifndef NODE_MODULE_PUBLISH_FILTER_H
+#define NODE_MODULE_PUBLISH_FILTER_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // {pin id, deadband, min interval ms}
+    struct PublishLimits
+    {
+        uint8_t pin {0};
+        float deadband {0};
+        uint16_t minInterval {0};
+    };
+
+    // decides when a changing pin value is published
+    // a change is published when it moved more than deadband away from the last published value
+    // and at least minInterval ms passed since the last publish, changes in between are coalesced
+    // with a deadband of 0 every change is published, also one reporting the same value again
+    template<uint8_t SIZE>
+    class PublishFilter
+    {
+        private:
+            struct State
+            {
+                float published {0};
+                unsigned long publishedAt {0};
+                float deadband {0};
+                uint16_t minInterval {0};
+                bool pending {false};
+                bool hasPublished {false};
+            };
+
+            State states[SIZE] {};
+
+        public:
+            void setLimits(uint8_t index, float deadband, uint16_t minInterval)
+            {
+                if (index < SIZE) {
+                    states[index].deadband = deadband;
+                    states[index].minInterval = minInterval;
+                }
+            }
+
+            // latest value of the pin, a value back inside a deadband above 0 cancels a pending publish
+            void update(uint8_t index, float value)
+            {
+                if (index >= SIZE) {
+                    return;
+                }
+                State & state = states[index];
+                float distance = value > state.published ? value - state.published : state.published - value;
+                state.pending = !state.hasPublished || state.deadband <= 0 || distance > state.deadband;
+            }
+
+            // for values that can not be compared, every change is published
+            void changed(uint8_t index)
+            {
+                if (index < SIZE) {
+                    states[index].pending = true;
+                }
+            }
+
+            bool isDue(uint8_t index, unsigned long now) const
+            {
+                if (index >= SIZE) {
+                    return false;
+                }
+                const State & state = states[index];
+                return state.pending && (!state.hasPublished || now - state.publishedAt >= state.minInterval);
+            }
+
+            void published(uint8_t index, float value, unsigned long now)
+            {
+                if (index < SIZE) {
+                    State & state = states[index];
+                    state.published = value;
+                    state.publishedAt = now;
+                    state.pending = false;
+                    state.hasPublished = true;
+                }
+            }
+    };
+}
+
+#endif
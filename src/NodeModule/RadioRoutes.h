@@ -0,0 +1,57 @@
+#ifndef NODE_MODULE_RADIO_ROUTES_H
+#define NODE_MODULE_RADIO_ROUTES_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // radio each node was last heard on, for a gateway running one mesh per radio channel
+    // the node picks the channel, node ids have to be unique across all meshes
+    // nodes not heard yet are sent to the first radio
+    template<uint16_t MAX_NODE_ID, uint8_t RADIOS>
+    class RadioRoutes
+    {
+        private:
+            // radio + 1, 0 when not heard
+            uint8_t routes[MAX_NODE_ID + 1] {0};
+            uint16_t moved {0};
+
+        public:
+            // returns true when the node was heard on another radio before
+            bool heard(uint16_t node, uint8_t radio)
+            {
+                if (node > MAX_NODE_ID || radio >= RADIOS || routes[node] == radio + 1) {
+                    return false;
+                }
+                bool isMoved = routes[node] > 0;
+                moved += isMoved && moved < 0xFFFF ? 1 : 0;
+                routes[node] = radio + 1;
+                return isMoved;
+            }
+
+            uint8_t get(uint16_t node) const
+            {
+                return node <= MAX_NODE_ID && routes[node] > 0 ? routes[node] - 1 : 0;
+            }
+
+            bool contains(uint16_t node) const
+            {
+                return node <= MAX_NODE_ID && routes[node] > 0;
+            }
+
+            // nodes heard on radio
+            uint16_t count(uint8_t radio) const
+            {
+                uint16_t nodes {0};
+                for (auto route: routes) {
+                    nodes += route == radio + 1 ? 1 : 0;
+                }
+                return nodes;
+            }
+
+            // nodes that changed channel, or two nodes with the same id on different channels
+            uint16_t getMoved() const { return moved; }
+    };
+}
+
+#endif
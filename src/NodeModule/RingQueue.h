@@ -0,0 +1,51 @@
+#ifndef NODE_MODULE_RING_QUEUE_H
+#define NODE_MODULE_RING_QUEUE_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // fixed capacity fifo, push/pop are O(1)
+    template<typename T, uint8_t CAPACITY>
+    class RingQueue
+    {
+        private:
+            T items[CAPACITY] {};
+            uint8_t head {0};
+            uint8_t count {0};
+
+        public:
+            bool push(const T & item)
+            {
+                if (isFull()) {
+                    return false;
+                }
+                items[(head + count) % CAPACITY] = item;
+                count++;
+                return true;
+            }
+
+            T * front()
+            {
+                return isEmpty() ? nullptr : &items[head];
+            }
+
+            bool pop()
+            {
+                if (isEmpty()) {
+                    return false;
+                }
+                items[head] = {};
+                head = (head + 1) % CAPACITY;
+                count--;
+                return true;
+            }
+
+            bool isEmpty() const { return count == 0; }
+            bool isFull() const { return count == CAPACITY; }
+            uint8_t size() const { return count; }
+            uint8_t capacity() const { return CAPACITY; }
+    };
+}
+
+#endif
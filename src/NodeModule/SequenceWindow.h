@@ -0,0 +1,125 @@
+#ifndef NODE_MODULE_SEQUENCE_WINDOW_H
+#define NODE_MODULE_SEQUENCE_WINDOW_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // duplicate filter for the sequence numbers of one sender
+    // remembers which of the last SIZE numbers were received
+    // a number further behind is taken as a restarted sender and accepted
+    class SequenceWindow
+    {
+        private:
+            static const uint8_t SIZE {32};
+
+            uint16_t newest {0};
+            uint32_t received {0}; // bit n is set when newest - n was received
+
+        public:
+            // returns false for a duplicate
+            bool accept(uint16_t sequence)
+            {
+                int16_t distance = (int16_t)(sequence - newest);
+                if (received == 0 || distance <= -(int16_t)SIZE) {
+                    newest = sequence;
+                    received = 1;
+                    return true;
+                }
+                if (distance > 0) {
+                    received = distance < SIZE ? received << distance : 0;
+                    received |= 1;
+                    newest = sequence;
+                    return true;
+                }
+                uint32_t bit = (uint32_t)1 << -distance;
+                if (received & bit) {
+                    return false;
+                }
+                received |= bit;
+                return true;
+            }
+
+            void reset()
+            {
+                newest = 0;
+                received = 0;
+            }
+    };
+
+    // windows for up to MAX_PEERS senders, when full the oldest peer is replaced
+    template<uint8_t MAX_PEERS>
+    class SequenceWindows
+    {
+        private:
+            struct Entry
+            {
+                uint16_t peer {0};
+                bool used {false};
+                SequenceWindow window;
+            };
+
+            Entry entries[MAX_PEERS] {};
+            uint8_t nextReplaced {0};
+            uint16_t replaced {0};
+
+            Entry * find(uint16_t peer)
+            {
+                for (auto & entry: entries) {
+                    if (entry.used && entry.peer == peer) {
+                        return &entry;
+                    }
+                }
+                return nullptr;
+            }
+
+        public:
+            // returns false for a duplicate
+            bool accept(uint16_t peer, uint16_t sequence)
+            {
+                Entry * entry = find(peer);
+                if (!entry) {
+                    for (auto & candidate: entries) {
+                        if (!candidate.used) {
+                            entry = &candidate;
+                            break;
+                        }
+                    }
+                }
+                if (!entry) {
+                    entry = &entries[nextReplaced];
+                    nextReplaced = (nextReplaced + 1) % MAX_PEERS;
+                }
+                if (!entry->used || entry->peer != peer) {
+                    replaced += entry->used && replaced < 0xFFFF ? 1 : 0;
+                    entry->peer = peer;
+                    entry->used = true;
+                    entry->window.reset();
+                }
+                return entry->window.accept(sequence);
+            }
+
+            // peer restarted, its numbers start again
+            void reset(uint16_t peer)
+            {
+                Entry * entry = find(peer);
+                if (entry) {
+                    entry->window.reset();
+                }
+            }
+
+            uint8_t used() const
+            {
+                uint8_t count {0};
+                for (const auto & entry: entries) {
+                    count += entry.used ? 1 : 0;
+                }
+                return count;
+            }
+
+            // peers dropped to make room for new ones, their repeated frames get through
+            uint16_t getReplaced() const { return replaced; }
+    };
+}
+
+#endif
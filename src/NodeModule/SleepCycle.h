@@ -0,0 +1,43 @@
+#ifndef NODE_MODULE_SLEEP_CYCLE_H
+#define NODE_MODULE_SLEEP_CYCLE_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // battery node schedule: after each wake the node listens for window ms
+    // and sleeps for the rest of the period
+    class SleepCycle
+    {
+        private:
+            const uint32_t period;
+            const uint16_t window;
+            unsigned long wokeAt {0};
+
+        public:
+            SleepCycle(uint32_t period, uint16_t window):
+                period(period), window(window)
+            {}
+
+            void woke(unsigned long now)
+            {
+                wokeAt = now;
+            }
+
+            bool isWindowOver(unsigned long now) const
+            {
+                return now - wokeAt >= window;
+            }
+
+            // time to sleep until the next wake
+            uint32_t sleepTime(unsigned long now) const
+            {
+                unsigned long awake = now - wokeAt;
+                return awake < period ? period - awake : 0;
+            }
+
+            uint16_t getWindow() const { return window; }
+    };
+}
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef NODE_MODULE_SLEEPING_NODES_H
+#define NODE_MODULE_SLEEPING_NODES_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // nodes that sleep between polls, messages for them wait in their queue until the next poll
+    // nodes that never polled are always awake, when full the oldest entry is replaced
+    template<uint8_t SIZE>
+    class SleepingNodes
+    {
+        private:
+            struct Entry
+            {
+                uint16_t node {0};
+                bool used {false};
+                unsigned long awakeUntil {0};
+            };
+
+            Entry entries[SIZE] {};
+            uint8_t nextReplaced {0};
+            uint16_t replaced {0};
+
+            Entry * find(uint16_t node)
+            {
+                for (auto & entry: entries) {
+                    if (entry.used && entry.node == node) {
+                        return &entry;
+                    }
+                }
+                return nullptr;
+            }
+
+        public:
+            // node polled and listens for window ms
+            void wake(uint16_t node, unsigned long now, uint16_t window)
+            {
+                Entry * entry = find(node);
+                for (uint8_t i = 0; i < SIZE && !entry; i++) {
+                    if (!entries[i].used) {
+                        entry = &entries[i];
+                    }
+                }
+                if (!entry) {
+                    entry = &entries[nextReplaced];
+                    nextReplaced = (nextReplaced + 1) % SIZE;
+                    replaced += replaced < 0xFFFF ? 1 : 0;
+                }
+                entry->node = node;
+                entry->used = true;
+                entry->awakeUntil = now + window;
+            }
+
+            bool isAwake(uint16_t node, unsigned long now)
+            {
+                Entry * entry = find(node);
+                return !entry || (long)(entry->awakeUntil - now) > 0;
+            }
+
+            // node restarted, it polls again if it still sleeps
+            void remove(uint16_t node)
+            {
+                Entry * entry = find(node);
+                if (entry) {
+                    *entry = {};
+                }
+            }
+
+            uint8_t size() const
+            {
+                uint8_t count {0};
+                for (const auto & entry: entries) {
+                    count += entry.used ? 1 : 0;
+                }
+                return count;
+            }
+
+            // entries taken over while full, the replaced node is treated as awake
+            uint16_t getReplaced() const { return replaced; }
+    };
+}
+
+#endif
@@ -0,0 +1,201 @@
+#ifndef NODE_MODULE_SPILL_LOG_H
+#define NODE_MODULE_SPILL_LOG_H
+
+#include <Arduino.h>
+#include "MqttModule/MqttMessage.h"
+#include "MessageCodec.h"
+
+namespace NodeModule
+{
+    using MqttModule::MqttMessage;
+
+    // store and forward log of messages that could not be published
+    // kept in a file of CAPACITY fixed size slots used as a ring:
+    //
+    // [magic][state][sequence 4][crc 2][compact message]
+    //
+    // slots are written in order around the ring so writes are spread over the whole file
+    // a sent record is marked by clearing its state byte instead of rewriting the slot
+    // on begin the file is scanned and the ring position is recovered from the sequence numbers
+    //
+    // File is fs::File (LittleFS on esp8266, src/HostHal on the host)
+    template<typename File, uint16_t CAPACITY>
+    class SpillLog
+    {
+        private:
+            static const uint8_t MAGIC {0xA5};
+            static const uint8_t STATE_PENDING {0xFF};
+            static const uint8_t STATE_SENT {0x00};
+            static const uint8_t HEADER_SIZE {8};
+
+        public:
+            static const uint16_t SLOT_SIZE {HEADER_SIZE + MAX_LEN_ENCODED_MESSAGE};
+            static const uint32_t FILE_SIZE {(uint32_t)SLOT_SIZE * CAPACITY};
+
+        private:
+            File & file;
+            uint16_t head {0};
+            uint16_t tail {0};
+            uint16_t count {0};
+            uint32_t nextSequence {1};
+            uint16_t dropped {0};
+
+            static uint16_t crc16(const uint8_t * data, uint16_t length, uint16_t crc = 0xFFFF)
+            {
+                for (uint16_t i = 0; i < length; i++) {
+                    crc ^= (uint16_t)data[i] << 8;
+                    for (uint8_t bit = 0; bit < 8; bit++) {
+                        crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+                    }
+                }
+                return crc;
+            }
+
+            // reads slot, returns true for a valid record
+            bool readSlot(uint16_t slot, uint8_t * buffer, uint8_t & state, uint32_t & sequence)
+            {
+                if (!file.seek((uint32_t)slot * SLOT_SIZE) || file.read(buffer, SLOT_SIZE) != SLOT_SIZE) {
+                    return false;
+                }
+                if (buffer[0] != MAGIC) {
+                    return false;
+                }
+                state = buffer[1];
+                memcpy(&sequence, buffer + 2, sizeof(sequence));
+                uint16_t crc {0};
+                memcpy(&crc, buffer + 6, sizeof(crc));
+                return crc == crc16(buffer + HEADER_SIZE, MAX_LEN_ENCODED_MESSAGE, crc16(buffer + 2, sizeof(sequence)));
+            }
+
+            bool markSent(uint16_t slot)
+            {
+                uint8_t state {STATE_SENT};
+                if (!file.seek((uint32_t)slot * SLOT_SIZE + 1) || file.write(&state, 1) != 1) {
+                    return false;
+                }
+                file.flush();
+                return true;
+            }
+
+        public:
+            SpillLog(File & file):
+                file(file)
+            {}
+
+            // creates the slots if the file is new, recovers pending records otherwise
+            bool begin()
+            {
+                if (!file) {
+                    return false;
+                }
+                if (file.size() < FILE_SIZE) {
+                    uint8_t empty[SLOT_SIZE];
+                    memset(empty, 0xFF, sizeof(empty));
+                    uint32_t size = file.size() - file.size() % SLOT_SIZE;
+                    file.seek(size);
+                    for (; size < FILE_SIZE; size += SLOT_SIZE) {
+                        if (file.write(empty, SLOT_SIZE) != SLOT_SIZE) {
+                            return false;
+                        }
+                    }
+                    file.flush();
+                }
+
+                uint32_t newest {0};
+                uint32_t oldestPending {0xFFFFFFFF};
+                head = tail = count = 0;
+                for (uint16_t slot = 0; slot < CAPACITY; slot++) {
+                    uint8_t buffer[SLOT_SIZE] {0};
+                    uint8_t state {0};
+                    uint32_t sequence {0};
+                    if (!readSlot(slot, buffer, state, sequence)) {
+                        continue;
+                    }
+                    if (sequence >= newest) {
+                        newest = sequence;
+                        head = (slot + 1) % CAPACITY;
+                    }
+                    if (state == STATE_PENDING) {
+                        count++;
+                        if (sequence < oldestPending) {
+                            oldestPending = sequence;
+                            tail = slot;
+                        }
+                    }
+                }
+                nextSequence = newest + 1;
+                if (count == 0) {
+                    tail = head;
+                }
+                return true;
+            }
+
+            // when full the oldest pending record is overwritten
+            bool append(const MqttMessage & message)
+            {
+                uint8_t buffer[SLOT_SIZE];
+                memset(buffer, 0xFF, sizeof(buffer));
+                if (encodeMessage(message, buffer + HEADER_SIZE, MAX_LEN_ENCODED_MESSAGE) == 0) {
+                    return false;
+                }
+                if (count == CAPACITY) {
+                    tail = (tail + 1) % CAPACITY;
+                    count--;
+                    dropped++;
+                }
+                buffer[0] = MAGIC;
+                buffer[1] = STATE_PENDING;
+                memcpy(buffer + 2, &nextSequence, sizeof(nextSequence));
+                uint16_t crc = crc16(buffer + HEADER_SIZE, MAX_LEN_ENCODED_MESSAGE, crc16(buffer + 2, sizeof(nextSequence)));
+                memcpy(buffer + 6, &crc, sizeof(crc));
+                if (!file.seek((uint32_t)head * SLOT_SIZE) || file.write(buffer, SLOT_SIZE) != SLOT_SIZE) {
+                    return false;
+                }
+                file.flush();
+                if (count == 0) {
+                    tail = head;
+                }
+                head = (head + 1) % CAPACITY;
+                nextSequence++;
+                count++;
+                return true;
+            }
+
+            // oldest pending message, unreadable records are skipped
+            bool peek(MqttMessage & message)
+            {
+                while (count > 0) {
+                    uint8_t buffer[SLOT_SIZE] {0};
+                    uint8_t state {0};
+                    uint32_t sequence {0};
+                    message = {};
+                    if (readSlot(tail, buffer, state, sequence) && decodeMessage(buffer + HEADER_SIZE, MAX_LEN_ENCODED_MESSAGE, message)) {
+                        return true;
+                    }
+                    tail = (tail + 1) % CAPACITY;
+                    count--;
+                    dropped++;
+                }
+                return false;
+            }
+
+            // marks the oldest pending message as sent
+            bool pop()
+            {
+                if (count == 0) {
+                    return false;
+                }
+                if (!markSent(tail)) {
+                    return false;
+                }
+                tail = (tail + 1) % CAPACITY;
+                count--;
+                return true;
+            }
+
+            uint16_t size() const { return count; }
+            uint16_t getDropped() const { return dropped; }
+    };
+}
+
+#endif
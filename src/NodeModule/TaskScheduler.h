@@ -0,0 +1,110 @@
+#ifndef NODE_MODULE_TASK_SCHEDULER_H
+#define NODE_MODULE_TASK_SCHEDULER_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // time a task may use in one run, tasks with more work check expired() between items
+    class TaskBudget
+    {
+        private:
+            const unsigned long start;
+            const unsigned long budget;
+
+        public:
+            TaskBudget(unsigned long start, unsigned long budget):
+                start(start), budget(budget)
+            {}
+
+            bool expired() const { return micros() - start >= budget; }
+    };
+
+    struct TaskStats
+    {
+        const char * name {nullptr};
+        unsigned long runs {0};
+        unsigned long overruns {0};
+        unsigned long maxTime {0};
+        unsigned long long totalTime {0};
+
+        unsigned long averageTime() const { return runs > 0 ? totalTime / runs : 0; }
+    };
+
+    // cooperative scheduler, due tasks run in the order they were added
+    // every task is limited by its budget so the worst case loop time is the sum of budgets
+    // a task returning true has more work and runs again on the next pass without waiting for its period
+    template<uint8_t MAX_TASKS>
+    class TaskScheduler
+    {
+        public:
+            typedef bool (*TaskFunction)(const TaskBudget & budget);
+
+        private:
+            struct Task
+            {
+                TaskFunction function {nullptr};
+                // ms between runs, 0 runs on every pass
+                uint16_t period {0};
+                // us per run
+                uint16_t budget {0};
+                unsigned long lastRun {0};
+                bool pending {false};
+                TaskStats stats;
+            };
+
+            Task tasks[MAX_TASKS] {};
+            uint8_t taskCount {0};
+            unsigned long maxLoopTime {0};
+            unsigned long long totalLoopTime {0};
+            unsigned long loops {0};
+
+        public:
+            bool add(const char * name, TaskFunction function, uint16_t period, uint16_t budget)
+            {
+                if (taskCount >= MAX_TASKS) {
+                    return false;
+                }
+                Task & task = tasks[taskCount++];
+                task.function = function;
+                task.period = period;
+                task.budget = budget;
+                task.stats.name = name;
+                return true;
+            }
+
+            // one pass over all tasks, returns the pass time in us
+            unsigned long run()
+            {
+                unsigned long loopStart = micros();
+                for (uint8_t i = 0; i < taskCount; i++) {
+                    Task & task = tasks[i];
+                    unsigned long now = millis();
+                    if (!task.pending && task.period > 0 && now - task.lastRun < task.period) {
+                        continue;
+                    }
+                    task.lastRun = now;
+                    unsigned long start = micros();
+                    task.pending = task.function(TaskBudget(start, task.budget));
+                    unsigned long elapsed = micros() - start;
+
+                    task.stats.runs++;
+                    task.stats.totalTime += elapsed;
+                    task.stats.overruns += elapsed > task.budget ? 1 : 0;
+                    task.stats.maxTime = elapsed > task.stats.maxTime ? elapsed : task.stats.maxTime;
+                }
+                unsigned long loopTime = micros() - loopStart;
+                loops++;
+                totalLoopTime += loopTime;
+                maxLoopTime = loopTime > maxLoopTime ? loopTime : maxLoopTime;
+                return loopTime;
+            }
+
+            uint8_t size() const { return taskCount; }
+            const TaskStats & getStats(uint8_t index) const { return tasks[index].stats; }
+            unsigned long getMaxLoopTime() const { return maxLoopTime; }
+            unsigned long getAverageLoopTime() const { return loops > 0 ? totalLoopTime / loops : 0; }
+    };
+}
+
+#endif
@@ -0,0 +1,257 @@
+#ifndef NODE_MODULE_TOPIC_ALIASES_H
+#define NODE_MODULE_TOPIC_ALIASES_H
+
+#include <Arduino.h>
+#include "MqttModule/MqttMessage.h"
+#include "MessageCodec.h"
+#include "TopicMatch.h"
+
+namespace NodeModule
+{
+    using MqttModule::MqttMessage;
+
+    // aliases the gateway defines for one node, nodes keep at least this many definitions
+    // so an ALIAS_USE from the gateway does not miss because the node had to drop the definition
+    const uint8_t MAX_NODE_ALIASES {2};
+
+    // alias to topic mapping per peer
+    // used by the receiving side to expand aliases and by the gateway to pick aliases for outgoing topics
+    // when full a peer replaces its own definitions in turn, only a peer without any takes one of another peer
+    // so a busy node can not push out the aliases of the others, peers recover through ALIAS_RESET
+    template<uint8_t SIZE>
+    class TopicAliasTable
+    {
+        private:
+            static const uint8_t MAX_ALIAS {0xFF};
+
+            struct Entry
+            {
+                uint16_t peer {0};
+                uint8_t alias {0};
+                uint32_t hash {0};
+                char topic[MQTT_MAX_LEN_TOPIC] {0};
+            };
+
+            Entry entries[SIZE] {};
+            uint8_t nextReplaced {0};
+            uint8_t nextRedefined {0};
+            uint16_t replaced {0};
+
+            Entry * find(uint16_t peer, uint8_t alias)
+            {
+                for (auto & entry: entries) {
+                    if (entry.alias == alias && entry.peer == peer) {
+                        return &entry;
+                    }
+                }
+                return nullptr;
+            }
+
+            Entry & freeEntry(uint16_t peer)
+            {
+                for (auto & entry: entries) {
+                    if (entry.alias == 0) {
+                        return entry;
+                    }
+                }
+                replaced += replaced < 0xFFFF ? 1 : 0;
+                for (uint8_t i = 0; i < SIZE; i++) {
+                    uint8_t index = (nextReplaced + i) % SIZE;
+                    if (entries[index].peer == peer) {
+                        nextReplaced = (index + 1) % SIZE;
+                        return entries[index];
+                    }
+                }
+                Entry & entry = entries[nextReplaced];
+                nextReplaced = (nextReplaced + 1) % SIZE;
+                return entry;
+            }
+
+        public:
+            const char * getTopic(uint16_t peer, uint8_t alias)
+            {
+                Entry * entry = find(peer, alias);
+                return entry ? entry->topic : nullptr;
+            }
+
+            // returns 0 if topic has no alias
+            uint8_t getAlias(uint16_t peer, const char * topic) const
+            {
+                uint32_t hash = topicHash(topic);
+                for (const auto & entry: entries) {
+                    if (entry.alias > 0 && entry.peer == peer && entry.hash == hash && strcmp(entry.topic, topic) == 0) {
+                        return entry.alias;
+                    }
+                }
+                return 0;
+            }
+
+            bool define(uint16_t peer, uint8_t alias, const char * topic)
+            {
+                if (alias == 0 || strlen(topic) >= MQTT_MAX_LEN_TOPIC) {
+                    return false;
+                }
+                Entry * entry = find(peer, alias);
+                if (!entry) {
+                    entry = &freeEntry(peer);
+                }
+                entry->peer = peer;
+                entry->alias = alias;
+                entry->hash = topicHash(topic);
+                strcpy(entry->topic, topic);
+                return true;
+            }
+
+            // defines the topic with an alias not yet used for the peer
+            // a peer gets at most maxAliases, after that its aliases are defined again in turn
+            uint8_t assign(uint16_t peer, const char * topic, uint8_t maxAliases = MAX_ALIAS)
+            {
+                if (maxAliases == 0) {
+                    return 0;
+                }
+                for (uint16_t alias = 1; alias <= maxAliases; alias++) {
+                    if (!find(peer, alias)) {
+                        return define(peer, alias, topic) ? alias : 0;
+                    }
+                }
+                replaced += replaced < 0xFFFF ? 1 : 0;
+                uint8_t alias = nextRedefined % maxAliases + 1;
+                nextRedefined++;
+                return define(peer, alias, topic) ? alias : 0;
+            }
+
+            void remove(uint16_t peer, uint8_t alias)
+            {
+                Entry * entry = find(peer, alias);
+                if (entry) {
+                    *entry = {};
+                }
+            }
+
+            void clear(uint16_t peer)
+            {
+                for (auto & entry: entries) {
+                    if (entry.peer == peer) {
+                        entry = {};
+                    }
+                }
+            }
+
+            // stores definitions and expands aliases of a received frame
+            // returns false if the alias is unknown or the frame carries no message
+            bool resolve(FrameType frameType, uint16_t peer, uint8_t alias, MqttMessage & message)
+            {
+                if (frameType == FrameType::AliasDefine) {
+                    return define(peer, alias, message.topic);
+                }
+                if (frameType == FrameType::AliasUse) {
+                    const char * topic = getTopic(peer, alias);
+                    if (!topic) {
+                        return false;
+                    }
+                    strcpy(message.topic, topic);
+                }
+                return frameType == FrameType::Message || frameType == FrameType::AliasUse;
+            }
+
+            uint8_t used() const
+            {
+                uint8_t count {0};
+                for (const auto & entry: entries) {
+                    count += entry.alias > 0 ? 1 : 0;
+                }
+                return count;
+            }
+
+            // definitions dropped to make room for new ones
+            uint16_t getReplaced() const { return replaced; }
+    };
+
+    // sending side of the aliases when RAM is short, only topic hashes are kept
+    // alias is the slot index + 1, slots are reused in order
+    // topics are not compared, two topics of a node with the same 32 bit hash would share an alias
+    // and the second one is published under the first topic, for a few pin topics the chance is about n^2 / 2^33
+    template<uint8_t SIZE>
+    class TopicAliasCache
+    {
+        private:
+            uint32_t hashes[SIZE] {0};
+            uint8_t nextSlot {0};
+            uint16_t replaced {0};
+
+        public:
+            // returns 0 if topic has no alias
+            uint8_t getAlias(const char * topic) const
+            {
+                uint32_t hash = topicHash(topic);
+                for (uint8_t i = 0; i < SIZE; i++) {
+                    if (hashes[i] == hash) {
+                        return i + 1;
+                    }
+                }
+                return 0;
+            }
+
+            uint8_t assign(const char * topic)
+            {
+                uint8_t slot = nextSlot;
+                nextSlot = (nextSlot + 1) % SIZE;
+                if (hashes[slot] != 0) {
+                    replaced += replaced < 0xFFFF ? 1 : 0;
+                }
+                hashes[slot] = topicHash(topic);
+                return slot + 1;
+            }
+
+            void remove(uint8_t alias)
+            {
+                if (alias > 0 && alias <= SIZE) {
+                    hashes[alias - 1] = 0;
+                }
+            }
+
+            void clear()
+            {
+                memset(hashes, 0, sizeof(hashes));
+            }
+
+            uint8_t used() const
+            {
+                uint8_t count {0};
+                for (auto hash: hashes) {
+                    count += hash != 0 ? 1 : 0;
+                }
+                return count;
+            }
+
+            // aliases taken over by another topic, the topics outnumber SIZE
+            uint16_t getReplaced() const { return replaced; }
+    };
+
+    // sends ALIAS_USE if the alias is defined, ALIAS_DEFINE otherwise
+    // alias is set to 0 when the definition does not fit and message is sent with the full topic
+    template<typename Transport>
+    bool sendAliasedMessage(Transport & transport, uint8_t & alias, bool isDefined, const MqttMessage & message, uint8_t type, uint16_t node, const FrameSequence & sequence = {})
+    {
+        uint8_t buffer[MAX_LEN_ENCODED_MESSAGE] {0};
+        uint16_t headerLength = encodeSequence(sequence, buffer, sizeof(buffer));
+        uint8_t * frame = buffer + headerLength;
+        uint16_t frameLength = sizeof(buffer) - headerLength;
+        uint16_t length {0};
+        if (alias > 0) {
+            length = isDefined
+                ? encodeAliasUse(alias, message, frame, frameLength)
+                : encodeAliasDefine(alias, message, frame, frameLength);
+        }
+        if (length == 0) {
+            alias = 0;
+            length = encodeMessage(message, frame, frameLength);
+        }
+        if (length == 0 && headerLength > 0) {
+            return sendCompactMessage(transport, message, type, node);
+        }
+        return length > 0 && transport.send(buffer, headerLength + length, toCompactType(type), node);
+    }
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef NODE_MODULE_TOPIC_CACHE_H
+#define NODE_MODULE_TOPIC_CACHE_H
+
+#include <Arduino.h>
+#include "MqttModule/MqttMessage.h"
+
+namespace NodeModule
+{
+    // topics formatted once at startup, publishing only copies them
+    // the prefix shared by all topics (usually MQTT_CLIENT_NAME) is stored once:
+    //
+    // [shared prefix][suffix 0][suffix 1]...
+    //
+    // COUNT topics in SIZE bytes without terminators
+    template<uint8_t COUNT, uint16_t SIZE>
+    class TopicCache
+    {
+        private:
+            char text[SIZE] {0};
+            // end of each suffix in text
+            uint16_t ends[COUNT] {0};
+            uint8_t prefix {0};
+            uint8_t count {0};
+
+        public:
+            // format(index, topic, size) writes topic index, returns false when it can not
+            // topics are formatted twice, the first pass finds the shared prefix
+            template<typename Format>
+            bool build(uint8_t size, Format format)
+            {
+                count = 0;
+                if (size > COUNT) {
+                    return false;
+                }
+                char first[MQTT_MAX_LEN_TOPIC] {0};
+                char topic[MQTT_MAX_LEN_TOPIC] {0};
+                uint8_t shared {0};
+                for (uint8_t i = 0; i < size; i++) {
+                    if (!format(i, i == 0 ? first : topic, MQTT_MAX_LEN_TOPIC)) {
+                        return false;
+                    }
+                    if (i == 0) {
+                        shared = strlen(first);
+                        continue;
+                    }
+                    uint8_t same {0};
+                    while (same < shared && topic[same] == first[same]) {
+                        same++;
+                    }
+                    shared = same;
+                }
+                if (shared > SIZE) {
+                    return false;
+                }
+                prefix = shared;
+                memcpy(text, first, prefix);
+                uint16_t end {prefix};
+                for (uint8_t i = 0; i < size; i++) {
+                    format(i, topic, MQTT_MAX_LEN_TOPIC);
+                    uint16_t length = strlen(topic) - prefix;
+                    if (end + length > SIZE) {
+                        return false;
+                    }
+                    memcpy(text + end, topic + prefix, length);
+                    end += length;
+                    ends[i] = end;
+                }
+                count = size;
+                return true;
+            }
+
+            // writes the terminated topic, false for an unknown index or a short buffer
+            bool copy(uint8_t index, char * topic, uint8_t size) const
+            {
+                if (index >= count) {
+                    return false;
+                }
+                uint16_t start = index > 0 ? ends[index - 1] : prefix;
+                uint16_t length = ends[index] - start;
+                if (prefix + length >= size) {
+                    return false;
+                }
+                memcpy(topic, text, prefix);
+                memcpy(topic + prefix, text + start, length);
+                topic[prefix + length] = '\0';
+                return true;
+            }
+
+            uint8_t size() const { return count; }
+    };
+}
+
+#endif
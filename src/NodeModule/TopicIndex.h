@@ -0,0 +1,229 @@
+#ifndef NODE_MODULE_TOPIC_INDEX_H
+#define NODE_MODULE_TOPIC_INDEX_H
+
+#include <Arduino.h>
+#include "MqttModule/MqttConfig.h"
+#include "TopicMatch.h"
+
+namespace NodeModule
+{
+    // topic filters and the nodes subscribed to them
+    // filters are stored as a tree of topic levels kept in a hash table keyed by (parent, level hash)
+    // lookup cost depends on the number of topic levels instead of the number of filters
+    template<uint16_t MAX_FILTERS, uint8_t MAX_NODES_PER_FILTER, uint16_t MAX_LEVELS = MAX_FILTERS * 3>
+    class TopicIndex
+    {
+        private:
+            static const uint16_t NONE {0xFFFF};
+            static const uint16_t TABLE_SIZE {MAX_LEVELS * 2 + 1};
+
+            struct Filter
+            {
+                char topic[MQTT_MAX_LEN_TOPIC] {0};
+                uint16_t nodes[MAX_NODES_PER_FILTER] {0};
+            };
+
+            struct Level
+            {
+                uint32_t hash {0};
+                uint16_t parent {0};
+                uint16_t filter {NONE};
+            };
+
+            Filter filters[MAX_FILTERS] {};
+            uint16_t filterCount {0};
+            // level 0 is the root
+            Level levels[MAX_LEVELS + 1] {};
+            uint16_t levelCount {1};
+            // level index by (parent, hash), 0 is empty
+            uint16_t table[TABLE_SIZE] {0};
+
+            uint16_t tableSlot(uint16_t parent, uint32_t hash) const
+            {
+                return (hash ^ (parent * 2654435761UL)) % TABLE_SIZE;
+            }
+
+            uint16_t findLevel(uint16_t parent, uint32_t hash) const
+            {
+                for (uint16_t slot = tableSlot(parent, hash); table[slot] != 0; slot = (slot + 1) % TABLE_SIZE) {
+                    const Level & level = levels[table[slot]];
+                    if (level.parent == parent && level.hash == hash) {
+                        return table[slot];
+                    }
+                }
+                return 0;
+            }
+
+            uint16_t addLevel(uint16_t parent, uint32_t hash)
+            {
+                uint16_t index = findLevel(parent, hash);
+                if (index > 0) {
+                    return index;
+                }
+                if (levelCount > MAX_LEVELS) {
+                    return 0;
+                }
+                index = levelCount++;
+                levels[index].hash = hash;
+                levels[index].parent = parent;
+                uint16_t slot = tableSlot(parent, hash);
+                while (table[slot] != 0) {
+                    slot = (slot + 1) % TABLE_SIZE;
+                }
+                table[slot] = index;
+                return index;
+            }
+
+            // levels of the topic not in the tree yet, every level below a missing one is missing too
+            uint16_t missingLevels(const char * topic) const
+            {
+                uint16_t index {0};
+                uint16_t missing {0};
+                const char * level = topic;
+                while (true) {
+                    const char * end = topicLevelEnd(level);
+                    if (missing == 0) {
+                        index = findLevel(index, topicLevelHash(level, end));
+                    }
+                    missing += index == 0 ? 1 : 0;
+                    if (*end == '\0') {
+                        return missing;
+                    }
+                    level = end + 1;
+                }
+            }
+
+            uint16_t findFilter(const char * topic) const
+            {
+                uint16_t index {0};
+                const char * level = topic;
+                while (true) {
+                    const char * end = topicLevelEnd(level);
+                    index = findLevel(index, topicLevelHash(level, end));
+                    if (index == 0) {
+                        return NONE;
+                    }
+                    if (*end == '\0') {
+                        break;
+                    }
+                    level = end + 1;
+                }
+                uint16_t filter = levels[index].filter;
+                return filter != NONE && strcmp(filters[filter].topic, topic) == 0 ? filter : NONE;
+            }
+
+            uint8_t addNodes(uint16_t filter, const char * topic, uint16_t * nodes, uint8_t count, uint8_t maxNodes) const
+            {
+                // guards against level hash collisions
+                if (!topicMatches(filters[filter].topic, topic)) {
+                    return count;
+                }
+                for (auto node: filters[filter].nodes) {
+                    if (node == 0) {
+                        break;
+                    }
+                    bool exists {false};
+                    for (uint8_t i = 0; i < count; i++) {
+                        exists = exists || nodes[i] == node;
+                    }
+                    if (!exists && count < maxNodes) {
+                        nodes[count++] = node;
+                    }
+                }
+                return count;
+            }
+
+            uint8_t collect(uint16_t index, const char * level, const char * topic, uint16_t * nodes, uint8_t count, uint8_t maxNodes) const
+            {
+                uint16_t multiLevel = findLevel(index, topicLevelHash("#"));
+                if (multiLevel > 0 && levels[multiLevel].filter != NONE) {
+                    count = addNodes(levels[multiLevel].filter, topic, nodes, count, maxNodes);
+                }
+                if (!level) {
+                    return levels[index].filter != NONE ? addNodes(levels[index].filter, topic, nodes, count, maxNodes) : count;
+                }
+                const char * end = topicLevelEnd(level);
+                const char * next = *end == '\0' ? nullptr : end + 1;
+                uint16_t child = findLevel(index, topicLevelHash(level, end));
+                if (child > 0) {
+                    count = collect(child, next, topic, nodes, count, maxNodes);
+                }
+                uint16_t singleLevel = findLevel(index, topicLevelHash("+"));
+                if (singleLevel > 0) {
+                    count = collect(singleLevel, next, topic, nodes, count, maxNodes);
+                }
+                return count;
+            }
+
+        public:
+            // adds node to the filter, filter is created if it does not exist
+            bool add(const char * topic, uint16_t node)
+            {
+                if (strlen(topic) >= MQTT_MAX_LEN_TOPIC) {
+                    return false;
+                }
+                uint16_t filter = findFilter(topic);
+                if (filter == NONE) {
+                    // checked up front, levels added for a filter that does not fit would stay unused
+                    if (filterCount >= MAX_FILTERS || levelCount + missingLevels(topic) > MAX_LEVELS + 1) {
+                        return false;
+                    }
+                    uint16_t index {0};
+                    const char * level = topic;
+                    while (true) {
+                        const char * end = topicLevelEnd(level);
+                        index = addLevel(index, topicLevelHash(level, end));
+                        if (index == 0) {
+                            return false;
+                        }
+                        if (*end == '\0') {
+                            break;
+                        }
+                        level = end + 1;
+                    }
+                    // level hash collision with another filter
+                    if (levels[index].filter != NONE) {
+                        return false;
+                    }
+                    filter = filterCount++;
+                    strcpy(filters[filter].topic, topic);
+                    levels[index].filter = filter;
+                }
+                for (auto & existing: filters[filter].nodes) {
+                    if (existing == node) {
+                        return true;
+                    }
+                    if (existing == 0) {
+                        existing = node;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            // exact filter lookup
+            bool hasSubscribed(const char * topic) const
+            {
+                return findFilter(topic) != NONE;
+            }
+
+            // nodes subscribed to any filter matching the topic, each node is returned once
+            uint8_t getSubscribedNodes(const char * topic, uint16_t * nodes, uint8_t maxNodes) const
+            {
+                return collect(0, topic, topic, nodes, 0, maxNodes);
+            }
+
+            uint16_t size() const
+            {
+                return filterCount;
+            }
+
+            // filters in the order they were added, used to subscribe again after reconnect
+            const char * getFilter(uint16_t index) const
+            {
+                return index < filterCount ? filters[index].topic : nullptr;
+            }
+    };
+}
+
+#endif
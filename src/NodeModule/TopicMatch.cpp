@@ -0,0 +1,60 @@
+#include "TopicMatch.h"
+
+namespace NodeModule
+{
+    const char * topicLevelEnd(const char * level)
+    {
+        while (*level != '\0' && *level != '/') {
+            level++;
+        }
+        return level;
+    }
+
+    // fnv-1a
+    uint32_t topicLevelHash(const char * level, const char * end)
+    {
+        uint32_t hash {2166136261UL};
+        while (level < end) {
+            hash ^= (uint8_t)*level++;
+            hash *= 16777619UL;
+        }
+        return hash;
+    }
+
+    uint32_t topicLevelHash(const char * level)
+    {
+        return topicLevelHash(level, topicLevelEnd(level));
+    }
+
+    uint32_t topicHash(const char * topic)
+    {
+        return topicLevelHash(topic, topic + strlen(topic));
+    }
+
+    bool topicMatches(const char * filter, const char * topic)
+    {
+        // wildcards do not match system topics
+        if (topic[0] == '$' && (filter[0] == '+' || filter[0] == '#')) {
+            return false;
+        }
+        while (true) {
+            const char * filterEnd = topicLevelEnd(filter);
+            const char * topicEnd = topicLevelEnd(topic);
+            size_t filterLength = filterEnd - filter;
+            bool isWildcard = filterLength == 1 && (*filter == '+' || *filter == '#');
+
+            if (isWildcard && *filter == '#') {
+                return true;
+            }
+            if (!isWildcard && (filterLength != (size_t)(topicEnd - topic) || strncmp(filter, topic, filterLength) != 0)) {
+                return false;
+            }
+            if (*filterEnd == '\0' || *topicEnd == '\0') {
+                // "a/#" matches "a" as well
+                return *topicEnd == '\0' && (*filterEnd == '\0' || strcmp(filterEnd, "/#") == 0);
+            }
+            filter = filterEnd + 1;
+            topic = topicEnd + 1;
+        }
+    }
+}
@@ -0,0 +1,21 @@
+#ifndef NODE_MODULE_TOPIC_MATCH_H
+#define NODE_MODULE_TOPIC_MATCH_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // end of the current topic level (next '/' or '\0')
+    const char * topicLevelEnd(const char * level);
+
+    uint32_t topicLevelHash(const char * level, const char * end);
+    uint32_t topicLevelHash(const char * level);
+
+    // hash of the whole topic
+    uint32_t topicHash(const char * topic);
+
+    // mqtt filter matching with '+' and '#' wildcards
+    bool topicMatches(const char * filter, const char * topic);
+}
+
+#endif
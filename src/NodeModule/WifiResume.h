@@ -0,0 +1,131 @@
+#ifndef NODE_MODULE_WIFI_RESUME_H
+#define NODE_MODULE_WIFI_RESUME_H
+
+#include <Arduino.h>
+
+namespace NodeModule
+{
+    // wifi and broker connection of the last wake, kept over deep sleep so the next wake
+    // can join the same access point on its channel without a scan and skip dhcp and dns
+    //
+    // addresses are IPAddress values as uint32_t
+    struct ResumeState
+    {
+        uint32_t crc {0};
+        uint32_t ip {0};
+        uint32_t gateway {0};
+        uint32_t subnet {0};
+        uint32_t dns {0};
+        uint32_t broker {0};
+        uint8_t bssid[6] {0};
+        uint8_t channel {0};
+        uint8_t accessPoint {0};
+        // wakes since the last full connect, used to renew the lease now and then
+        uint16_t wakes {0};
+        uint16_t reserved {0};
+    };
+
+    static_assert(sizeof(ResumeState) % 4 == 0, "rtc memory is accessed in 4 byte blocks");
+
+    // rtc user memory of the esp8266, survives deep sleep but not a power loss
+    // offset is in 4 byte blocks, the first 32 blocks are used by ota on the chip
+    //
+    // Esp is EspClass (src/HostHal keeps it in a file)
+    template<typename Esp>
+    class RtcStore
+    {
+        private:
+            Esp & esp;
+            const uint32_t offset;
+
+        public:
+            RtcStore(Esp & esp, uint32_t offset = 32):
+                esp(esp), offset(offset)
+            {}
+
+            bool read(void * data, size_t size)
+            {
+                return esp.rtcUserMemoryRead(offset, (uint32_t *)data, size);
+            }
+
+            bool write(const void * data, size_t size)
+            {
+                return esp.rtcUserMemoryWrite(offset, (uint32_t *)data, size);
+            }
+    };
+
+    // crc checked ResumeState in a Store with read(data, size) and write(data, size)
+    template<typename Store>
+    class WifiResume
+    {
+        private:
+            Store & store;
+            ResumeState state;
+            bool valid {false};
+
+            static uint32_t crc32(const uint8_t * data, size_t length)
+            {
+                uint32_t crc {0xFFFFFFFF};
+                for (size_t i = 0; i < length; i++) {
+                    crc ^= data[i];
+                    for (uint8_t bit = 0; bit < 8; bit++) {
+                        crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+                    }
+                }
+                return ~crc;
+            }
+
+            static uint32_t checksum(const ResumeState & state)
+            {
+                return crc32((const uint8_t *)&state + sizeof(state.crc), sizeof(state) - sizeof(state.crc));
+            }
+
+        public:
+            WifiResume(Store & store):
+                store(store)
+            {}
+
+            // true when the store holds a state written by save
+            bool load()
+            {
+                valid = store.read(&state, sizeof(state)) && state.crc == checksum(state);
+                if (!valid) {
+                    state = ResumeState();
+                }
+                return valid;
+            }
+
+            bool save(const ResumeState & value)
+            {
+                state = value;
+                state.crc = checksum(state);
+                valid = store.write(&state, sizeof(state));
+                return valid;
+            }
+
+            // counts a resumed wake, false once maxWakes are reached and a full connect is due
+            bool resumed(uint16_t maxWakes)
+            {
+                if (!valid || state.wakes >= maxWakes) {
+                    return false;
+                }
+                ResumeState next = state;
+                next.wakes++;
+                return save(next);
+            }
+
+            // forget the state e.g. when the access point or the lease changed
+            void clear()
+            {
+                state = ResumeState();
+                state.crc = ~checksum(state);
+                store.write(&state, sizeof(state));
+                valid = false;
+            }
+
+            bool isValid() const { return valid; }
+            const ResumeState & get() const { return state; }
+    };
+}
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef TESTS_CHECK_H
+#define TESTS_CHECK_H
+
+#include <stdio.h>
+
+// failed checks are printed with their line, the test goes on and main returns report()
+static uint16_t failedChecks {0};
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("%s:%d: failed %s\n", __FILE__, __LINE__, #condition); \
+            failedChecks++; \
+        } \
+    } while (0)
+
+static int report(const char * name)
+{
+    printf("%s: %s\n", name, failedChecks == 0 ? "ok" : "failed");
+    return failedChecks == 0 ? 0 : 1;
+}
+
+#endif
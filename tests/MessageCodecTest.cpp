@@ -0,0 +1,192 @@
+#include <Arduino.h>
+#include "NodeModule/MessageCodec.h"
+#include "Check.h"
+
+using MqttModule::MqttMessage;
+using NodeModule::FrameType;
+using NodeModule::FrameSequence;
+using NodeModule::MessageBatch;
+using NodeModule::BatchReader;
+using NodeModule::MAX_LEN_ENCODED_MESSAGE;
+using NodeModule::SEQUENCE_HEADER_SIZE;
+
+static MqttMessage message(const char * topic, const char * text)
+{
+    MqttMessage result;
+    strncpy(result.topic, topic, sizeof(result.topic) - 1);
+    strncpy(result.message, text, sizeof(result.message) - 1);
+    return result;
+}
+
+static bool equal(const MqttMessage & a, const MqttMessage & b)
+{
+    return strcmp(a.topic, b.topic) == 0 && strcmp(a.message, b.message) == 0;
+}
+
+static void plainMessage()
+{
+    uint8_t buffer[MAX_LEN_ENCODED_MESSAGE] {0};
+    MqttMessage sent = message("home/room/states/digital/2", "1");
+    uint16_t length = NodeModule::encodeMessage(sent, buffer, sizeof(buffer));
+    // only used bytes are sent
+    CHECK(length == 1 + strlen(sent.topic) + 1 + 1);
+
+    MqttMessage received;
+    uint8_t alias {0};
+    CHECK(NodeModule::decodeFrame(buffer, length, received, alias) == FrameType::Message);
+    CHECK(equal(sent, received));
+    // cut frames are invalid
+    CHECK(NodeModule::decodeFrame(buffer, length - 1, received, alias) == FrameType::Invalid);
+    // and so is a frame that does not fit the buffer
+    CHECK(NodeModule::encodeMessage(sent, buffer, length - 1) == 0);
+}
+
+static void aliases()
+{
+    uint8_t buffer[MAX_LEN_ENCODED_MESSAGE] {0};
+    MqttMessage sent = message("home/room/set/json", "{\"2\":1}");
+    MqttMessage received;
+    uint8_t alias {0};
+
+    uint16_t length = NodeModule::encodeAliasDefine(7, sent, buffer, sizeof(buffer));
+    CHECK(length > 0);
+    CHECK(NodeModule::decodeFrame(buffer, length, received, alias) == FrameType::AliasDefine);
+    CHECK(alias == 7);
+    CHECK(equal(sent, received));
+
+    alias = 0;
+    length = NodeModule::encodeAliasUse(7, sent, buffer, sizeof(buffer));
+    CHECK(length == 2 + 1 + strlen(sent.message));
+    CHECK(NodeModule::decodeFrame(buffer, length, received, alias) == FrameType::AliasUse);
+    CHECK(alias == 7);
+    // the receiver fills in the topic
+    CHECK(received.topic[0] == '\0');
+    CHECK(strcmp(received.message, sent.message) == 0);
+
+    // alias 0 means no alias
+    buffer[1] = 0;
+    CHECK(NodeModule::decodeFrame(buffer, length, received, alias) == FrameType::Invalid);
+
+    uint8_t reset[] {NodeModule::ALIAS_RESET};
+    CHECK(NodeModule::decodeFrame(reset, sizeof(reset), received, alias) == FrameType::AliasReset);
+    uint8_t restart[] {NodeModule::RESTART};
+    CHECK(NodeModule::decodeFrame(restart, sizeof(restart), received, alias) == FrameType::Restart);
+}
+
+static void sequenced()
+{
+    uint8_t buffer[MAX_LEN_ENCODED_MESSAGE] {0};
+    MqttMessage sent = message("home/room/set/json", "{\"2\":0}");
+    MqttMessage received;
+    uint8_t alias {0};
+    FrameSequence sequence {0xBEEF, true, true};
+
+    uint16_t header = NodeModule::encodeSequence(sequence, buffer, sizeof(buffer));
+    CHECK(header == SEQUENCE_HEADER_SIZE);
+    uint16_t length = header + NodeModule::encodeAliasDefine(3, sent, buffer + header, sizeof(buffer) - header);
+    FrameSequence decoded;
+    CHECK(NodeModule::decodeFrame(buffer, length, received, alias, decoded) == FrameType::AliasDefine);
+    CHECK(decoded.present && decoded.ackRequested && decoded.number == 0xBEEF);
+    CHECK(alias == 3);
+    CHECK(equal(sent, received));
+
+    sequence.ackRequested = false;
+    NodeModule::encodeSequence(sequence, buffer, sizeof(buffer));
+    CHECK(NodeModule::decodeFrame(buffer, length, received, alias, decoded) == FrameType::AliasDefine);
+    CHECK(decoded.present && !decoded.ackRequested);
+
+    // sequence without a frame, and nested sequences, are invalid
+    CHECK(NodeModule::decodeFrame(buffer, SEQUENCE_HEADER_SIZE, received, alias, decoded) == FrameType::Invalid);
+    NodeModule::encodeSequence(sequence, buffer + SEQUENCE_HEADER_SIZE, sizeof(buffer) - SEQUENCE_HEADER_SIZE);
+    CHECK(NodeModule::decodeFrame(buffer, length, received, alias, decoded) == FrameType::Invalid);
+
+    // not present is not encoded
+    CHECK(NodeModule::encodeSequence({}, buffer, sizeof(buffer)) == 0);
+
+    uint8_t ack[SEQUENCE_HEADER_SIZE] {0};
+    CHECK(NodeModule::encodeAck(0x1234, ack, sizeof(ack)) == SEQUENCE_HEADER_SIZE);
+    CHECK(NodeModule::decodeFrame(ack, sizeof(ack), received, alias, decoded) == FrameType::Ack);
+    CHECK(decoded.number == 0x1234 && !decoded.present);
+}
+
+static void batch()
+{
+    MessageBatch batch;
+    MqttMessage sent[] {
+        message("room/digital/2", "1"),
+        message("room/digital/3", "0"),
+        message("room/analog/0", "512"),
+        message("hall/alive", "1"),
+    };
+    for (const auto & entry: sent) {
+        CHECK(batch.add(entry));
+    }
+    CHECK(batch.size() == 4);
+    // shared topic starts are sent once
+    CHECK(batch.getLength() < 2 + (1 + strlen(sent[0].topic) + 2) * 4);
+
+    // the frame as decodeFrame copies it into the message
+    MqttMessage frame;
+    uint8_t alias {0};
+    CHECK(NodeModule::decodeFrame(batch.getBuffer(), batch.getLength(), frame, alias) == FrameType::Batch);
+    BatchReader reader(frame);
+    MqttMessage received;
+    for (const auto & entry: sent) {
+        CHECK(reader.next(received));
+        CHECK(equal(entry, received));
+    }
+    CHECK(!reader.next(received));
+
+    // a message that does not fit leaves the batch as it was
+    MessageBatch full;
+    uint8_t count {0};
+    while (full.add(message("a/long/topic/name/for/the/batch/test", "123456789"))) {
+        count++;
+    }
+    CHECK(count > 0);
+    CHECK(full.size() == count);
+    CHECK(full.getLength() <= MessageBatch::MAX_LEN_BATCH);
+
+    full.clear();
+    CHECK(full.size() == 0);
+    CHECK(full.add(sent[0]));
+    BatchReader single(full.getBuffer(), full.getLength());
+    CHECK(single.next(received) && equal(sent[0], received));
+
+    // a rest length past the frame ends the batch
+    uint8_t broken[] {NodeModule::BATCH, 2, 0, 30, 'a'};
+    BatchReader malformed(broken, sizeof(broken));
+    CHECK(!malformed.next(received));
+}
+
+static void poll()
+{
+    uint8_t buffer[3] {0};
+    CHECK(NodeModule::encodePoll(1500, buffer, sizeof(buffer)) == 3);
+    MqttMessage frame;
+    uint8_t alias {0};
+    CHECK(NodeModule::decodeFrame(buffer, sizeof(buffer), frame, alias) == FrameType::Poll);
+    CHECK(NodeModule::getPollWindow(frame) == 1500);
+    CHECK(NodeModule::decodeFrame(buffer, 2, frame, alias) == FrameType::Invalid);
+    CHECK(NodeModule::encodePoll(1500, buffer, 2) == 0);
+}
+
+static void compactTypes()
+{
+    uint8_t type = NodeModule::toCompactType(2);
+    CHECK(NodeModule::isCompactType(type));
+    CHECK(!NodeModule::isCompactType(2));
+    CHECK(NodeModule::fromCompactType(type) == 2);
+    CHECK(NodeModule::fromCompactType(2) == 2);
+}
+
+int main()
+{
+    plainMessage();
+    aliases();
+    sequenced();
+    batch();
+    poll();
+    compactTypes();
+    return report("MessageCodecTest");
+}
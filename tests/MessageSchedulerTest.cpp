@@ -0,0 +1,201 @@
+#include <Arduino.h>
+#include "NodeModule/MessageScheduler.h"
+#include "Check.h"
+
+using NodeModule::MessageScheduler;
+using NodeModule::SendResult;
+
+const uint16_t INITIAL_DELAY {100};
+const uint16_t MAX_DELAY {1000};
+const uint8_t MAX_FAILURES {5};
+
+using Scheduler = MessageScheduler<uint8_t, 2, 3>;
+
+// payloads seen by the release callback, it has no context
+static uint8_t released[16] {0};
+static uint8_t releasedCount {0};
+
+static void release(uint8_t & payload)
+{
+    if (releasedCount < sizeof(released)) {
+        released[releasedCount] = payload;
+    }
+    releasedCount++;
+}
+
+// sender failing every time, records when it was called
+struct FailingSender
+{
+    unsigned long * calls;
+    uint8_t & count;
+    const unsigned long & now;
+
+    SendResult operator()(uint8_t &, uint16_t)
+    {
+        calls[count++] = now;
+        return SendResult::Failed;
+    }
+};
+
+static void backoffDoubles()
+{
+    Scheduler scheduler(INITIAL_DELAY, MAX_DELAY, MAX_FAILURES);
+    unsigned long calls[8] {0};
+    uint8_t count {0};
+    unsigned long now {0};
+    FailingSender sender {calls, count, now};
+    CHECK(scheduler.add(1, 7, now));
+    // called once per ms, the head is only tried when its delay is over
+    for (now = 0; now < 2000; now++) {
+        scheduler.process(sender, now);
+    }
+    CHECK(count == 5);
+    CHECK(calls[0] == 0);
+    CHECK(calls[1] == 100);
+    CHECK(calls[2] == 300);
+    CHECK(calls[3] == 700);
+    // capped at MAX_DELAY
+    CHECK(calls[4] == 1500);
+}
+
+static void dropAfterMaxFailures()
+{
+    releasedCount = 0;
+    Scheduler scheduler(INITIAL_DELAY, MAX_DELAY, 2, release);
+    unsigned long calls[8] {0};
+    uint8_t count {0};
+    unsigned long now {0};
+    FailingSender sender {calls, count, now};
+    scheduler.add(4, 7, now);
+    for (now = 0; now < 2000; now++) {
+        scheduler.process(sender, now);
+    }
+    // first try and two retries
+    CHECK(count == 3);
+    CHECK(scheduler.size() == 0);
+    CHECK(scheduler.getDropped() == 1);
+    CHECK(releasedCount == 1 && released[0] == 4);
+}
+
+static void dropOldestWhenFull()
+{
+    releasedCount = 0;
+    Scheduler scheduler(INITIAL_DELAY, MAX_DELAY, MAX_FAILURES, release);
+    for (uint8_t i = 1; i <= 4; i++) {
+        CHECK(scheduler.add(i, 7, 0));
+    }
+    CHECK(scheduler.size() == 3);
+    CHECK(scheduler.getDropped() == 1);
+    CHECK(releasedCount == 1 && released[0] == 1);
+
+    uint8_t sent[4] {0};
+    uint8_t count {0};
+    scheduler.process([&](uint8_t & payload, uint16_t) {
+        sent[count++] = payload;
+        return SendResult::Delivered;
+    }, 0);
+    CHECK(count == 3);
+    CHECK(sent[0] == 2 && sent[1] == 3 && sent[2] == 4);
+    // delivered items are released as well
+    CHECK(releasedCount == 4);
+}
+
+static void nodesAreIndependent()
+{
+    Scheduler scheduler(INITIAL_DELAY, MAX_DELAY, MAX_FAILURES);
+    scheduler.add(1, 7, 0);
+    scheduler.add(2, 8, 0);
+    // a third node has no queue left
+    CHECK(!scheduler.add(3, 9, 0));
+    CHECK(scheduler.getDropped() == 1);
+
+    uint8_t delivered {0};
+    auto sender = [&](uint8_t & payload, uint16_t node) {
+        if (node == 7) {
+            return SendResult::Failed;
+        }
+        delivered = payload;
+        return SendResult::Delivered;
+    };
+    CHECK(scheduler.process(sender, 0) == 1);
+    // node 8 was not held back by the failing node 7
+    CHECK(delivered == 2);
+    CHECK(scheduler.size() == 1);
+    // its queue is free for another node now
+    CHECK(scheduler.add(3, 9, 0));
+}
+
+static void maxAttempts()
+{
+    Scheduler scheduler(INITIAL_DELAY, MAX_DELAY, MAX_FAILURES);
+    scheduler.add(1, 7, 0);
+    scheduler.add(2, 7, 0);
+    scheduler.add(3, 8, 0);
+    uint8_t calls {0};
+    auto sender = [&](uint8_t &, uint16_t) {
+        calls++;
+        return SendResult::Delivered;
+    };
+    CHECK(scheduler.process(sender, 0, 2) == 2);
+    CHECK(calls == 2);
+    CHECK(scheduler.size() == 1);
+}
+
+static void awaitingAck()
+{
+    Scheduler scheduler(INITIAL_DELAY, MAX_DELAY, MAX_FAILURES);
+    scheduler.add(5, 7, 0);
+    auto sender = [](uint8_t &, uint16_t) {
+        return SendResult::AwaitingAck;
+    };
+    scheduler.process(sender, 0);
+    // kept until acknowledged
+    CHECK(scheduler.size() == 1);
+    CHECK(!scheduler.acknowledge(7, [](const uint8_t & payload) { return payload == 6; }));
+    CHECK(!scheduler.acknowledge(8, [](const uint8_t & payload) { return payload == 5; }));
+    CHECK(scheduler.acknowledge(7, [](const uint8_t & payload) { return payload == 5; }));
+    CHECK(scheduler.size() == 0);
+}
+
+static void sleepingNodeKeepsItsQueue()
+{
+    Scheduler scheduler(INITIAL_DELAY, MAX_DELAY, MAX_FAILURES);
+    scheduler.add(1, 7, 0);
+    uint8_t calls {0};
+    auto sender = [&](uint8_t &, uint16_t) {
+        calls++;
+        return SendResult::Failed;
+    };
+    bool awake {false};
+    auto isAwake = [&](uint16_t) {
+        return awake;
+    };
+    for (unsigned long now = 0; now < 5000; now += 100) {
+        scheduler.process(sender, now, 0xFF, isAwake);
+    }
+    // nothing sent and no failure counted while asleep
+    CHECK(calls == 0);
+    CHECK(scheduler.size() == 1);
+
+    awake = true;
+    scheduler.process(sender, 5000, 0xFF, isAwake);
+    CHECK(calls == 1);
+    scheduler.process(sender, 5010, 0xFF, isAwake);
+    CHECK(calls == 1);
+    // poll from the node, the retry delay is skipped
+    scheduler.resume(7, 5010);
+    scheduler.process(sender, 5010, 0xFF, isAwake);
+    CHECK(calls == 2);
+}
+
+int main()
+{
+    backoffDoubles();
+    dropAfterMaxFailures();
+    dropOldestWhenFull();
+    nodesAreIndependent();
+    maxAttempts();
+    awaitingAck();
+    sleepingNodeKeepsItsQueue();
+    return report("MessageSchedulerTest");
+}
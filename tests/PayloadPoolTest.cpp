@@ -0,0 +1,75 @@
+#include <Arduino.h>
+#include "NodeModule/PayloadPool.h"
+#include "Check.h"
+
+using NodeModule::PayloadPool;
+
+struct Payload
+{
+    char text[8] {0};
+};
+
+static void releaseWithLastReference()
+{
+    PayloadPool<Payload, 2> pool;
+    uint8_t slot = pool.acquire();
+    CHECK(slot != pool.NO_SLOT);
+    CHECK(pool.used() == 1);
+    // queued for three nodes
+    pool.retain(slot);
+    pool.retain(slot);
+    pool.retain(slot);
+    // the reference of acquire
+    pool.release(slot);
+    CHECK(pool.used() == 1);
+    pool.release(slot);
+    pool.release(slot);
+    CHECK(pool.used() == 1);
+    pool.release(slot);
+    CHECK(pool.used() == 0);
+    // a release too many does not free a slot taken again
+    uint8_t again = pool.acquire();
+    CHECK(again == slot);
+    pool.release(slot);
+    pool.release(slot);
+    CHECK(pool.used() == 0);
+}
+
+static void exhausted()
+{
+    PayloadPool<Payload, 2> pool;
+    uint8_t first = pool.acquire();
+    uint8_t second = pool.acquire();
+    CHECK(first != pool.NO_SLOT && second != pool.NO_SLOT && first != second);
+    CHECK(pool.acquire() == pool.NO_SLOT);
+    CHECK(pool.used() == 2);
+    pool.release(second);
+    CHECK(pool.acquire() == second);
+}
+
+static void slotIsClearedOnAcquire()
+{
+    PayloadPool<Payload, 1> pool;
+    uint8_t slot = pool.acquire();
+    strcpy(pool.get(slot).text, "stale");
+    pool.release(slot);
+    slot = pool.acquire();
+    CHECK(pool.get(slot).text[0] == '\0');
+}
+
+static void invalidSlot()
+{
+    PayloadPool<Payload, 1> pool;
+    pool.retain(pool.NO_SLOT);
+    pool.release(pool.NO_SLOT);
+    CHECK(pool.used() == 0);
+}
+
+int main()
+{
+    releaseWithLastReference();
+    exhausted();
+    slotIsClearedOnAcquire();
+    invalidSlot();
+    return report("PayloadPoolTest");
+}
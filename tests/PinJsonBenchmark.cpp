@@ -0,0 +1,126 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "MqttModule/MqttConfig.h"
+#include "NodeModule/PinJson.h"
+
+// parsePinCommand against the ArduinoJson document PinStateJsonHandler parses set/json into
+// make -f Makefile-host SKETCH=PinJsonBenchmark.cpp && build-host/PinJsonBenchmark
+//
+// host numbers, the ratio is what carries over to the nodes
+
+using NodeModule::PinCommand;
+using NodeModule::parsePinCommand;
+
+const uint32_t ITERATIONS {200000};
+const uint16_t PAINTED {8192};
+const uint8_t PAINT {0xA5};
+
+const char * const COMMANDS[] {
+    "{\"pin\":13,\"set\":1}",
+    "{\"pin\": 4, \"set\": 1023}",
+    "{\"set\":false,\"pin\":7}",
+};
+
+// StaticJsonDocument<MAX_LEN_JSON_MESSAGE> and deserializeJson like PinStateJsonHandler
+__attribute__((noinline)) static bool parseDocument(const char * text, uint16_t length, PinCommand & command)
+{
+    StaticJsonDocument<MAX_LEN_JSON_MESSAGE> json;
+    if (deserializeJson(json, text, length)) {
+        return false;
+    }
+    command.pin = json["pin"].as<uint8_t>();
+    command.value = json["set"].as<int32_t>();
+    return true;
+}
+
+__attribute__((noinline)) static bool parseFixed(const char * text, uint16_t length, PinCommand & command)
+{
+    return parsePinCommand(text, length, command);
+}
+
+// fills the stack below the caller with PAINT
+__attribute__((noinline)) static void paintStack()
+{
+    uint8_t area[PAINTED];
+    // through a volatile pointer the compiler keeps the writes
+    volatile uint8_t * volatile painted = area;
+    for (uint16_t i = 0; i < PAINTED; i++) {
+        painted[i] = PAINT;
+    }
+}
+
+// bytes below the caller written since paintStack, the stack grows down from area[PAINTED - 1]
+__attribute__((noinline)) static uint16_t stackUsed()
+{
+    uint8_t area[PAINTED];
+    // reads what the calls before left in the same place
+    volatile uint8_t * volatile painted = area;
+    uint16_t untouched {0};
+    while (untouched < PAINTED && painted[untouched] == PAINT) {
+        untouched++;
+    }
+    return PAINTED - untouched;
+}
+
+template<typename Parse>
+static uint16_t measureStack(Parse parse)
+{
+    uint16_t deepest {0};
+    for (auto text: COMMANDS) {
+        PinCommand command;
+        paintStack();
+        parse(text, strlen(text), command);
+        uint16_t used = stackUsed();
+        deepest = used > deepest ? used : deepest;
+    }
+    return deepest;
+}
+
+template<typename Parse>
+static float measureTime(Parse parse)
+{
+    volatile int32_t sink {0};
+    unsigned long start = micros();
+    for (uint32_t i = 0; i < ITERATIONS; i++) {
+        const char * text = COMMANDS[i % (sizeof(COMMANDS) / sizeof(COMMANDS[0]))];
+        PinCommand command;
+        parse(text, strlen(text), command);
+        sink = sink + command.value;
+    }
+    return (micros() - start) * 1000.0f / ITERATIONS;
+}
+
+// both parsers agree on the commands measured
+static bool sameCommands()
+{
+    for (auto text: COMMANDS) {
+        PinCommand fixed;
+        PinCommand document;
+        if (!parseFixed(text, strlen(text), fixed) || !parseDocument(text, strlen(text), document)
+            || fixed.pin != document.pin || fixed.value != document.value) {
+            printf("parsers disagree on %s\n", text);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main()
+{
+    if (!sameCommands()) {
+        return 1;
+    }
+    // the baseline is the painting itself, stackUsed of an empty call
+    uint16_t baseline = measureStack([](const char *, uint16_t, PinCommand &) { return true; });
+    uint16_t fixedStack = measureStack(parseFixed);
+    uint16_t documentStack = measureStack(parseDocument);
+    float fixedTime = measureTime(parseFixed);
+    float documentTime = measureTime(parseDocument);
+
+    printf("set/json parse, %u iterations\n\n", ITERATIONS);
+    printf("  parser               ns/parse   stack bytes   document bytes\n");
+    printf("  parsePinCommand      %8.1f   %11u   %14u\n", fixedTime, fixedStack - baseline, 0u);
+    printf("  ArduinoJson          %8.1f   %11u   %14u\n", documentTime, documentStack - baseline,
+        (unsigned)sizeof(StaticJsonDocument<MAX_LEN_JSON_MESSAGE>));
+    return 0;
+}
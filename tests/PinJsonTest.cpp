@@ -0,0 +1,171 @@
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include "NodeModule/PinJson.h"
+#include "Check.h"
+
+using NodeModule::PinCommand;
+using NodeModule::parsePinCommand;
+using NodeModule::writePinState;
+
+const uint8_t MAX_STATE {64};
+
+// the fallback of addPostData, type and pin first and then the value the provider adds
+static size_t serializeState(const char * type, uint8_t pin, const char * value, char * buffer, size_t size)
+{
+    StaticJsonDocument<MAX_STATE * 2> json;
+    json["type"] = type;
+    json["pin"] = pin;
+    json["value"] = strtol(value, nullptr, 10);
+    return serializeJson(json, buffer, size);
+}
+
+static void sameAsArduinoJson()
+{
+    const char * types[] {"digital", "analog", "temperature", ""};
+    const uint8_t pins[] {0, 7, 13, 99, 100, 255};
+    const char * values[] {"0", "1", "-1", "42", "1023", "-32768", "65535", "123456789", "-123456789"};
+    for (auto type: types) {
+        for (auto pin: pins) {
+            for (auto value: values) {
+                char fast[MAX_STATE] {0};
+                char json[MAX_STATE] {0};
+                uint16_t length = writePinState(fast, sizeof(fast), type, pin, value);
+                size_t jsonLength = serializeState(type, pin, value, json, sizeof(json));
+                CHECK(length > 0);
+                CHECK(length == jsonLength);
+                CHECK(strcmp(fast, json) == 0);
+                if (strcmp(fast, json) != 0) {
+                    printf("  %s\n  %s\n", fast, json);
+                }
+            }
+        }
+    }
+}
+
+// anything ArduinoJson would print differently is left to it
+static void leftToArduinoJson()
+{
+    const char * values[] {"", "-", "21.5", "21.50", "0.1", "1e3", "007", "-0", "+1", " 1", "1 ", "1234567890", "on", "true", "\"1\""};
+    for (auto value: values) {
+        char fast[MAX_STATE] {0};
+        CHECK(writePinState(fast, sizeof(fast), "analog", 1, value) == 0);
+    }
+    char fast[MAX_STATE] {0};
+    // type is written without escaping
+    CHECK(writePinState(fast, sizeof(fast), "a\"b", 1, "1") == 0);
+    CHECK(writePinState(fast, sizeof(fast), "a\\b", 1, "1") == 0);
+}
+
+static void bufferSize()
+{
+    // {"type":"digital","pin":13,"value":1}
+    const uint16_t LENGTH {37};
+    char fast[LENGTH + 1] {0};
+    CHECK(writePinState(fast, LENGTH + 1, "digital", 13, "1") == LENGTH);
+    CHECK(strcmp(fast, "{\"type\":\"digital\",\"pin\":13,\"value\":1}") == 0);
+    CHECK(writePinState(fast, LENGTH, "digital", 13, "1") == 0);
+}
+
+static bool parsed(const char * text, uint8_t pin, int32_t value)
+{
+    PinCommand command;
+    return parsePinCommand(text, strlen(text), command) && command.pin == pin && command.value == value;
+}
+
+static bool refused(const char * text)
+{
+    PinCommand command;
+    return !parsePinCommand(text, strlen(text), command);
+}
+
+static void commandKeys()
+{
+    CHECK(parsed("{\"pin\":13,\"set\":1}", 13, 1));
+    CHECK(parsed("{\"set\":1,\"pin\":13}", 13, 1));
+    CHECK(parsed(" {\n\t\"pin\" : 13 ,\r\n \"set\" :\t0 } \n", 13, 0));
+    CHECK(refused("{\"pin\":13}"));
+    CHECK(refused("{\"set\":1}"));
+    CHECK(refused("{}"));
+    // duplicate keys are left to ArduinoJson
+    CHECK(refused("{\"pin\":1,\"pin\":2,\"set\":1}"));
+    CHECK(refused("{\"pin\":1,\"set\":1,\"set\":0}"));
+    // other keys, escaped and unquoted keys
+    CHECK(refused("{\"pin\":1,\"set\":1,\"delay\":5}"));
+    CHECK(refused("{\"pin\":1,\"se\\u0074\":1}"));
+    CHECK(refused("{pin:1,set:1}"));
+    CHECK(refused("{\"pins\":1,\"set\":1}"));
+}
+
+static void commandValues()
+{
+    CHECK(parsed("{\"pin\":2,\"set\":true}", 2, 1));
+    CHECK(parsed("{\"pin\":2,\"set\":false}", 2, 0));
+    CHECK(parsed("{\"pin\":2,\"set\":-1023}", 2, -1023));
+    CHECK(parsed("{\"pin\":2,\"set\":-0}", 2, 0));
+    CHECK(refused("{\"pin\":2,\"set\":truex}"));
+    CHECK(refused("{\"pin\":2,\"set\":tru}"));
+    CHECK(refused("{\"pin\":2,\"set\":\"1\"}"));
+    CHECK(refused("{\"pin\":2,\"set\":null}"));
+    CHECK(refused("{\"pin\":2,\"set\":[1]}"));
+    CHECK(refused("{\"pin\":2,\"set\":{\"a\":1}}"));
+    CHECK(refused("{\"pin\":2,\"set\":-}"));
+    CHECK(refused("{\"pin\":2,\"set\":}"));
+    // fractions and exponents
+    CHECK(refused("{\"pin\":2,\"set\":1.5}"));
+    CHECK(refused("{\"pin\":2,\"set\":1.0}"));
+    CHECK(refused("{\"pin\":2,\"set\":1e3}"));
+    CHECK(refused("{\"pin\":2,\"set\":1E3}"));
+    CHECK(refused("{\"pin\":2.5,\"set\":1}"));
+}
+
+static void commandRanges()
+{
+    CHECK(parsed("{\"pin\":0,\"set\":1}", 0, 1));
+    CHECK(parsed("{\"pin\":255,\"set\":1}", 255, 1));
+    CHECK(refused("{\"pin\":256,\"set\":1}"));
+    CHECK(refused("{\"pin\":-1,\"set\":1}"));
+    CHECK(parsed("{\"pin\":true,\"set\":1}", 1, 1));
+    // values close to the int32 limits go to ArduinoJson
+    CHECK(parsed("{\"pin\":1,\"set\":2147483639}", 1, 2147483639));
+    CHECK(parsed("{\"pin\":1,\"set\":-2147483639}", 1, -2147483639));
+    CHECK(refused("{\"pin\":1,\"set\":2147483648}"));
+    CHECK(refused("{\"pin\":1,\"set\":99999999999}"));
+    CHECK(refused("{\"pin\":99999999999,\"set\":1}"));
+}
+
+static void commandFraming()
+{
+    CHECK(refused(""));
+    CHECK(refused("   "));
+    CHECK(refused("[\"pin\",1]"));
+    CHECK(refused("{\"pin\":1,\"set\":1"));
+    CHECK(refused("{\"pin\":1,\"set\":1,}"));
+    CHECK(refused("{\"pin\":1 \"set\":1}"));
+    CHECK(refused("{\"pin\"1,\"set\":1}"));
+    // trailing bytes
+    CHECK(refused("{\"pin\":1,\"set\":1}x"));
+    CHECK(refused("{\"pin\":1,\"set\":1},"));
+    CHECK(refused("{\"pin\":1,\"set\":1}{}"));
+
+    // only length bytes are read, the message buffer is not always terminated
+    const char text[] {"{\"pin\":4,\"set\":1}garbage"};
+    PinCommand command;
+    CHECK(parsePinCommand(text, 17, command) && command.pin == 4 && command.value == 1);
+    CHECK(!parsePinCommand(text, 16, command));
+    CHECK(!parsePinCommand(text, sizeof(text) - 1, command));
+    // cut inside a key or a literal
+    CHECK(!parsePinCommand("{\"pin\":1,\"set\":true}", 19, command));
+    CHECK(!parsePinCommand("{\"pin\":1,\"se", 12, command));
+}
+
+int main()
+{
+    sameAsArduinoJson();
+    leftToArduinoJson();
+    bufferSize();
+    commandKeys();
+    commandValues();
+    commandRanges();
+    commandFraming();
+    return report("PinJsonTest");
+}
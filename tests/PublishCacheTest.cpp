@@ -0,0 +1,117 @@
+#include <Arduino.h>
+#include "CommonModule/MacroHelper.h"
+#include "NodeModule/PublishCache.h"
+#include "Check.h"
+
+using MqttModule::MqttMessage;
+using NodeModule::PublishCache;
+using NodeModule::PublishPolicy;
+
+const PublishPolicy POLICIES[] {
+    {"+/states/analog/#", false, 1000},
+    {"+/alive", false, 0},
+    {"room/#", true, 5000},
+};
+
+static MqttMessage message(const char * topic, const char * text)
+{
+    MqttMessage result;
+    strncpy(result.topic, topic, sizeof(result.topic) - 1);
+    strncpy(result.message, text, sizeof(result.message) - 1);
+    return result;
+}
+
+static void policies()
+{
+    PublishCache<4> cache(POLICIES, COUNT_OF(POLICIES));
+    PublishPolicy policy = cache.getPolicy("room/states/analog/0");
+    // the first match wins
+    CHECK(!policy.retain && policy.heartbeat == 1000);
+    policy = cache.getPolicy("room/states/digital/2");
+    CHECK(policy.retain && policy.heartbeat == 5000);
+    policy = cache.getPolicy("room/alive");
+    CHECK(!policy.retain && policy.heartbeat == 0);
+    // no match is retained and always published
+    policy = cache.getPolicy("hall/states/digital/2");
+    CHECK(policy.retain && policy.heartbeat == 0);
+}
+
+static void heartbeat()
+{
+    PublishCache<4> cache(POLICIES, COUNT_OF(POLICIES));
+    MqttMessage sent = message("room/states/digital/2", "1");
+    PublishPolicy policy = cache.getPolicy(sent.topic);
+    CHECK(cache.isDue(sent, policy, 0));
+    cache.published(sent, policy, 0);
+
+    CHECK(!cache.isDue(sent, policy, 4999));
+    CHECK(cache.getSuppressed() == 1);
+    // unchanged values are repeated once the heartbeat passed
+    CHECK(cache.isDue(sent, policy, 5000));
+    // a changed value goes out at once
+    CHECK(cache.isDue(message(sent.topic, "0"), policy, 10));
+    // a value is only remembered when the broker took it
+    cache.published(message(sent.topic, "0"), policy, 10);
+    CHECK(cache.isDue(sent, policy, 20));
+    CHECK(!cache.isDue(message(sent.topic, "0"), policy, 20));
+    CHECK(cache.getSuppressed() == 2);
+}
+
+static void noHeartbeat()
+{
+    PublishCache<4> cache(POLICIES, COUNT_OF(POLICIES));
+    MqttMessage sent = message("room/alive", "1");
+    PublishPolicy policy = cache.getPolicy(sent.topic);
+    cache.published(sent, policy, 0);
+    CHECK(cache.isDue(sent, policy, 0));
+    CHECK(cache.getSuppressed() == 0);
+}
+
+static void topicsAreSeparate()
+{
+    PublishCache<4> cache(POLICIES, COUNT_OF(POLICIES));
+    MqttMessage first = message("room/states/digital/2", "1");
+    MqttMessage second = message("room/states/digital/3", "1");
+    PublishPolicy policy = cache.getPolicy(first.topic);
+    cache.published(first, policy, 0);
+    CHECK(!cache.isDue(first, policy, 0));
+    CHECK(cache.isDue(second, policy, 0));
+}
+
+static void oldestReplaced()
+{
+    PublishCache<2> cache(POLICIES, COUNT_OF(POLICIES));
+    MqttMessage first = message("room/states/digital/2", "1");
+    MqttMessage second = message("room/states/digital/3", "1");
+    MqttMessage third = message("room/states/digital/4", "1");
+    PublishPolicy policy = cache.getPolicy(first.topic);
+    cache.published(first, policy, 0);
+    cache.published(second, policy, 100);
+    cache.published(third, policy, 200);
+    // the entry published longest ago made room, its value goes out again
+    CHECK(cache.isDue(first, policy, 300));
+    CHECK(!cache.isDue(second, policy, 300));
+    CHECK(!cache.isDue(third, policy, 300));
+}
+
+static void timerWraparound()
+{
+    PublishCache<2> cache(POLICIES, COUNT_OF(POLICIES));
+    MqttMessage sent = message("room/states/analog/0", "512");
+    PublishPolicy policy = cache.getPolicy(sent.topic);
+    // 0x100 ms before millis() wraps, whatever the width of unsigned long
+    cache.published(sent, policy, (unsigned long)0 - 0x100);
+    CHECK(!cache.isDue(sent, policy, 0x100));
+    CHECK(cache.isDue(sent, policy, 0x2E8));
+}
+
+int main()
+{
+    policies();
+    heartbeat();
+    noHeartbeat();
+    topicsAreSeparate();
+    oldestReplaced();
+    timerWraparound();
+    return report("PublishCacheTest");
+}
@@ -0,0 +1,131 @@
+#include <Arduino.h>
+#include "NodeModule/PublishFilter.h"
+#include "Check.h"
+
+using NodeModule::PublishFilter;
+
+static void firstValueIsPublished()
+{
+    PublishFilter<2> filter;
+    filter.setLimits(0, 5, 1000);
+    CHECK(!filter.isDue(0, 0));
+    filter.update(0, 0);
+    // nothing published yet, neither deadband nor interval apply
+    CHECK(filter.isDue(0, 0));
+    filter.published(0, 0, 0);
+    CHECK(!filter.isDue(0, 0));
+}
+
+static void deadband()
+{
+    PublishFilter<1> filter;
+    filter.setLimits(0, 5, 0);
+    filter.update(0, 100);
+    filter.published(0, 100, 10);
+
+    filter.update(0, 104);
+    CHECK(!filter.isDue(0, 20));
+    filter.update(0, 95);
+    CHECK(!filter.isDue(0, 20));
+    // on the edge is still inside
+    filter.update(0, 105);
+    CHECK(!filter.isDue(0, 20));
+    filter.update(0, 105.5);
+    CHECK(filter.isDue(0, 20));
+    filter.update(0, 94);
+    CHECK(filter.isDue(0, 20));
+    // back inside cancels the pending publish
+    filter.update(0, 101);
+    CHECK(!filter.isDue(0, 20));
+}
+
+static void minInterval()
+{
+    PublishFilter<1> filter;
+    filter.setLimits(0, 0, 1000);
+    filter.update(0, 1);
+    filter.published(0, 1, 5000);
+
+    filter.update(0, 0);
+    CHECK(!filter.isDue(0, 5000));
+    CHECK(!filter.isDue(0, 5999));
+    // changes in between are coalesced into one publish
+    filter.update(0, 1);
+    filter.update(0, 0);
+    CHECK(filter.isDue(0, 6000));
+    filter.published(0, 0, 6000);
+    CHECK(!filter.isDue(0, 9000));
+}
+
+static void zeroDeadband()
+{
+    PublishFilter<1> filter;
+    filter.update(0, 1);
+    filter.published(0, 1, 0);
+    // the same value reported again is published
+    filter.update(0, 1);
+    CHECK(filter.isDue(0, 0));
+}
+
+static void changed()
+{
+    PublishFilter<1> filter;
+    filter.setLimits(0, 10, 500);
+    filter.changed(0);
+    CHECK(filter.isDue(0, 0));
+    filter.published(0, 0, 0);
+    filter.changed(0);
+    // the deadband is not used, the interval is
+    CHECK(!filter.isDue(0, 499));
+    CHECK(filter.isDue(0, 500));
+}
+
+static void timerWraparound()
+{
+    PublishFilter<1> filter;
+    filter.setLimits(0, 0, 1000);
+    filter.update(0, 1);
+    // 0x100 ms before millis() wraps, whatever the width of unsigned long
+    filter.published(0, 1, (unsigned long)0 - 0x100);
+    filter.update(0, 2);
+    CHECK(!filter.isDue(0, 0x100));
+    CHECK(filter.isDue(0, 0x2E8));
+}
+
+static void pinsAreSeparate()
+{
+    PublishFilter<2> filter;
+    filter.setLimits(0, 5, 0);
+    filter.update(0, 0);
+    filter.published(0, 0, 0);
+    filter.update(1, 0);
+    filter.published(1, 0, 0);
+    filter.update(0, 1);
+    filter.update(1, 1);
+    CHECK(!filter.isDue(0, 0));
+    CHECK(filter.isDue(1, 0));
+}
+
+static void indexOutOfRange()
+{
+    PublishFilter<1> filter;
+    filter.setLimits(1, 5, 0);
+    filter.update(1, 10);
+    filter.changed(1);
+    filter.published(1, 10, 0);
+    CHECK(!filter.isDue(1, 0));
+    CHECK(!filter.isDue(0, 0));
+}
+
+int main()
+{
+    firstValueIsPublished();
+    deadband();
+    minInterval();
+    zeroDeadband();
+    changed();
+    timerWraparound();
+    pinsAreSeparate();
+    indexOutOfRange();
+    return report("PublishFilterTest");
+}
@@ -0,0 +1,113 @@
+#include <Arduino.h>
+#include "NodeModule/SequenceWindow.h"
+#include "Check.h"
+
+using NodeModule::SequenceWindow;
+using NodeModule::SequenceWindows;
+
+static void duplicates()
+{
+    SequenceWindow window;
+    CHECK(window.accept(100));
+    CHECK(!window.accept(100));
+    CHECK(window.accept(101));
+    CHECK(!window.accept(100));
+    CHECK(!window.accept(101));
+}
+
+static void outOfOrder()
+{
+    SequenceWindow window;
+    CHECK(window.accept(10));
+    CHECK(window.accept(13));
+    // late frames inside the window are new once
+    CHECK(window.accept(11));
+    CHECK(!window.accept(11));
+    CHECK(window.accept(12));
+    CHECK(!window.accept(12));
+    CHECK(!window.accept(13));
+}
+
+static void windowEdge()
+{
+    SequenceWindow window;
+    CHECK(window.accept(1000));
+    CHECK(window.accept(1031));
+    // 1000 is the oldest number still remembered
+    CHECK(!window.accept(1000));
+    CHECK(window.accept(1001));
+    CHECK(!window.accept(1001));
+
+    CHECK(window.accept(1032));
+    // 1000 fell out, 1001 is now at the edge
+    CHECK(!window.accept(1001));
+    // further behind is taken as a restarted sender and starts the window again
+    CHECK(window.accept(1000));
+    CHECK(!window.accept(1000));
+    CHECK(window.accept(1001));
+}
+
+static void jumpAhead()
+{
+    SequenceWindow window;
+    CHECK(window.accept(5));
+    CHECK(window.accept(6));
+    // more than the window ahead, what was remembered is gone
+    CHECK(window.accept(200));
+    CHECK(!window.accept(200));
+    CHECK(window.accept(199));
+}
+
+static void wraparound()
+{
+    SequenceWindow window;
+    CHECK(window.accept(0xFFFE));
+    CHECK(window.accept(0xFFFF));
+    CHECK(window.accept(0));
+    CHECK(window.accept(1));
+    CHECK(!window.accept(0xFFFF));
+    CHECK(!window.accept(0));
+    // 0xFFFD is behind 1 by 4
+    CHECK(window.accept(0xFFFD));
+    CHECK(!window.accept(0xFFFD));
+}
+
+static void reset()
+{
+    SequenceWindow window;
+    CHECK(window.accept(7));
+    window.reset();
+    CHECK(window.accept(7));
+}
+
+static void peers()
+{
+    SequenceWindows<2> windows;
+    CHECK(windows.used() == 0);
+    CHECK(windows.accept(1, 50));
+    CHECK(windows.accept(2, 50));
+    CHECK(windows.used() == 2);
+    CHECK(!windows.accept(1, 50));
+    CHECK(!windows.accept(2, 50));
+    windows.reset(1);
+    CHECK(windows.accept(1, 50));
+    CHECK(!windows.accept(2, 50));
+    // a third peer takes the place of the oldest
+    CHECK(windows.accept(3, 50));
+    CHECK(!windows.accept(3, 50));
+    CHECK(windows.accept(1, 50));
+    CHECK(windows.used() == 2);
+    CHECK(windows.getReplaced() == 2);
+}
+
+int main()
+{
+    duplicates();
+    outOfOrder();
+    windowEdge();
+    jumpAhead();
+    wraparound();
+    reset();
+    peers();
+    return report("SequenceWindowTest");
+}
@@ -0,0 +1,168 @@
+#include <Arduino.h>
+#include <FS.h>
+#include "NodeModule/SpillLog.h"
+#include "Check.h"
+
+using MqttModule::MqttMessage;
+using NodeModule::SpillLog;
+
+const uint16_t CAPACITY {4};
+using Log = SpillLog<File, CAPACITY>;
+
+static MqttMessage message(uint8_t number)
+{
+    MqttMessage result;
+    snprintf(result.topic, sizeof(result.topic), "node/%u/state", number);
+    snprintf(result.message, sizeof(result.message), "%u", number);
+    return result;
+}
+
+// pending messages are returned oldest first
+static bool next(Log & log, uint8_t number)
+{
+    MqttMessage pending;
+    MqttMessage expected = message(number);
+    return log.peek(pending) && strcmp(pending.topic, expected.topic) == 0
+        && strcmp(pending.message, expected.message) == 0 && log.pop();
+}
+
+// overwrites length bytes of slot from offset like a write cut by a reset
+static void tear(File & file, uint16_t slot, uint16_t offset, uint16_t length)
+{
+    uint8_t garbage[Log::SLOT_SIZE];
+    memset(garbage, 0x5A, sizeof(garbage));
+    file.seek((uint32_t)slot * Log::SLOT_SIZE + offset);
+    file.write(garbage, length);
+    file.flush();
+}
+
+static void appendAndReplay()
+{
+    File file(tmpfile());
+    Log log(file);
+    CHECK(log.begin());
+    CHECK(file.size() == Log::FILE_SIZE);
+    CHECK(log.size() == 0);
+    MqttMessage pending;
+    CHECK(!log.peek(pending));
+    CHECK(!log.pop());
+
+    for (uint8_t i = 1; i <= 3; i++) {
+        CHECK(log.append(message(i)));
+    }
+    CHECK(log.size() == 3);
+    CHECK(next(log, 1));
+    CHECK(next(log, 2));
+    CHECK(log.append(message(4)));
+    CHECK(next(log, 3));
+    CHECK(next(log, 4));
+    CHECK(log.size() == 0);
+}
+
+static void overwriteOldestWhenFull()
+{
+    File file(tmpfile());
+    Log log(file);
+    log.begin();
+    for (uint8_t i = 1; i <= CAPACITY + 2; i++) {
+        CHECK(log.append(message(i)));
+    }
+    CHECK(log.size() == CAPACITY);
+    CHECK(log.getDropped() == 2);
+    for (uint8_t i = 3; i <= CAPACITY + 2; i++) {
+        CHECK(next(log, i));
+    }
+}
+
+static void recoverAfterRestart()
+{
+    File file(tmpfile());
+    {
+        Log log(file);
+        log.begin();
+        // wraps around the ring, slot 0 holds the newest record
+        for (uint8_t i = 1; i <= CAPACITY + 1; i++) {
+            log.append(message(i));
+        }
+        CHECK(next(log, 2));
+        CHECK(next(log, 3));
+    }
+    Log log(file);
+    CHECK(log.begin());
+    CHECK(log.size() == 2);
+    CHECK(log.append(message(6)));
+    CHECK(next(log, 4));
+    CHECK(next(log, 5));
+    CHECK(next(log, 6));
+}
+
+static void recoverAfterTornWrite()
+{
+    File file(tmpfile());
+    {
+        Log log(file);
+        log.begin();
+        for (uint8_t i = 1; i <= 3; i++) {
+            log.append(message(i));
+        }
+    }
+    // reset while the third record was written, its header made it but not all of the message
+    tear(file, 2, Log::SLOT_SIZE / 2, Log::SLOT_SIZE / 2);
+    {
+        Log log(file);
+        CHECK(log.begin());
+        CHECK(log.size() == 2);
+        // the torn slot is written next
+        CHECK(log.append(message(4)));
+        CHECK(next(log, 1));
+        CHECK(next(log, 2));
+        CHECK(next(log, 4));
+        CHECK(log.append(message(5)));
+    }
+    // a torn sequence number in the header is caught as well
+    tear(file, 3, 2, 1);
+    Log log(file);
+    CHECK(log.begin());
+    CHECK(log.size() == 0);
+}
+
+static void tornSlotAfterBegin()
+{
+    File file(tmpfile());
+    Log log(file);
+    log.begin();
+    log.append(message(1));
+    log.append(message(2));
+    // corrupted after begin, peek drops it and goes on with the next record
+    tear(file, 0, Log::SLOT_SIZE - 4, 4);
+    CHECK(next(log, 2));
+    CHECK(log.getDropped() == 1);
+    CHECK(log.size() == 0);
+}
+
+static void oversizedFile()
+{
+    // a log with more slots before, the extra ones are not read
+    File file(tmpfile());
+    uint8_t empty[Log::SLOT_SIZE];
+    memset(empty, 0xFF, sizeof(empty));
+    for (uint16_t i = 0; i < CAPACITY * 2; i++) {
+        file.write(empty, sizeof(empty));
+    }
+    Log log(file);
+    CHECK(log.begin());
+    CHECK(log.size() == 0);
+    CHECK(log.append(message(1)));
+    CHECK(next(log, 1));
+}
+
+int main()
+{
+    appendAndReplay();
+    overwriteOldestWhenFull();
+    recoverAfterRestart();
+    recoverAfterTornWrite();
+    tornSlotAfterBegin();
+    oversizedFile();
+    return report("SpillLogTest");
+}
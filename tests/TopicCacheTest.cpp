@@ -0,0 +1,97 @@
+#include <Arduino.h>
+#include "NodeModule/TopicCache.h"
+#include "Check.h"
+
+using NodeModule::TopicCache;
+
+const char * const TOPICS[] {
+    "room/states/digital/2",
+    "room/states/digital/3",
+    "room/states/analog/0",
+};
+
+static bool formatTopic(uint8_t index, char * topic, uint8_t size)
+{
+    return snprintf(topic, size, "%s", TOPICS[index]) < size;
+}
+
+static bool copied(const TopicCache<4, 64> & cache, uint8_t index, const char * expected)
+{
+    char topic[MQTT_MAX_LEN_TOPIC] {0};
+    return cache.copy(index, topic, sizeof(topic)) && strcmp(topic, expected) == 0;
+}
+
+static void sharedPrefix()
+{
+    TopicCache<4, 64> cache;
+    CHECK(cache.build(3, formatTopic));
+    CHECK(cache.size() == 3);
+    for (uint8_t i = 0; i < 3; i++) {
+        CHECK(copied(cache, i, TOPICS[i]));
+    }
+    CHECK(!copied(cache, 3, ""));
+}
+
+static void fitsOnlyWithSharedPrefix()
+{
+    // "room/states/" once, the suffixes 9 + 9 + 8 bytes
+    TopicCache<3, 38> cache;
+    CHECK(cache.build(3, formatTopic));
+    TopicCache<3, 37> small;
+    CHECK(!small.build(3, formatTopic));
+    CHECK(small.size() == 0);
+}
+
+static void noSharedPrefix()
+{
+    TopicCache<4, 64> cache;
+    CHECK(cache.build(2, [](uint8_t index, char * topic, uint8_t size) {
+        return snprintf(topic, size, index == 0 ? "alive" : "room/state") < size;
+    }));
+    CHECK(copied(cache, 0, "alive"));
+    CHECK(copied(cache, 1, "room/state"));
+}
+
+static void singleTopic()
+{
+    // the whole topic is the prefix
+    TopicCache<4, 64> cache;
+    CHECK(cache.build(1, formatTopic));
+    CHECK(copied(cache, 0, TOPICS[0]));
+}
+
+static void buildFails()
+{
+    TopicCache<2, 64> cache;
+    CHECK(!cache.build(3, formatTopic));
+    CHECK(cache.size() == 0);
+    CHECK(!cache.build(2, [](uint8_t index, char *, uint8_t) {
+        return index == 0;
+    }));
+    CHECK(cache.size() == 0);
+    // built again after a failure
+    CHECK(cache.build(2, formatTopic));
+    CHECK(cache.size() == 2);
+}
+
+static void shortBuffer()
+{
+    TopicCache<4, 64> cache;
+    cache.build(3, formatTopic);
+    char topic[22] {0};
+    // 21 characters and the terminator
+    CHECK(cache.copy(0, topic, sizeof(topic)));
+    CHECK(strcmp(topic, TOPICS[0]) == 0);
+    CHECK(!cache.copy(0, topic, sizeof(topic) - 1));
+}
+
+int main()
+{
+    sharedPrefix();
+    fitsOnlyWithSharedPrefix();
+    noSharedPrefix();
+    singleTopic();
+    buildFails();
+    shortBuffer();
+    return report("TopicCacheTest");
+}
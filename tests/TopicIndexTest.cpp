@@ -0,0 +1,154 @@
+#include <Arduino.h>
+#include "NodeModule/TopicIndex.h"
+#include "Check.h"
+
+using NodeModule::TopicIndex;
+
+const uint8_t MAX_MATCHED {8};
+
+// nodes subscribed to topic, sorted so checks do not depend on the tree walk
+template<typename Index>
+static uint8_t match(const Index & index, const char * topic, uint16_t * nodes)
+{
+    uint8_t count = index.getSubscribedNodes(topic, nodes, MAX_MATCHED);
+    for (uint8_t i = 1; i < count; i++) {
+        for (uint8_t j = i; j > 0 && nodes[j - 1] > nodes[j]; j--) {
+            uint16_t node = nodes[j];
+            nodes[j] = nodes[j - 1];
+            nodes[j - 1] = node;
+        }
+    }
+    return count;
+}
+
+static void exactMatch()
+{
+    TopicIndex<8, 4> index;
+    uint16_t nodes[MAX_MATCHED] {0};
+    CHECK(index.add("home/room/set/json", 3));
+    CHECK(index.add("home/room/set/json", 4));
+    // added once
+    CHECK(index.add("home/room/set/json", 3));
+    CHECK(index.size() == 1);
+    CHECK(index.hasSubscribed("home/room/set/json"));
+    CHECK(!index.hasSubscribed("home/room/set"));
+    CHECK(!index.hasSubscribed("home/room/set/json/x"));
+
+    CHECK(match(index, "home/room/set/json", nodes) == 2);
+    CHECK(nodes[0] == 3 && nodes[1] == 4);
+    CHECK(match(index, "home/room/set", nodes) == 0);
+    CHECK(match(index, "home/room/set/json/x", nodes) == 0);
+    CHECK(match(index, "home/hall/set/json", nodes) == 0);
+}
+
+static void singleLevelWildcard()
+{
+    TopicIndex<8, 4> index;
+    uint16_t nodes[MAX_MATCHED] {0};
+    CHECK(index.add("home/+/set/json", 1));
+    CHECK(index.add("+/+/set/+", 2));
+    CHECK(match(index, "home/room/set/json", nodes) == 2);
+    CHECK(nodes[0] == 1 && nodes[1] == 2);
+    CHECK(match(index, "away/room/set/json", nodes) == 1);
+    CHECK(nodes[0] == 2);
+    // + stands for exactly one level
+    CHECK(match(index, "home/set/json", nodes) == 0);
+    CHECK(match(index, "home/a/b/set/json", nodes) == 0);
+    // an empty level is a level
+    CHECK(match(index, "home//set/json", nodes) == 2);
+}
+
+static void multiLevelWildcard()
+{
+    TopicIndex<8, 4> index;
+    uint16_t nodes[MAX_MATCHED] {0};
+    CHECK(index.add("home/#", 1));
+    CHECK(index.add("#", 2));
+    CHECK(index.add("home/+/#", 3));
+    CHECK(match(index, "home/room/set/json", nodes) == 3);
+    CHECK(nodes[0] == 1 && nodes[1] == 2 && nodes[2] == 3);
+    // # also matches the parent level
+    CHECK(match(index, "home", nodes) == 2);
+    CHECK(nodes[0] == 1 && nodes[1] == 2);
+    CHECK(match(index, "home/room", nodes) == 3);
+    CHECK(match(index, "away/room", nodes) == 1);
+    CHECK(nodes[0] == 2);
+}
+
+static void nodesReturnedOnce()
+{
+    TopicIndex<8, 4> index;
+    uint16_t nodes[MAX_MATCHED] {0};
+    index.add("home/room/state", 5);
+    index.add("home/+/state", 5);
+    index.add("home/#", 5);
+    index.add("home/#", 6);
+    CHECK(match(index, "home/room/state", nodes) == 2);
+    CHECK(nodes[0] == 5 && nodes[1] == 6);
+    // cut at maxNodes
+    CHECK(index.getSubscribedNodes("home/room/state", nodes, 1) == 1);
+}
+
+static void addWhenFull()
+{
+    TopicIndex<2, 2> index;
+    CHECK(index.add("a/b", 1));
+    CHECK(index.add("a/c", 1));
+    // no filter left
+    CHECK(!index.add("a/d", 1));
+    CHECK(!index.hasSubscribed("a/d"));
+    // existing filters still take nodes until theirs are used up
+    CHECK(index.add("a/b", 2));
+    CHECK(!index.add("a/b", 3));
+    CHECK(index.size() == 2);
+
+    // topics that would not fit a message are refused
+    char topic[MQTT_MAX_LEN_TOPIC + 1] {0};
+    memset(topic, 'a', MQTT_MAX_LEN_TOPIC);
+    TopicIndex<2, 2> longTopics;
+    CHECK(!longTopics.add(topic, 1));
+    CHECK(longTopics.size() == 0);
+}
+
+static void levelsWhenFull()
+{
+    TopicIndex<4, 1, 3> index;
+    CHECK(index.add("a/b/c", 1));
+    // shares a and b, needs one level more than there are
+    CHECK(!index.add("a/b/c/d", 2));
+    CHECK(!index.add("x", 2));
+    uint16_t nodes[MAX_MATCHED] {0};
+    CHECK(match(index, "a/b/c", nodes) == 1);
+
+    // a filter that does not fit leaves no levels behind for the next one
+    TopicIndex<4, 1, 3> partial;
+    CHECK(partial.add("a", 1));
+    CHECK(!partial.add("x/y/z", 2));
+    CHECK(partial.add("q/r", 2));
+    CHECK(match(partial, "q/r", nodes) == 1);
+    CHECK(nodes[0] == 2);
+}
+
+static void filtersInOrder()
+{
+    TopicIndex<4, 2> index;
+    index.add("b/+", 1);
+    index.add("a/#", 2);
+    index.add("b/+", 3);
+    CHECK(index.size() == 2);
+    CHECK(strcmp(index.getFilter(0), "b/+") == 0);
+    CHECK(strcmp(index.getFilter(1), "a/#") == 0);
+    CHECK(index.getFilter(2) == nullptr);
+}
+
+int main()
+{
+    exactMatch();
+    singleLevelWildcard();
+    multiLevelWildcard();
+    nodesReturnedOnce();
+    addWhenFull();
+    levelsWhenFull();
+    filtersInOrder();
+    return report("TopicIndexTest");
+}
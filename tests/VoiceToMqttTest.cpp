@@ -0,0 +1,456 @@
+#include <Arduino.h>
+#include <SoftwareSerial.h>
+#include <VoiceRecognitionV3.h>
+#include <vector>
+#include "CommonModule/MacroHelper.h"
+#include "Check.h"
+
+// same as voice-to-mqtt/main.cpp
+const uint8_t MAX_LOADED {7};
+const uint8_t MAX_RECOGNIZED_BUFFER {64 + 1};
+const uint16_t VOICE_REPLY_TIMEOUT {1000};
+const uint16_t RELOAD_RETRY_TIME {60000};
+
+#include "../voice-to-mqtt/LoadedRecords.h"
+#include "../voice-to-mqtt/VoiceFrameReader.h"
+#include "../voice-to-mqtt/GroupLoader.h"
+
+// voice module on the other end of the serial port
+// every command frame VR writes is kept and answered with the reply queued for it
+class FakeVoiceModule
+{
+    private:
+        SoftwareSerial & serial;
+        std::vector<uint8_t> frame;
+        std::vector<std::vector<uint8_t>> replies;
+
+        void received(uint8_t value)
+        {
+            frame.push_back(value);
+            if (frame.size() < 2 || frame.size() < frame[1] + 2u) {
+                return;
+            }
+            commands.push_back(std::vector<uint8_t>(frame.begin() + 2, frame.end() - 1));
+            frame.clear();
+            if (!replies.empty()) {
+                serial.inject(replies.front().data(), replies.front().size());
+                replies.erase(replies.begin());
+            }
+        }
+
+    public:
+        // command and data of each frame written by VR
+        std::vector<std::vector<uint8_t>> commands;
+
+        FakeVoiceModule(SoftwareSerial & serial):
+            serial(serial)
+        {
+            serial.onWrite([this](uint8_t value) { received(value); });
+        }
+
+        // [FRAME_HEAD][length][command][data ...][FRAME_END]
+        void reply(uint8_t command, std::vector<uint8_t> data = {})
+        {
+            std::vector<uint8_t> bytes {FRAME_HEAD, (uint8_t)(data.size() + 2), command};
+            bytes.insert(bytes.end(), data.begin(), data.end());
+            bytes.push_back(FRAME_END);
+            replies.push_back(bytes);
+        }
+
+        // load reply [count][record, status]... with every record loaded
+        void replyLoaded(uint8_t first, uint8_t count)
+        {
+            std::vector<uint8_t> data {count};
+            for (uint8_t record = first; record < first + count; record++) {
+                data.push_back(record);
+                data.push_back(0);
+            }
+            reply(FRAME_CMD_LOAD, data);
+        }
+
+        void reset()
+        {
+            commands.clear();
+            replies.clear();
+        }
+};
+
+static std::vector<uint8_t> records(uint8_t first, uint8_t count)
+{
+    std::vector<uint8_t> command {FRAME_CMD_LOAD};
+    for (uint8_t record = first; record < first + count; record++) {
+        command.push_back(record);
+    }
+    return command;
+}
+
+static void loadedRecords()
+{
+    LoadedRecords loaded;
+    // after start nothing is known about the recognizer
+    CHECK(!loaded.isKnown());
+    loaded.loaded(3);
+    CHECK(!loaded.isLoaded(3));
+
+    loaded.clear();
+    CHECK(loaded.isKnown());
+    CHECK(loaded.available() == MAX_LOADED);
+    CHECK(!loaded.isLoaded(3));
+    loaded.loaded(3);
+    loaded.loaded(3);
+    CHECK(loaded.isLoaded(3));
+    CHECK(loaded.available() == MAX_LOADED - 1);
+
+    for (uint8_t record = 10; record < 10 + MAX_LOADED; record++) {
+        loaded.loaded(record);
+    }
+    // a full recognizer keeps what it had
+    CHECK(loaded.available() == 0);
+    CHECK(loaded.isLoaded(3));
+    CHECK(loaded.isLoaded(10 + MAX_LOADED - 2));
+    CHECK(!loaded.isLoaded(10 + MAX_LOADED - 1));
+
+    loaded.forget();
+    CHECK(!loaded.isKnown());
+    CHECK(!loaded.isLoaded(3));
+    loaded.clear();
+    CHECK(!loaded.isLoaded(3));
+}
+
+// what loop does, read replies and send the next command, until the group is loaded or failed
+static bool loadGroup(VR & voice, LoadedRecords & loaded, uint8_t group, unsigned long now = 0)
+{
+    GroupLoader loader(loaded);
+    VoiceFrameReader reader;
+    uint8_t buf[MAX_RECOGNIZED_BUFFER] {0};
+    loader.request(group);
+    for (uint8_t i = 0; i < 8 && loader.isBusy() && !loader.hasFailed(); i++) {
+        CHECK(reader.read(voice, buf, sizeof(buf), loader) == 0);
+        if (loader.tick(voice, now)) {
+            reader.reset();
+        }
+    }
+    return !loader.isBusy() && !loader.hasFailed();
+}
+
+static void loadGroups(VR & voice, FakeVoiceModule & module)
+{
+    LoadedRecords loaded;
+
+    // unknown recognizer, cleared first
+    module.reset();
+    module.reply(FRAME_CMD_CLEAR);
+    module.replyLoaded(2 * MAX_LOADED, MAX_LOADED);
+    CHECK(loadGroup(voice, loaded, 2));
+    CHECK(module.commands.size() == 2);
+    CHECK(module.commands[0] == std::vector<uint8_t>{FRAME_CMD_CLEAR});
+    CHECK(module.commands[1] == records(2 * MAX_LOADED, MAX_LOADED));
+    for (uint8_t record = 2 * MAX_LOADED; record < 3 * MAX_LOADED; record++) {
+        CHECK(loaded.isLoaded(record));
+    }
+    CHECK(loaded.available() == 0);
+
+    // nothing is sent for a loaded group
+    module.reset();
+    CHECK(loadGroup(voice, loaded, 2));
+    CHECK(module.commands.empty());
+
+    // another group does not fit, cleared again
+    module.reset();
+    module.reply(FRAME_CMD_CLEAR);
+    module.replyLoaded(MAX_LOADED, MAX_LOADED);
+    CHECK(loadGroup(voice, loaded, 1));
+    CHECK(module.commands.size() == 2);
+    CHECK(module.commands[0] == std::vector<uint8_t>{FRAME_CMD_CLEAR});
+    CHECK(module.commands[1] == records(MAX_LOADED, MAX_LOADED));
+    CHECK(!loaded.isLoaded(2 * MAX_LOADED));
+    CHECK(loaded.isLoaded(MAX_LOADED));
+}
+
+static void loadStatus(VR & voice, FakeVoiceModule & module)
+{
+    LoadedRecords loaded;
+
+    // 0xFC record is already in the recognizer, anything else but 0 failed
+    module.reset();
+    module.reply(FRAME_CMD_CLEAR);
+    module.reply(FRAME_CMD_LOAD, {MAX_LOADED, 0, 0, 1, 0xFC, 2, 0xFF, 3, 0, 4, 0xFE, 5, 0, 6, 0});
+    CHECK(loadGroup(voice, loaded, 0));
+    CHECK(loaded.isLoaded(0));
+    CHECK(loaded.isLoaded(1));
+    CHECK(!loaded.isLoaded(2));
+    CHECK(loaded.isLoaded(3));
+    CHECK(!loaded.isLoaded(4));
+    CHECK(loaded.isLoaded(5));
+    CHECK(loaded.isLoaded(6));
+    CHECK(loaded.available() == 2);
+    // failed records are not sent again until the group is requested again
+    CHECK(module.commands.size() == 2);
+
+    // only the failed records are loaded again, they fit without a clear
+    module.reset();
+    module.reply(FRAME_CMD_LOAD, {2, 2, 0, 4, 0});
+    CHECK(loadGroup(voice, loaded, 0));
+    CHECK(module.commands.size() == 1);
+    CHECK(module.commands[0] == (std::vector<uint8_t>{FRAME_CMD_LOAD, 2, 4}));
+    CHECK(loaded.isLoaded(2));
+    CHECK(loaded.isLoaded(4));
+    CHECK(loaded.available() == 0);
+
+    // a reply without details means every record loaded
+    loaded.forget();
+    module.reset();
+    module.reply(FRAME_CMD_CLEAR);
+    module.reply(FRAME_CMD_LOAD);
+    CHECK(loadGroup(voice, loaded, 1));
+    for (uint8_t record = MAX_LOADED; record < 2 * MAX_LOADED; record++) {
+        CHECK(loaded.isLoaded(record));
+    }
+}
+
+static void loadFailures(VR & voice, FakeVoiceModule & module)
+{
+    LoadedRecords loaded;
+
+    // clear answered with another command
+    module.reset();
+    module.reply(FRAME_CMD_LOAD);
+    CHECK(!loadGroup(voice, loaded, 0));
+    CHECK(module.commands.size() == 1);
+    CHECK(!loaded.isKnown());
+
+    // load answered with another command, the recognizer is unknown again
+    module.reset();
+    module.reply(FRAME_CMD_CLEAR);
+    module.reply(FRAME_CMD_CLEAR);
+    CHECK(!loadGroup(voice, loaded, 0));
+    CHECK(module.commands.size() == 2);
+    CHECK(!loaded.isKnown());
+    CHECK(!loaded.isLoaded(0));
+
+    // the next load starts with clear
+    module.reset();
+    module.reply(FRAME_CMD_CLEAR);
+    module.replyLoaded(0, MAX_LOADED);
+    CHECK(loadGroup(voice, loaded, 0));
+    CHECK(module.commands[0] == std::vector<uint8_t>{FRAME_CMD_CLEAR});
+    CHECK(loaded.isLoaded(0));
+}
+
+// recognition of record 5 with signature "group1"
+// [FRAME_HEAD][length][FRAME_CMD_VR][0][group mode][record][recognizer index][signature length][signature ...][FRAME_END]
+static const std::vector<uint8_t> RECOGNIZED {FRAME_HEAD, 13, FRAME_CMD_VR, 0, 0, 5, 2, 6, 'g', 'r', 'o', 'u', 'p', '1', FRAME_END};
+static const std::vector<uint8_t> RECOGNIZED_RESULT {0, 5, 2, 6, 'g', 'r', 'o', 'u', 'p', '1'};
+static const std::vector<uint8_t> OTHER {FRAME_HEAD, 5, FRAME_CMD_VR, 0, 0, 9, FRAME_END};
+
+static void inject(SoftwareSerial & serial, const std::vector<uint8_t> & bytes)
+{
+    serial.inject(bytes.data(), bytes.size());
+}
+
+// replies the frame reader passed on, command and data
+struct Replies
+{
+    std::vector<std::vector<uint8_t>> frames;
+
+    void received(uint8_t command, const uint8_t * data, uint8_t length)
+    {
+        std::vector<uint8_t> frame {command};
+        frame.insert(frame.end(), data, data + length);
+        frames.push_back(frame);
+    }
+};
+
+template<typename Replies>
+static std::vector<uint8_t> readFrame(VoiceFrameReader & reader, SoftwareSerial & serial, Replies & replies, uint8_t size = MAX_RECOGNIZED_BUFFER)
+{
+    uint8_t buf[MAX_RECOGNIZED_BUFFER] {0};
+    uint8_t count = reader.read(serial, buf, size, replies);
+    return std::vector<uint8_t>(buf, buf + count);
+}
+
+static void frames()
+{
+    SoftwareSerial serial(2, 3);
+    VoiceFrameReader reader;
+    Replies replies;
+
+    inject(serial, RECOGNIZED);
+    CHECK(readFrame(reader, serial, replies) == RECOGNIZED_RESULT);
+    CHECK(serial.available() == 0);
+    CHECK(reader.getDropped() == 0);
+    CHECK(readFrame(reader, serial, replies).empty());
+
+    // back to back frames are returned one per call, the rest stays in the port
+    inject(serial, RECOGNIZED);
+    inject(serial, OTHER);
+    CHECK(readFrame(reader, serial, replies) == RECOGNIZED_RESULT);
+    CHECK(serial.available() == (int)OTHER.size());
+    CHECK(readFrame(reader, serial, replies) == (std::vector<uint8_t>{0, 9}));
+    CHECK(readFrame(reader, serial, replies).empty());
+
+    // a frame split over several calls, the reader never waits for the rest
+    inject(serial, std::vector<uint8_t>(RECOGNIZED.begin(), RECOGNIZED.begin() + 1));
+    CHECK(readFrame(reader, serial, replies).empty());
+    inject(serial, std::vector<uint8_t>(RECOGNIZED.begin() + 1, RECOGNIZED.begin() + 7));
+    CHECK(readFrame(reader, serial, replies).empty());
+    inject(serial, std::vector<uint8_t>(RECOGNIZED.begin() + 7, RECOGNIZED.end()));
+    CHECK(readFrame(reader, serial, replies) == RECOGNIZED_RESULT);
+
+    // replies to commands are passed on and the next frame is read
+    inject(serial, {FRAME_HEAD, 4, FRAME_CMD_LOAD, 1, 2, FRAME_END});
+    inject(serial, {FRAME_HEAD, 2, FRAME_CMD_CLEAR, FRAME_END});
+    inject(serial, RECOGNIZED);
+    CHECK(readFrame(reader, serial, replies) == RECOGNIZED_RESULT);
+    CHECK(replies.frames.size() == 2);
+    CHECK(replies.frames[0] == (std::vector<uint8_t>{FRAME_CMD_LOAD, 1, 2}));
+    CHECK(replies.frames[1] == std::vector<uint8_t>{FRAME_CMD_CLEAR});
+
+    // the result is cut to the buffer size
+    inject(serial, RECOGNIZED);
+    CHECK(readFrame(reader, serial, replies, 3) == std::vector<uint8_t>(RECOGNIZED_RESULT.begin(), RECOGNIZED_RESULT.begin() + 3));
+    CHECK(reader.getDropped() == 0);
+}
+
+static void resync()
+{
+    SoftwareSerial serial(2, 3);
+    Replies replies;
+
+    // junk before the head
+    {
+        VoiceFrameReader reader;
+        inject(serial, {0x00, 0x55, FRAME_END, 0xFF});
+        inject(serial, RECOGNIZED);
+        CHECK(readFrame(reader, serial, replies) == RECOGNIZED_RESULT);
+        CHECK(reader.getDropped() == 4);
+    }
+
+    // length too short or longer than any frame
+    {
+        VoiceFrameReader reader;
+        inject(serial, {FRAME_HEAD, 1});
+        inject(serial, RECOGNIZED);
+        CHECK(readFrame(reader, serial, replies) == RECOGNIZED_RESULT);
+        inject(serial, {FRAME_HEAD, 0x80});
+        inject(serial, RECOGNIZED);
+        CHECK(readFrame(reader, serial, replies) == RECOGNIZED_RESULT);
+        CHECK(reader.getDropped() == 2);
+    }
+
+    // a head where the length is expected starts the frame again
+    {
+        VoiceFrameReader reader;
+        inject(serial, {FRAME_HEAD});
+        inject(serial, RECOGNIZED);
+        CHECK(readFrame(reader, serial, replies) == RECOGNIZED_RESULT);
+        CHECK(reader.getDropped() == 1);
+    }
+
+    // the byte at the end is not FRAME_END, the frame is dropped and the next one is read
+    {
+        VoiceFrameReader reader;
+        std::vector<uint8_t> broken(RECOGNIZED);
+        broken.back() = 0x00;
+        inject(serial, broken);
+        CHECK(readFrame(reader, serial, replies).empty());
+        CHECK(reader.getDropped() == 1);
+        inject(serial, RECOGNIZED);
+        CHECK(readFrame(reader, serial, replies) == RECOGNIZED_RESULT);
+    }
+
+    // a frame cut short by a lost byte takes the head of the next one as its end
+    {
+        VoiceFrameReader reader;
+        std::vector<uint8_t> cut(RECOGNIZED);
+        cut.erase(cut.begin() + 8);
+        inject(serial, cut);
+        inject(serial, OTHER);
+        inject(serial, RECOGNIZED);
+        CHECK(readFrame(reader, serial, replies) == RECOGNIZED_RESULT);
+        CHECK(reader.getDropped() > 0);
+    }
+
+    // a blocking command read the rest of a frame, reset drops what was read before it
+    {
+        VoiceFrameReader reader;
+        inject(serial, std::vector<uint8_t>(RECOGNIZED.begin(), RECOGNIZED.begin() + 5));
+        CHECK(readFrame(reader, serial, replies).empty());
+        reader.reset();
+        inject(serial, RECOGNIZED);
+        CHECK(readFrame(reader, serial, replies) == RECOGNIZED_RESULT);
+    }
+}
+
+static void loadWithoutWaiting(VR & voice, FakeVoiceModule & module)
+{
+    LoadedRecords loaded;
+    GroupLoader loader(loaded);
+    VoiceFrameReader reader;
+    uint8_t buf[MAX_RECOGNIZED_BUFFER] {0};
+
+    // no reply, every tick returns at once
+    module.reset();
+    loader.request(1);
+    CHECK(loader.tick(voice, 100));
+    CHECK(module.commands.size() == 1);
+    CHECK(!loader.tick(voice, 100 + VOICE_REPLY_TIMEOUT - 1));
+    CHECK(loader.isBusy() && !loader.hasFailed());
+    // the recognizer is unknown after a timeout and the group is tried again later
+    CHECK(!loader.tick(voice, 100 + VOICE_REPLY_TIMEOUT));
+    CHECK(loader.hasFailed());
+    CHECK(!loaded.isKnown());
+    CHECK(!loader.tick(voice, 100 + VOICE_REPLY_TIMEOUT + RELOAD_RETRY_TIME - 1));
+    CHECK(module.commands.size() == 1);
+
+    // the late reply is ignored
+    module.reset();
+    inject(voice, {FRAME_HEAD, 2, FRAME_CMD_CLEAR, FRAME_END});
+    CHECK(reader.read(voice, buf, sizeof(buf), loader) == 0);
+    CHECK(!loaded.isKnown());
+
+    module.reply(FRAME_CMD_CLEAR);
+    unsigned long now = 100 + VOICE_REPLY_TIMEOUT + RELOAD_RETRY_TIME;
+    CHECK(loader.tick(voice, now));
+    reader.reset();
+    CHECK(reader.read(voice, buf, sizeof(buf), loader) == 0);
+    CHECK(loaded.isKnown());
+
+    // a request while the load is sent is loaded after it
+    module.replyLoaded(MAX_LOADED, MAX_LOADED);
+    CHECK(loader.tick(voice, now));
+    loader.request(0);
+    reader.reset();
+    CHECK(reader.read(voice, buf, sizeof(buf), loader) == 0);
+    CHECK(loaded.isLoaded(MAX_LOADED));
+    CHECK(loader.isBusy());
+
+    // a recognition after a reply is returned as well
+    module.reply(FRAME_CMD_CLEAR);
+    module.replyLoaded(0, MAX_LOADED);
+    CHECK(loader.tick(voice, now));
+    reader.reset();
+    inject(voice, RECOGNIZED);
+    CHECK(readFrame(reader, voice, loader) == RECOGNIZED_RESULT);
+    CHECK(loader.tick(voice, now));
+    reader.reset();
+    CHECK(reader.read(voice, buf, sizeof(buf), loader) == 0);
+    CHECK(!loader.isBusy());
+    CHECK(loaded.isLoaded(0) && !loaded.isLoaded(MAX_LOADED));
+    CHECK(module.commands.size() == 4);
+}
+
+int main()
+{
+    VR voice(2, 3);
+    FakeVoiceModule module(voice);
+
+    loadedRecords();
+    loadGroups(voice, module);
+    loadStatus(voice, module);
+    loadFailures(voice, module);
+    frames();
+    resync();
+    loadWithoutWaiting(voice, module);
+    return report("VoiceToMqttTest");
+}
@@ -0,0 +1,176 @@
+#include <Arduino.h>
+#include "NodeModule/WifiResume.h"
+#include "Check.h"
+
+using NodeModule::ResumeState;
+using NodeModule::WifiResume;
+
+// rtc user memory that survives the WifiResume of one wake, like deep sleep does
+struct FakeRtc
+{
+    uint8_t memory[sizeof(ResumeState)] {0};
+    bool failing {false};
+    uint8_t writes {0};
+
+    bool read(void * data, size_t size)
+    {
+        if (failing || size > sizeof(memory)) {
+            return false;
+        }
+        memcpy(data, memory, size);
+        return true;
+    }
+
+    bool write(const void * data, size_t size)
+    {
+        if (failing || size > sizeof(memory)) {
+            return false;
+        }
+        memcpy(memory, data, size);
+        writes++;
+        return true;
+    }
+};
+
+static ResumeState connection()
+{
+    ResumeState state;
+    state.ip = 0x0A01A8C0;
+    state.gateway = 0x0101A8C0;
+    state.subnet = 0x00FFFFFF;
+    state.dns = 0x0101A8C0;
+    state.broker = 0x0201A8C0;
+    for (uint8_t i = 0; i < sizeof(state.bssid); i++) {
+        state.bssid[i] = 0x10 + i;
+    }
+    state.channel = 11;
+    state.accessPoint = 1;
+    return state;
+}
+
+static void powerOn()
+{
+    FakeRtc rtc;
+    WifiResume<FakeRtc> resume(rtc);
+    // zeroed memory after a power loss
+    CHECK(!resume.load());
+    CHECK(!resume.isValid());
+    // and whatever the chip left in it
+    memset(rtc.memory, 0xA5, sizeof(rtc.memory));
+    CHECK(!resume.load());
+    CHECK(resume.get().ip == 0);
+    CHECK(!resume.resumed(10));
+}
+
+static void saveAndLoad()
+{
+    FakeRtc rtc;
+    {
+        WifiResume<FakeRtc> resume(rtc);
+        CHECK(resume.save(connection()));
+        CHECK(resume.isValid());
+    }
+    WifiResume<FakeRtc> resume(rtc);
+    CHECK(resume.load());
+    const ResumeState & state = resume.get();
+    CHECK(state.ip == connection().ip);
+    CHECK(state.broker == connection().broker);
+    CHECK(memcmp(state.bssid, connection().bssid, sizeof(state.bssid)) == 0);
+    CHECK(state.channel == 11);
+    CHECK(state.accessPoint == 1);
+    CHECK(state.wakes == 0);
+}
+
+static void crcCheck()
+{
+    for (uint8_t i = sizeof(uint32_t); i < sizeof(ResumeState); i++) {
+        FakeRtc rtc;
+        WifiResume<FakeRtc> saved(rtc);
+        saved.save(connection());
+        rtc.memory[i] ^= 0x04;
+        WifiResume<FakeRtc> resume(rtc);
+        CHECK(!resume.load());
+        // a rejected state is not handed out
+        CHECK(resume.get().ip == 0);
+        CHECK(resume.get().channel == 0);
+    }
+    // a changed crc is rejected as well
+    FakeRtc rtc;
+    WifiResume<FakeRtc> saved(rtc);
+    saved.save(connection());
+    rtc.memory[0] ^= 0x01;
+    CHECK(!saved.load());
+}
+
+static void failingStore()
+{
+    FakeRtc rtc;
+    WifiResume<FakeRtc> resume(rtc);
+    resume.save(connection());
+    rtc.failing = true;
+    CHECK(!resume.load());
+    CHECK(!resume.save(connection()));
+    CHECK(!resume.isValid());
+}
+
+static void clear()
+{
+    FakeRtc rtc;
+    {
+        WifiResume<FakeRtc> resume(rtc);
+        resume.save(connection());
+        uint8_t writes = rtc.writes;
+        resume.clear();
+        CHECK(!resume.isValid());
+        CHECK(rtc.writes == writes + 1);
+        CHECK(!resume.resumed(10));
+    }
+    // the next wake does a full connect
+    WifiResume<FakeRtc> resume(rtc);
+    CHECK(!resume.load());
+    CHECK(resume.get().ip == 0);
+    // an empty state with its crc is not what clear leaves behind
+    WifiResume<FakeRtc> empty(rtc);
+    empty.save(ResumeState());
+    CHECK(empty.load());
+    empty.clear();
+    CHECK(!empty.load());
+}
+
+static void wakeCounter()
+{
+    const uint16_t MAX_WAKES {3};
+    FakeRtc rtc;
+    {
+        WifiResume<FakeRtc> resume(rtc);
+        resume.save(connection());
+    }
+    for (uint16_t wake = 1; wake <= MAX_WAKES; wake++) {
+        WifiResume<FakeRtc> resume(rtc);
+        CHECK(resume.load());
+        CHECK(resume.get().wakes == wake - 1);
+        CHECK(resume.resumed(MAX_WAKES));
+        CHECK(resume.get().wakes == wake);
+        // the rest of the connection is kept
+        CHECK(resume.get().ip == connection().ip);
+    }
+    WifiResume<FakeRtc> resume(rtc);
+    CHECK(resume.load());
+    CHECK(resume.get().wakes == MAX_WAKES);
+    // a full connect is due, it saves a new state with the counter back at 0
+    CHECK(!resume.resumed(MAX_WAKES));
+    CHECK(resume.save(connection()));
+    CHECK(resume.get().wakes == 0);
+    CHECK(resume.resumed(MAX_WAKES));
+}
+
+int main()
+{
+    powerOn();
+    saveAndLoad();
+    crcCheck();
+    failingStore();
+    clear();
+    wakeCounter();
+    return report("WifiResumeTest");
+}
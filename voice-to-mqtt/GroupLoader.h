@@ -0,0 +1,154 @@
+// loads the records of a group into the recognizer without waiting for the voice module
+// clear and load are sent with VR::send_pkt, VoiceFrameReader passes the replies to received
+// records can not be removed one by one, the recognizer is cleared when the missing ones do not fit
+// a failed or unanswered command leaves the recognizer unknown, the group is tried again after RELOAD_RETRY_TIME
+class GroupLoader
+{
+    private:
+        enum class State: uint8_t
+        {
+            Idle,
+            Clearing,
+            Cleared,
+            Loading,
+            Failed
+        };
+
+        static const uint8_t NO_GROUP {0xFF};
+
+        LoadedRecords & loaded;
+        State state {State::Idle};
+        uint8_t wanted {NO_GROUP};
+        uint8_t loading {NO_GROUP};
+        // records sent with the last load
+        uint8_t missing[MAX_LOADED] {0};
+        uint8_t count {0};
+        unsigned long sentAt {0};
+        unsigned long failedAt {0};
+        bool failed {false};
+
+        void findMissing(uint8_t group)
+        {
+            count = 0;
+            for (uint8_t record = group * MAX_LOADED; record < (group + 1) * MAX_LOADED; record++) {
+                if (!loaded.isLoaded(record)) {
+                    missing[count++] = record;
+                }
+            }
+        }
+
+        void fail(unsigned long now)
+        {
+            state = State::Idle;
+            failed = true;
+            failedAt = now;
+        }
+
+    public:
+        GroupLoader(LoadedRecords & loaded):
+            loaded(loaded)
+        {}
+
+        // the latest request wins, a load already sent is answered first
+        void request(uint8_t group)
+        {
+            wanted = group;
+            failed = false;
+        }
+
+        // sends the next command, returns true when it did
+        // VR::send_pkt drops what the serial port received, the frame reader has to start again
+        template<typename Voice>
+        bool tick(Voice & voice, unsigned long now)
+        {
+            if (state == State::Failed) {
+                fail(now);
+                return false;
+            }
+            if (state == State::Clearing || state == State::Loading) {
+                if (now - sentAt >= VOICE_REPLY_TIMEOUT) {
+                    error("Recognizer did not reply.");
+                    loaded.forget();
+                    fail(now);
+                }
+                return false;
+            }
+            if (wanted == NO_GROUP || (failed && now - failedAt < RELOAD_RETRY_TIME)) {
+                return false;
+            }
+            if (state == State::Idle) {
+                findMissing(wanted);
+                if (count == 0) {
+                    debug("Group %d already loaded", wanted);
+                    wanted = NO_GROUP;
+                    return false;
+                }
+                if (!loaded.isKnown() || count > loaded.available()) {
+                    voice.send_pkt(FRAME_CMD_CLEAR, nullptr, 0);
+                    state = State::Clearing;
+                    sentAt = now;
+                    return true;
+                }
+            } else {
+                findMissing(wanted);
+            }
+            info("Load group %d records %d", wanted, count);
+            voice.send_pkt(FRAME_CMD_LOAD, missing, count);
+            loading = wanted;
+            state = State::Loading;
+            sentAt = now;
+            return true;
+        }
+
+        // reply frames without FRAME_HEAD, length and FRAME_END
+        // load replies [loaded count][record, status]...
+        void received(uint8_t command, const uint8_t * data, uint8_t length)
+        {
+            if (state == State::Clearing) {
+                if (command != FRAME_CMD_CLEAR) {
+                    error("Failed to clear recognizer.");
+                    loaded.forget();
+                    state = State::Failed;
+                    return;
+                }
+                loaded.clear();
+                state = State::Cleared;
+                return;
+            }
+            if (state != State::Loading) {
+                // stale, its command timed out
+                return;
+            }
+            if (command != FRAME_CMD_LOAD) {
+                error("Failed to load group: %d", loading);
+                loaded.forget();
+                state = State::Failed;
+                return;
+            }
+            for (uint8_t i = 1; i + 1 < length; i += 2) {
+                // 0xFC record is already in the recognizer
+                if (data[i + 1] == 0 || data[i + 1] == 0xFC) {
+                    loaded.loaded(data[i]);
+                } else {
+                    warning("Failed to load record: %d status %x", data[i], data[i + 1]);
+                }
+            }
+            // module replies without details when every record loaded
+            if (length == 0) {
+                for (uint8_t i = 0; i < count; i++) {
+                    loaded.loaded(missing[i]);
+                }
+            }
+            state = State::Idle;
+            // records that failed are not tried again until the group is requested again
+            if (wanted == loading) {
+                wanted = NO_GROUP;
+            }
+        }
+
+        // a requested group is not loaded yet
+        bool isBusy() const { return state != State::Idle || wanted != NO_GROUP; }
+
+        // the last command failed or was not answered
+        bool hasFailed() const { return failed || state == State::Failed; }
+};
@@ -0,0 +1,67 @@
+// records in the recognizer of the voice module, it holds MAX_LOADED at a time
+// unknown after start or a failed command, the next load starts with clear then
+class LoadedRecords
+{
+    private:
+        static const uint8_t EMPTY {0xFF};
+        uint8_t records[MAX_LOADED];
+        bool known {false};
+
+    public:
+        LoadedRecords()
+        {
+            forget();
+        }
+
+        void forget()
+        {
+            memset(records, EMPTY, sizeof(records));
+            known = false;
+        }
+
+        // the recognizer was cleared
+        void clear()
+        {
+            memset(records, EMPTY, sizeof(records));
+            known = true;
+        }
+
+        void loaded(uint8_t record)
+        {
+            if (isLoaded(record)) {
+                return;
+            }
+            for (auto & slot: records) {
+                if (slot == EMPTY) {
+                    slot = record;
+                    return;
+                }
+            }
+        }
+
+        bool isLoaded(uint8_t record) const
+        {
+            if (!known) {
+                return false;
+            }
+            for (auto slot: records) {
+                if (slot == record) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        uint8_t available() const
+        {
+            uint8_t count {0};
+            for (auto slot: records) {
+                if (slot == EMPTY) {
+                    count++;
+                }
+            }
+            return count;
+        }
+
+        bool isKnown() const { return known; }
+};
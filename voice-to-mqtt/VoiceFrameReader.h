@@ -0,0 +1,97 @@
+// reads frames of the voice module from the bytes the serial port already received, it never waits
+// [FRAME_HEAD][length][command][data ...][FRAME_END], length counts the bytes from command to FRAME_END
+// frame bytes are the defines of VoiceRecognitionV3.h
+//
+// recognition frames (FRAME_CMD_VR) are returned like VR::recognize:
+// [group mode][record][recognizer index][signature length][signature ...]
+// replies to other commands go to replies.received(command, data, data length)
+class VoiceFrameReader
+{
+    private:
+        enum class State: uint8_t
+        {
+            Head,
+            Length,
+            Body
+        };
+
+        State state {State::Head};
+        uint8_t frame[MAX_RECOGNIZED_BUFFER + 2] {0};
+        uint8_t length {0};
+        uint8_t position {0};
+        uint16_t dropped {0};
+
+        // true when the byte completed a frame
+        bool feed(uint8_t value)
+        {
+            switch (state) {
+                case State::Head:
+                    if (value == FRAME_HEAD) {
+                        state = State::Length;
+                    } else {
+                        dropped++;
+                    }
+                    return false;
+                case State::Length:
+                    // command and end at least
+                    if (value < 2 || value > sizeof(frame)) {
+                        dropped++;
+                        state = value == FRAME_HEAD ? State::Length : State::Head;
+                        return false;
+                    }
+                    length = value;
+                    position = 0;
+                    state = State::Body;
+                    return false;
+                case State::Body:
+                    frame[position++] = value;
+                    if (position < length) {
+                        return false;
+                    }
+                    state = State::Head;
+                    if (value != FRAME_END) {
+                        dropped++;
+                        return false;
+                    }
+                    return true;
+            }
+            return false;
+        }
+
+    public:
+        // processes available bytes until a recognition frame is complete
+        // returns its size in buf or 0, bytes after the frame are left for the next call
+        template<typename Serial, typename Replies>
+        uint8_t read(Serial & serial, uint8_t * buf, uint8_t size, Replies & replies)
+        {
+            while (serial.available() > 0) {
+                int value = serial.read();
+                if (value < 0) {
+                    break;
+                }
+                if (!feed(value)) {
+                    continue;
+                }
+                if (frame[0] != FRAME_CMD_VR) {
+                    replies.received(frame[0], frame + 1, length - 2);
+                    continue;
+                }
+                if (length < 3) {
+                    continue;
+                }
+                // the byte after the command is not part of the result, end is not either
+                uint8_t count = MIN(length - 3, size);
+                memcpy(buf, frame + 2, count);
+                return count;
+            }
+            return 0;
+        }
+
+        // VR::send_pkt drops the bytes received so far, start again after it
+        void reset()
+        {
+            state = State::Head;
+        }
+
+        uint16_t getDropped() const { return dropped; }
+};
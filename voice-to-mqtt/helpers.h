@@ -1,23 +1,3 @@
-
-
-bool loadGroup(VR & voiceRecognition, uint8_t group)
-{
-    uint8_t index {group * MAX_LOADED};
-    uint8_t loadUntil {index + MAX_LOADED};
-    if (voiceRecognition.clear() != 0) {
-        error("Failed to clear recognizer.");
-        return false;
-    } 
-    info("Load group %d", group);
-    while (index < loadUntil) {
-        if(voiceRecognition.load(index) != 0) {
-            warning("Failed to load record: %d", index);
-        }
-        index++;
-    }
-    return true;
-}
-
 void printSigTrain(uint8_t * buf, uint8_t len)
 {
     if (len == 0) {
@@ -89,4 +69,23 @@ uint8_t train(VR &voiceRecognition, uint8_t index, const char * signature)
 0x40202042: loop() at /directory/arduino-mqtt-node/voice-to-mqtt/main.cpp line 156
 0x4010055c: ets_post(uint8, ETSSignal, ETSParam) at /directory/arduino-mqtt-node/arduino-link/packages/esp8266/hardware/esp8266/2.5.2/cores/esp8266/core_esp8266_main.cpp line 177
 0x402069d0: loop_wrapper() at /directory/arduino-mqtt-node/arduino-link/packages/esp8266/hardware/esp8266/2.5.2/cores/esp8266/core_esp8266_main.cpp line 197
-**/
\ No newline at end of file
+**/
+
+// memory and recognizer usage, heap free heap, stk free stack, ld records loaded, 0 while unknown
+// vfd voice frames dropped, cmd commands trained
+bool sendStats(PubSubClient & client, const LoadedRecords & loaded, const VoiceFrameReader & frames, const VoiceMqtt * commands, uint8_t count)
+{
+    uint32_t trained {0};
+    for (uint8_t i = 0; i < count; i++) {
+        trained += commands[i].topic[0] != '\0' ? 1 : 0;
+    }
+    const char * const keys[] {"heap", "stk", "ld", "vfd", "cmd"};
+    const uint32_t values[] {
+        ESP.getFreeHeap(),
+        ESP.getFreeContStack(),
+        (uint32_t)(loaded.isKnown() ? MAX_LOADED - loaded.available() : 0),
+        frames.getDropped(),
+        trained
+    };
+    return NodeModule::publishStats(client, MQTT_CLIENT_NAME, keys, values, COUNT_OF(values));
+}
@@ -1,6 +1,5 @@
 #include <Arduino.h>
 #include <ESP8266WiFi.h>
-#include <ESP8266WiFiMulti.h>
 #include <SPI.h>
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
@@ -8,19 +7,26 @@
 #include <VoiceRecognitionV3.h>
 #include <EEPROM.h>
 
+// satisfy arduino-builder
+#include "ArduinoBuilderNodeModule.h"
+// end
+
 #include "CommonModule/MacroHelper.h"
 #include "CommonModule/StringHelper.h"
 #include "MqttModule/MqttConfig.h"
 #include "RadioEncrypted/Helpers.h"
+#include "NodeModule/ConnectionManager.h"
+#include "NodeModule/MqttCallbacks.h"
+#include "NodeModule/MemoryStats.h"
 
 // requires WLAN_SSID_1, WLAN_PASSWORD_1, MQTT_SERVER_ADDRESS, MQTT_CLIENT_NAME
 
-using RadioEncrypted::connectToWifi;
 using RadioEncrypted::resetWatchDog;
-using RadioEncrypted::connectToMqtt;
 using RadioEncrypted::sendLiveData;
 using CommonModule::findPosFromEnd;
 using CommonModule::findNextPos;
+using NodeModule::ConnectionManager;
+using NodeModule::attachCallback;
 
 const uint8_t MAX_TOPIC {40};
 const uint8_t MAX_MESSAGE {20};
@@ -29,8 +35,7 @@ const char DEFAULT_MESSAGE[] PROGMEM {"toggle"};
 #include "VoiceMqtt.h"
 
 const uint16_t DISPLAY_TIME {60000};
-const uint8_t WIFI_RETRY {10};
-const uint8_t MQTT_RETRY {6};
+const uint16_t CONNECT_TIMEOUT {2000};
 const uint8_t PIN_TX {D2};
 const uint8_t PIN_RX {D3};
 const uint32_t BAUD_RATE_VOICE {9600};
@@ -44,16 +49,29 @@ const uint8_t MAX_COMMANDS {16};
 const uint16_t EEPROM_CACHE {4000};
 const uint16_t EEPROM_CACHE_CONFIRM {EEPROM_CACHE - 5};
 const uint8_t TRIGGER_COMMAND_GROUP {2};
+// VR_DEFAULT_TIMEOUT of the blocking commands
+const uint16_t VOICE_REPLY_TIMEOUT {1000};
+const uint16_t RELOAD_RETRY_TIME {DISPLAY_TIME};
+// memory and recognizer stats go with every KEEP_ALIVE_STATS th keep alive, 0 leaves them out of the build
+#ifndef KEEP_ALIVE_STATS
+#define KEEP_ALIVE_STATS 10
+#endif
 
 unsigned long lastRefreshTime {0};
-bool reloadRecognizer {false};
+uint16_t keepAlives {0};
 
+#include "LoadedRecords.h"
+#include "VoiceFrameReader.h"
+#include "GroupLoader.h"
 #include "helpers.h"
 
-ESP8266WiFiMulti wifi;
 WiFiClient net;
 PubSubClient client(net);
+ConnectionManager<ESP8266WiFiClass, PubSubClient> connection(WiFi, client, MQTT_CLIENT_NAME, CHANNEL_TRAIN);
 VR voiceRecognition(PIN_TX, PIN_RX);
+LoadedRecords loadedRecords;
+GroupLoader groupLoader(loadedRecords);
+VoiceFrameReader voiceFrames;
 VoiceMqtt commands[MAX_COMMANDS] {};
 
 void setup()
@@ -66,26 +84,14 @@ void setup()
 
     // We start by connecting to a WiFi network
     WiFi.mode(WIFI_STA);
-    wifi.addAP(WLAN_SSID_1, WLAN_PASSWORD_1);
+    connection.addAccessPoint(WLAN_SSID_1, WLAN_PASSWORD_1);
     #ifdef WLAN_SSID_2
-    wifi.addAP(WLAN_SSID_2, WLAN_PASSWORD_2);
+    connection.addAccessPoint(WLAN_SSID_2, WLAN_PASSWORD_2);
     #endif
 
-    if (!connectToWifi(wifi, WIFI_RETRY)) {
-        error("Unable to connect to wifi. Sleeping..")
-        ESP.deepSleep(120e6);
-    }
-    resetWatchDog();
-    delay(500);
-
+    // wifi and mqtt are connected from loop, recognition keeps working while they are down
+    net.setTimeout(CONNECT_TIMEOUT);
     client.setServer(MQTT_SERVER_ADDRESS, 1883);
-    if (!connectToMqtt(client, MQTT_CLIENT_NAME, CHANNEL_TRAIN)) {
-        error("Failed to connect to mqtt server on %s", MQTT_SERVER_ADDRESS);
-        ESP.deepSleep(120e6);
-    }
-
-    resetWatchDog();
-    delay(500);
 
     if (EEPROM.read(EEPROM_CACHE_CONFIRM) == 1) {
         EEPROM.get(0, commands);
@@ -110,7 +116,8 @@ void setup()
     }
 
     //expects topic -> message : voice/train/sign1/3 -> cmdn/window1/power1 toggle
-    client.setCallback([&voiceRecognition, &commands](const char * topic, uint8_t * payload, uint16_t len) {
+    // no captures, voiceRecognition and commands are global
+    attachCallback(client, [](void *, const char * topic, uint8_t * payload, uint16_t len) {
         debug("Mqtt message received for: %s", topic);
     
         uint8_t indexPos = findPosFromEnd(topic, strlen(topic), '/');
@@ -151,27 +158,24 @@ void setup()
         }
     });
 
-    if (!loadGroup(voiceRecognition, TRIGGER_COMMAND_GROUP)) {
-        error("VoiceRecognitionModule unable to load group: %d", TRIGGER_COMMAND_GROUP);
-        reloadRecognizer = true;
-    }
+    // loaded from loop, clear and load replies are read like recognitions
+    groupLoader.request(TRIGGER_COMMAND_GROUP);
 }
 
 void loop()
 {
+    connection.tick(millis());
     client.loop();
 
+    // only what the module already sent is read, mqtt does not wait for the voice module
     uint8_t buf[MAX_RECOGNIZED_BUFFER] {0};
-    uint8_t ret = voiceRecognition.recognize(buf, 50);
+    uint8_t ret = voiceFrames.read(voiceRecognition, buf, sizeof(buf), groupLoader);
 
-    if(ret > 0 && ret != 255) {
+    if (ret > 0) {
         // signatures with group1 will trigger will load 7-13 records
         if (strncmp("group", (char*)buf+4, 5) == 0) {
             uint8_t group = atoi((char*)buf+9);
-            if (!loadGroup(voiceRecognition, group)) {
-                error("VoiceRecognitionModule unable to load group: %d", group);
-                reloadRecognizer = true;
-            }
+            groupLoader.request(group);
         } else {
             if (COUNT_OF(commands) > buf[1] && commands[buf[1]].topic[0] != '\0') {
                 if (!client.publish(commands[buf[1]].topic, commands[buf[1]].message)) {
@@ -183,28 +187,23 @@ void loop()
                 warning("Unknown voice index %d", buf[1]);
             }
             // back to the initial trigger commands
-            if (!loadGroup(voiceRecognition, TRIGGER_COMMAND_GROUP)) {
-                error("VoiceRecognitionModule unable to load group: %d", TRIGGER_COMMAND_GROUP);
-                reloadRecognizer = true;
-            }
+            groupLoader.request(TRIGGER_COMMAND_GROUP);
         } 
     }
 
-	if(millis() - lastRefreshTime >= DISPLAY_TIME) {
-
-        if (!connectToWifi(wifi, WIFI_RETRY)) {
-            error("Unable to connect to wifi");
-        }
-        resetWatchDog();
-        if (!connectToMqtt(client, MQTT_CLIENT_NAME, CHANNEL_TRAIN)) {
-            error("Failed to connect to mqtt server on %s", MQTT_SERVER_ADDRESS);
-        }
-        resetWatchDog();
+    if (groupLoader.tick(voiceRecognition, millis())) {
+        voiceFrames.reset();
+    }
 
-		sendLiveData(client);
+	if(millis() - lastRefreshTime >= DISPLAY_TIME) {
 
-        if (reloadRecognizer && loadGroup(voiceRecognition, TRIGGER_COMMAND_GROUP)) {
-            reloadRecognizer = false;
+        if (connection.isConnected()) {
+            sendLiveData(client);
+#if KEEP_ALIVE_STATS > 0
+            if (keepAlives++ % KEEP_ALIVE_STATS == 0 && !sendStats(client, loadedRecords, voiceFrames, commands, COUNT_OF(commands))) {
+                warning("Failed to publish stats");
+            }
+#endif
         }
 
         info("Ping");
@@ -1,45 +1,83 @@
-
-bool sendPostRequest(HTTPClient & client, ValueProviderFactory & provider, const Pin & pin, JsonDocument & json)
+// queues pin state as {"type": ..., "pin": ..., "value": ...} for the next batch post
+// values that are not integers go through ArduinoJson and the provider json, keys in the same order
+bool addPostData(HttpBatch<HTTPClient, HTTP_BATCH_SIZE> & batch, ValueProviderFactory & provider, const Pin & pin)
 {
-    char url[MAX_LEN_URL] {0};
+    char value[MQTT_MAX_LEN_MESSAGE] {0};
     char message[MAX_LEN_JSON_MESSAGE] {0};
 
-    snprintf_P(url, COUNT_OF(url), CHANNEL_SERVER, provider.getMatchingTopicType(pin), pin.id);
-    if (!provider.addJson(json, pin)) {
-        error("Failed to format message");
-        return false; 
+    size_t length {0};
+    if (provider.formatMessage(value, COUNT_OF(value), pin)) {
+        length = writePinState(message, COUNT_OF(message), provider.getMatchingTopicType(pin), pin.id, value);
     }
+    if (length == 0) {
+        StaticJsonDocument<MAX_LEN_JSON_MESSAGE> json;
+        json["type"] = provider.getMatchingTopicType(pin);
+        json["pin"] = pin.id;
+        if (!provider.addJson(json, pin)) {
+            error("Failed to format message");
+            return false; 
+        }
 
-    if (!(serializeJson(json, message, COUNT_OF(message)) > 0)) {
-        error("Failed to serialize json");
-        return false;  
+        length = serializeJson(json, message, COUNT_OF(message));
+        if (!(length > 0)) {
+            error("Failed to serialize json");
+            return false;  
+        }
     }
-    if (!client.begin(url)) {
-        error("Http connection failed");
+    if (!batch.add(message, length)) {
+        error("Failed to queue state");
         return false;
     }
-    client.addHeader("Content-Type", "application/json"); 
-    int httpCode = client.POST((uint8_t*)message, strlen(message));  
-    client.end(); 
+    info("Queued %s", message);
+    return true;
+}
 
-    if (httpCode != 200) {
-        error("Failed to publish state");
-        return false;
-    } else {
-        info("Sent %s %s", url, message);
+
+// topics of the pins first, then the subscribe and set/json topics
+bool formatTopic(ValueProviderFactory & provider, const Pin * pins, uint8_t count, uint8_t index, char * topic, uint8_t size)
+{
+    if (index < count) {
+        return snprintf_P(topic, size, CHANNEL_INFO, provider.getMatchingTopicType(pins[index]), pins[index].id) < size;
     }
-    return true;
+    return snprintf_P(topic, size, index == count ? CHANNEL_SUBSCRIBE : CHANNEL_SET_JSON) < size;
 }
 
+bool buildTopics(Topics & topics, ValueProviderFactory & provider, const Pin * pins, uint8_t count)
+{
+    return topics.build(count + 2, [&](uint8_t index, char * topic, uint8_t size) {
+        return formatTopic(provider, pins, count, index, topic, size);
+    });
+}
+
+// formats the topic only when the cache could not be built
+void copyTopic(const Topics & topics, ValueProviderFactory & provider, const Pin * pins, uint8_t count, uint8_t index, char * topic, uint8_t size)
+{
+    if (!topics.copy(index, topic, size)) {
+        formatTopic(provider, pins, count, index, topic, size);
+    }
+}
 
-bool sendMqttRequest(PubSubClient & client, ValueProviderFactory & provider, const Pin & pin)
+// subscribe topics of this node the subscriber list holds, the list has no size of its own
+template<typename Subscribers>
+uint8_t countSubscribed(Subscribers & subscribers, const Topics & topics, ValueProviderFactory & provider, const Pin * pins, uint8_t count)
+{
+    uint8_t subscribed {0};
+    char topic[MQTT_MAX_LEN_TOPIC] {0};
+    for (uint8_t index = count; index < count + 2; index++) {
+        copyTopic(topics, provider, pins, count, index, topic, COUNT_OF(topic));
+        subscribed += subscribers.hasSubscribed(topic) ? 1 : 0;
+    }
+    return subscribed;
+}
+
+bool sendMqttRequest(PubSubClient & client, ValueProviderFactory & provider, const Topics & topics, const Pin * pins, uint8_t count, uint8_t index)
 {
     char topic[MQTT_MAX_LEN_TOPIC] {0};
     char message[MQTT_MAX_LEN_MESSAGE] {0};
 
-    snprintf_P(topic, COUNT_OF(topic), CHANNEL_INFO, provider.getMatchingTopicType(pin), pin.id);
+    copyTopic(topics, provider, pins, count, index, topic, COUNT_OF(topic));
     
-    if (!provider.formatMessage(message, COUNT_OF(message), pin)) {
+    if (!provider.formatMessage(message, COUNT_OF(message), pins[index])) {
         error("Failed to format message");
         return false; 
     }
@@ -57,22 +95,97 @@ void subscribeToChannels(
     PubSubClient & client,
     SubscriberList & subscribers,
     SubscribePubSubHandler & subscribeHandler,
-    PinStateJsonHandler & jsonHandler
+    PinStateJsonHandler & jsonHandler,
+    ValueProviderFactory & provider,
+    const Topics & topics,
+    const Pin * pins,
+    uint8_t count
 )
 {
     char topic[MQTT_MAX_LEN_TOPIC] {0};
 
-    snprintf_P(topic, COUNT_OF(topic), CHANNEL_SUBSCRIBE);
+    copyTopic(topics, provider, pins, count, count, topic, COUNT_OF(topic));
     if (subscribers.add(topic, &subscribeHandler, (uint16_t)0)) {
         error("Failed to subscribe to topic: %s", topic);
         return;
     }
     client.subscribe(topic);
 
-    snprintf_P(topic, COUNT_OF(topic), CHANNEL_SET_JSON);
+    copyTopic(topics, provider, pins, count, count + 1, topic, COUNT_OF(topic));
     if (subscribers.add(topic, &jsonHandler, (uint16_t)0)) {
         error("Failed to subscribe to topic: %s", topic);
         return;
     }
     client.subscribe(topic);
 }
+
+// joins the access point of the last wake with its address, channel and bssid, no scan and no dhcp
+bool resumeWifi(ESP8266WiFiClass & wifi, Resume & resume, uint16_t timeout, uint16_t maxWakes)
+{
+    if (!resume.load() || !resume.resumed(maxWakes)) {
+        return false;
+    }
+    const ResumeState & state = resume.get();
+    const char * ssid {WLAN_SSID_1};
+    const char * password {WLAN_PASSWORD_1};
+    #ifdef WLAN_SSID_2
+    if (state.accessPoint == 1) {
+        ssid = WLAN_SSID_2;
+        password = WLAN_PASSWORD_2;
+    }
+    #endif
+
+    wifi.config(IPAddress(state.ip), IPAddress(state.gateway), IPAddress(state.subnet), IPAddress(state.dns));
+    wifi.begin(ssid, password, state.channel, state.bssid, true);
+
+    unsigned long start = millis();
+    while (wifi.status() != WL_CONNECTED) {
+        if (millis() - start > timeout) {
+            warning("Wifi resume failed");
+            // back to dhcp and a full scan
+            wifi.disconnect();
+            wifi.config(IPAddress(), IPAddress(), IPAddress());
+            resume.clear();
+            return false;
+        }
+        delay(5);
+    }
+    info("Wifi resumed in %lu ms", millis() - start);
+    return true;
+}
+
+// keeps the connection of a full connect for the next wake
+void rememberWifi(ESP8266WiFiClass & wifi, Resume & resume, IPAddress broker)
+{
+    ResumeState state;
+    state.ip = wifi.localIP();
+    state.gateway = wifi.gatewayIP();
+    state.subnet = wifi.subnetMask();
+    state.dns = wifi.dnsIP();
+    state.broker = broker;
+    memcpy(state.bssid, wifi.BSSID(), sizeof(state.bssid));
+    state.channel = wifi.channel();
+    #ifdef WLAN_SSID_2
+    state.accessPoint = wifi.SSID() == WLAN_SSID_2 ? 1 : 0;
+    #endif
+    if (!resume.save(state)) {
+        warning("Failed to keep wifi state");
+    }
+}
+
+// memory and pool usage, heap free heap, stk free stack, sb subscriptions held, tc topics cached
+// pn pins in the pin collection, hb/hbd states queued for the http post/dropped
+bool sendStats(PubSubClient & client, uint8_t subscribed, uint8_t cachedTopics, uint8_t pinCount, const HttpBatch<HTTPClient, HTTP_BATCH_SIZE> & batch)
+{
+    const char * const keys[] {"heap", "stk", "sb", "tc", "pn", "hb", "hbd"};
+    const uint32_t values[] {
+        ESP.getFreeHeap(),
+        ESP.getFreeContStack(),
+        subscribed,
+        cachedTopics,
+        pinCount,
+        batch.size(),
+        batch.getDropped()
+    };
+    return NodeModule::publishStats(client, MQTT_CLIENT_NAME, keys, values, COUNT_OF(values));
+}
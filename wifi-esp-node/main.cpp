@@ -10,6 +10,7 @@
 #include <ESP8266HTTPClient.h>
 
 // satisfy arduino-builder
+#include "ArduinoBuilderNodeModule.h"
 #include "ArduinoBuilderMqttModule.h"
 #include "ArduinoBuilderMessageHandlers.h"
 #include "ArduinoBuilderValueProviders.h"
@@ -28,6 +29,12 @@
 #include "MqttModule/ValueProviders/DigitalProvider.h"
 #include "MqttModule/ValueProviders/ValueProviderFactory.h"
 #include "MqttModule/ValueProviders/DallasTemperatureProvider.h"
+#include "NodeModule/WifiResume.h"
+#include "NodeModule/HttpBatch.h"
+#include "NodeModule/TopicCache.h"
+#include "NodeModule/PinJson.h"
+#include "NodeModule/MqttCallbacks.h"
+#include "NodeModule/MemoryStats.h"
 
 using MqttModule::SubscriberList;
 using MqttModule::StaticSubscriberList;
@@ -49,27 +56,56 @@ using MqttModule::ValueProviders::DallasSensor;
 using RadioEncrypted::connectToWifi;
 using RadioEncrypted::resetWatchDog;
 using RadioEncrypted::connectToMqtt;
+using NodeModule::ResumeState;
+using NodeModule::RtcStore;
+using NodeModule::WifiResume;
+using NodeModule::HttpBatch;
+using NodeModule::TopicCache;
+using NodeModule::PinCommands;
+using NodeModule::writePinState;
+using NodeModule::attachCallback;
+
+using Resume = WifiResume<RtcStore<EspClass>>;
 
 // requires WLAN_SSID_1, WLAN_PASSWORD_1, MQTT_SERVER_ADDRESS, SLEEP_FOR, SERVER_URL
 // int main does not work
 
 const uint16_t DISPLAY_TIME {60000};
 const uint8_t TEMPERATURE_PIN = 2;
-const char CHANNEL_SERVER[] PROGMEM {HTTP_SERVER_URL MQTT_CLIENT_NAME "/%s/%d"};
+// readings of all pins are posted as one json array
+const char SERVER_URL[] {HTTP_SERVER_URL MQTT_CLIENT_NAME};
+const uint16_t HTTP_BATCH_SIZE {256};
+const uint32_t HTTP_BATCH_INTERVAL {30000};
+// topic bytes after the shared prefix, pin topics and the two subscribe topics are cached
+const uint8_t MAX_TOPIC_SUFFIX {12};
+// memory and pool stats go with every KEEP_ALIVE_STATS th keep alive, 0 leaves them out of the build
+#ifndef KEEP_ALIVE_STATS
+#define KEEP_ALIVE_STATS 10
+#endif
 const uint8_t WIFI_RETRY = 10;
 const uint8_t MQTT_RETRY = 6;
+// deep sleep wakes rejoin the last access point within this time or fall back to a full connect
+const uint16_t RESUME_TIMEOUT {1000};
+// full connect after this many resumed wakes so the dhcp lease is renewed
+const uint16_t RESUME_MAX_WAKES {100};
 unsigned long lastRefreshTime {0};
+uint16_t keepAlives {0};
 
 
 ESP8266WiFiMulti wifi;
 WiFiClient net;
 PubSubClient client(net);
 HTTPClient httpClient;
+HttpBatch<HTTPClient, HTTP_BATCH_SIZE> postBatch(httpClient, SERVER_URL, HTTP_BATCH_INTERVAL);
+RtcStore<EspClass> rtcStore(ESP);
+Resume resume(rtcStore);
 
 StaticSubscriberList<2, 2, 2> subscribers;
 
 Pin pins[] {{TEMPERATURE_PIN, "temperature"}};
 StaticPinCollection<COUNT_OF(pins)> pinCollection(pins);
+using Topics = TopicCache<COUNT_OF(pins) + 2, MQTT_MAX_LEN_TOPIC + (COUNT_OF(pins) + 2) * MAX_TOPIC_SUFFIX>;
+Topics topics;
 
 OneWire oneWire(TEMPERATURE_PIN); 
 DallasSensor sensors[] {{&oneWire, TEMPERATURE_PIN}};
@@ -84,6 +120,8 @@ ValueProviderFactory valueProviderFactory(providers, COUNT_OF(providers));
 PinStateHandler handler(pinCollection, valueProviderFactory);
 SubscribePubSubHandler subscribeHandler(client, subscribers, handler);
 PinStateJsonHandler jsonHandler(pinCollection, valueProviderFactory);
+using Commands = PinCommands<SubscriberList, ValueProviderFactory, Pin>;
+Commands commands(subscribers, valueProviderFactory, pins, COUNT_OF(pins));
 
 #include "helpers.h"
 
@@ -92,40 +130,87 @@ void setup() {
     ESP.wdtDisable();
     ESP.wdtEnable(10000);
 
+    if (!buildTopics(topics, valueProviderFactory, pins, COUNT_OF(pins))) {
+        warning("Topics do not fit the cache, they are formatted on publish");
+    }
+    char setTopic[MQTT_MAX_LEN_TOPIC] {0};
+    copyTopic(topics, valueProviderFactory, pins, COUNT_OF(pins), COUNT_OF(pins) + 1, setTopic, COUNT_OF(setTopic));
+    commands.setTopic(setTopic);
+
     // We start by connecting to a WiFi network
     WiFi.mode(WIFI_STA);
-    wifi.addAP(WLAN_SSID_1, WLAN_PASSWORD_1);
-    #ifdef WLAN_SSID_2
-    wifi.addAP(WLAN_SSID_2, WLAN_PASSWORD_2);
-    #endif
+#ifdef SLEEP_FOR
+    // connection state is kept in rtc memory, flash would be written on every wake
+    WiFi.persistent(false);
+    bool resumed = resumeWifi(WiFi, resume, RESUME_TIMEOUT, RESUME_MAX_WAKES);
+#else
+    bool resumed = false;
+#endif
 
-    if (!connectToWifi(wifi, WIFI_RETRY)) {
-        error("Unable to connect to wifi. Sleeping..")
-        ESP.deepSleep(120e6);
-    }
+    if (!resumed) {
+        wifi.addAP(WLAN_SSID_1, WLAN_PASSWORD_1);
+        #ifdef WLAN_SSID_2
+        wifi.addAP(WLAN_SSID_2, WLAN_PASSWORD_2);
+        #endif
+
+        if (!connectToWifi(wifi, WIFI_RETRY)) {
+            error("Unable to connect to wifi. Sleeping..")
+            ESP.deepSleep(120e6);
+        }
 
-    delay(500);
+        delay(500);
+    }
 
     ESP.wdtFeed();
 
+#ifdef SLEEP_FOR
+    IPAddress broker(resumed ? resume.get().broker : 0);
+    if (!resumed) {
+        #ifdef MQTT_SERVER_ADDRESS
+        // the broker address is resolved once per full connect
+        if (!WiFi.hostByName(MQTT_SERVER_ADDRESS, broker)) {
+            broker = IPAddress();
+        }
+        #endif
+        rememberWifi(WiFi, resume, broker);
+    }
+#endif
+
 #ifdef MQTT_SERVER_ADDRESS
+    #ifdef SLEEP_FOR
+    if ((uint32_t)broker != 0) {
+        client.setServer(broker, 1883);
+    } else {
+        client.setServer(MQTT_SERVER_ADDRESS, 1883);
+    }
+    #else
     client.setServer(MQTT_SERVER_ADDRESS, 1883);
-    if (!connectToMqtt(client, MQTT_CLIENT_NAME, nullptr)) {
-        error("failed to connect to mqtt server on %s", MQTT_SERVER_ADDRESS);
-        ESP.deepSleep(120e6);
+    #endif
+
+    // a resumed wake tries once, a failure may mean a stale lease so the next wake does a full connect
+    if (!(resumed && client.connect(MQTT_CLIENT_NAME))) {
+        if (resumed) {
+            warning("Mqtt resume failed");
+            resume.clear();
+        }
+        if (!connectToMqtt(client, MQTT_CLIENT_NAME, nullptr)) {
+            error("failed to connect to mqtt server on %s", MQTT_SERVER_ADDRESS);
+            ESP.deepSleep(120e6);
+        }
     }
 
     #ifndef SLEEP_FOR
-        subscribeToChannels(client, subscribers, subscribeHandler, jsonHandler);
+        subscribeToChannels(client, subscribers, subscribeHandler, jsonHandler, valueProviderFactory, topics, pins, COUNT_OF(pins));
 
-        client.setCallback([&subscribers](const char * topic, uint8_t * payload, uint16_t len) {
+        attachCallback(client, [](void * context, const char * topic, uint8_t * payload, uint16_t len) {
+            Commands & commands = *(Commands *)context;
             debug("Mqtt message received for: %s", topic);
             MqttMessage message(topic);
             memcpy(message.message, payload, MIN(len, COUNT_OF(message.message)));
-            if (!(subscribers.call(message) > 0)) {
+            if (!(commands.call(message) > 0)) {
                 warning("Not handled: %s", message.topic);
             }
-        });
+        }, &commands);
     #endif
 #endif
 }
@@ -133,34 +218,37 @@ void setup() {
 void loop()
 {
 #ifdef SLEEP_FOR
-    for (auto & pin: pins) {
+    for (uint8_t i = 0; i < COUNT_OF(pins); i++) {
+        Pin & pin = pins[i];
         #ifdef MQTT_SERVER_ADDRESS
-        sendMqttRequest(client, valueProviderFactory, pin);
+        sendMqttRequest(client, valueProviderFactory, topics, pins, COUNT_OF(pins), i);
         #endif
         #ifdef HTTP_SERVER_URL
-        StaticJsonDocument<MAX_LEN_JSON_MESSAGE> doc;
-        sendPostRequest(httpClient, valueProviderFactory, pin, doc);
+        addPostData(postBatch, valueProviderFactory, pin);
         #endif
         #if !defined(MQTT_SERVER_ADDRESS) && !defined(HTTP_SERVER_URL)
             error("No handler defined for sending data pin: %d", pin.id);
         #endif
     }
+    #ifdef HTTP_SERVER_URL
+    postBatch.flush();
+    #endif
     client.loop();
     info("Sleeping: %d", SLEEP_FOR);
     ESP.deepSleep(SLEEP_FOR);
 #else
     client.loop();
 
-    for (auto & pin: pins) {
+    for (uint8_t i = 0; i < COUNT_OF(pins); i++) {
+        Pin & pin = pins[i];
         if (millis() - pin.lastRead > pin.readInterval) {
             pin.lastRead = millis();
 
             #ifdef MQTT_SERVER_ADDRESS
-            sendMqttRequest(client, valueProviderFactory, pin);
+            sendMqttRequest(client, valueProviderFactory, topics, pins, COUNT_OF(pins), i);
             #endif
             #ifdef HTTP_SERVER_URL
-            StaticJsonDocument<MAX_LEN_JSON_MESSAGE> doc;
-            sendPostRequest(httpClient, valueProviderFactory, pin, doc);
+            addPostData(postBatch, valueProviderFactory, pin);
             #endif
             #if !defined(MQTT_SERVER_ADDRESS) && !defined(HTTP_SERVER_URL)
                 error("No handler defined for sending data pin: ") << endl;
@@ -170,16 +258,30 @@ void loop()
         } 
     }
 
+    #ifdef HTTP_SERVER_URL
+    if (postBatch.isDue(millis())) {
+        postBatch.flush();
+    }
+    #endif
+
 	if(millis() - lastRefreshTime >= DISPLAY_TIME) {
 		lastRefreshTime += DISPLAY_TIME;
 
         #ifdef MQTT_SERVER_ADDRESS
 		sendLiveData(client);
+        #if KEEP_ALIVE_STATS > 0
+        if (client.connected() && keepAlives++ % KEEP_ALIVE_STATS == 0) {
+            uint8_t subscribed = countSubscribed(subscribers, topics, valueProviderFactory, pins, COUNT_OF(pins));
+            if (!sendStats(client, subscribed, topics.size(), COUNT_OF(pins), postBatch)) {
+                warning("Failed to publish stats");
+            }
+        }
+        #endif
         
         if (!client.connected()) {
             if (client.connect(MQTT_CLIENT_NAME)) {
                 info("Mqtt reconnected");
-                subscribeToChannels(client, subscribers, subscribeHandler, jsonHandler);
+                subscribeToChannels(client, subscribers, subscribeHandler, jsonHandler, valueProviderFactory, topics, pins, COUNT_OF(pins));
             } else {
                 info("Mqtt failed to reconnect"); 
             }